@@ -0,0 +1,303 @@
+#include "alloc_stats.h"
+#include "fixtures.h"
+#include "gothic_version.h"
+#include "launch_command.h"
+#include "mod_discovery.h"
+#include "mod_table.h"
+#include "pe_resources.h"
+#include "runtime_paths.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <vector>
+#include <wx/arrstr.h>
+#include <wx/filename.h>
+#include <wx/init.h>
+#include <wx/log.h>
+#include <wx/stdpaths.h>
+
+namespace {
+
+struct BenchResult {
+  double ns_per_op;
+  double allocs_per_op;
+  double bytes_per_op;
+};
+
+// Runs `body` until at least `minDuration` has elapsed (and at least
+// `minIterations` times) after one untimed warm-up call.
+BenchResult RunBenchmark(const std::function<void()> &body,
+                         std::chrono::milliseconds minDuration,
+                         unsigned long minIterations) {
+  using Clock = std::chrono::steady_clock;
+  body();
+
+  const AllocSnapshot before = ReadAllocSnapshot();
+  const Clock::time_point begin = Clock::now();
+  Clock::time_point now = begin;
+  unsigned long iterations = 0;
+  while (iterations < minIterations || now - begin < minDuration) {
+    body();
+    ++iterations;
+    now = Clock::now();
+  }
+
+  const double count = static_cast<double>(iterations);
+  const double elapsedNs = static_cast<double>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(now - begin).count());
+  const AllocSnapshot after = ReadAllocSnapshot();
+  BenchResult result{};
+  result.ns_per_op = elapsedNs / count;
+  result.allocs_per_op = static_cast<double>(after.count - before.count) / count;
+  result.bytes_per_op = static_cast<double>(after.bytes - before.bytes) / count;
+  return result;
+}
+
+void PrintResult(const char *name, size_t scale, const BenchResult &result) {
+  std::printf("%-36s %6lu %14.0f %12.1f %14.1f\n", name,
+              static_cast<unsigned long>(scale), result.ns_per_op,
+              result.allocs_per_op, result.bytes_per_op);
+}
+
+// Retained-memory rows only fill the last column.
+void PrintRetained(const char *name, size_t scale, double bytes) {
+  std::printf("%-36s %6lu %14s %12s %14.1f\n", name, static_cast<unsigned long>(scale), "-",
+              "-", bytes);
+}
+
+// Keeps the optimizer from discarding benchmarked work.
+std::atomic<size_t> gSink{0};
+
+struct Options {
+  std::vector<size_t> scales{10, 100, 1000};
+  std::chrono::milliseconds min_duration{500};
+  wxString root;
+  bool keep = false;
+};
+
+bool ParseScales(const wxString &value, std::vector<size_t> &scales) {
+  scales.clear();
+  for (const wxString &token : wxSplit(value, ',')) {
+    unsigned long scale = 0;
+    if (!token.ToULong(&scale) || scale == 0) {
+      return false;
+    }
+    scales.push_back(static_cast<size_t>(scale));
+  }
+  return !scales.empty();
+}
+
+bool ParseOptions(int argc, char **argv, Options &options) {
+  for (int i = 1; i < argc; ++i) {
+    const wxString arg = wxString::FromUTF8(argv[i]);
+    wxString value;
+    if (arg.StartsWith(wxT("--scales="), &value)) {
+      if (!ParseScales(value, options.scales)) {
+        std::fprintf(stderr, "Invalid --scales value: %s\n", argv[i]);
+        return false;
+      }
+    } else if (arg.StartsWith(wxT("--min-ms="), &value)) {
+      unsigned long ms = 0;
+      if (!value.ToULong(&ms) || ms == 0) {
+        std::fprintf(stderr, "Invalid --min-ms value: %s\n", argv[i]);
+        return false;
+      }
+      options.min_duration = std::chrono::milliseconds(ms);
+    } else if (arg.StartsWith(wxT("--root="), &value)) {
+      options.root = value;
+    } else if (arg == wxT("--keep")) {
+      options.keep = true;
+    } else {
+      std::fprintf(stderr,
+                   "Usage: ogs_bench [--scales=10,100,1000] [--min-ms=500] "
+                   "[--root=<dir>] [--keep]\n");
+      return false;
+    }
+  }
+  return true;
+}
+
+bool RunTreeBenchmarks(const Options &options, size_t scale, const wxString &root) {
+  wxString error;
+  if (!CreateSyntheticGothicTree(root, scale, error)) {
+    std::fprintf(stderr, "%s\n", static_cast<const char *>(error.utf8_str()));
+    return false;
+  }
+
+  const wxString launcher =
+      wxFileName(wxFileName(root, wxT("system")).GetFullPath(), wxT("OpenGothicStarter"))
+          .GetFullPath();
+  RuntimePaths paths;
+  if (!ResolveRuntimePathsFromExecutable(launcher, paths, error)) {
+    std::fprintf(stderr, "%s\n", static_cast<const char *>(error.utf8_str()));
+    return false;
+  }
+
+  PrintResult("ResolveRuntimePathsFromExecutable", scale,
+              RunBenchmark(
+                  [&] {
+                    RuntimePaths resolved;
+                    wxString resolveError;
+                    gSink += ResolveRuntimePathsFromExecutable(launcher, resolved,
+                                                               resolveError)
+                                 ? 1u
+                                 : 0u;
+                  },
+                  options.min_duration, 10));
+
+  PrintResult("DetectGothicVersion", scale,
+              RunBenchmark(
+                  [&] { gSink += static_cast<size_t>(DetectGothicVersion(paths) ==
+                                                     GothicVersion::Gothic2Notr); },
+                  options.min_duration, 10));
+
+  std::vector<GameEntry> games = DiscoverGames(paths);
+  if (games.size() != scale) {
+    std::fprintf(stderr, "DiscoverGames found %lu mods, expected %lu\n",
+                 static_cast<unsigned long>(games.size()),
+                 static_cast<unsigned long>(scale));
+    return false;
+  }
+  PrintResult("DiscoverGames", scale,
+              RunBenchmark([&] { gSink += DiscoverGames(paths).size(); },
+                           options.min_duration, 3));
+
+  ModTable table;
+  DiscoverMods(paths, table);
+  PrintResult("DiscoverMods (reused table)", scale,
+              RunBenchmark(
+                  [&] {
+                    DiscoverMods(paths, table);
+                    gSink += table.size();
+                  },
+                  options.min_duration, 3));
+
+  // Heap still held once discovery returns, per mod. The ModTable figure is
+  // its own accounting; the vector figure is the allocator's live-byte delta.
+  AllocSnapshot before = ReadAllocSnapshot();
+  {
+    std::vector<GameEntry> retained = DiscoverGames(paths);
+    const AllocSnapshot after = ReadAllocSnapshot();
+    PrintRetained("GameEntry vector bytes/mod", scale,
+                  static_cast<double>(after.live_bytes - before.live_bytes) /
+                      static_cast<double>(scale));
+    gSink += retained.size();
+  }
+  before = ReadAllocSnapshot();
+  {
+    ModTable retained;
+    DiscoverMods(paths, retained);
+    const AllocSnapshot after = ReadAllocSnapshot();
+    PrintRetained("ModTable bytes/mod", scale,
+                  static_cast<double>(after.live_bytes - before.live_bytes) /
+                      static_cast<double>(scale));
+    PrintRetained("ModTable accounted bytes/mod", scale,
+                  static_cast<double>(retained.MemoryBytes()) / static_cast<double>(scale));
+    gSink += retained.size();
+  }
+
+  LaunchOptions launch;
+  launch.version = GothicVersion::Gothic2Notr;
+  launch.mod_file = games.back().file;
+  launch.window_mode = true;
+  launch.fxaa = 2;
+  PrintResult("BuildLaunchCommand", scale,
+              RunBenchmark(
+                  [&] {
+                    wxArrayString command;
+                    wxString commandError;
+                    BuildLaunchCommand(paths, launch, command, commandError);
+                    gSink += command.size();
+                  },
+                  options.min_duration, 10));
+  return true;
+}
+
+bool RunPeBenchmarks(const Options &options, const wxString &root) {
+  const std::vector<int> sizeSets[] = {{16}, {16, 32, 48}, {16, 32, 48, 64, 128, 256}};
+  for (const std::vector<int> &sizes : sizeSets) {
+    std::vector<PeResource> resources;
+    AppendPeIconResources(sizes, resources);
+    const wxString path = wxFileName(
+        root, wxString::Format(wxT("icons%lu.exe"), static_cast<unsigned long>(sizes.size())))
+                              .GetFullPath();
+    wxString error;
+    if (!WriteBinaryFile(path, MakePeExecutable(resources), error)) {
+      std::fprintf(stderr, "%s\n", static_cast<const char *>(error.utf8_str()));
+      return false;
+    }
+
+    std::vector<uint8_t> ico;
+    if (!ExtractIcoFromPeExecutable(path, ico)) {
+      std::fprintf(stderr, "ExtractIcoFromPeExecutable failed on fixture %s\n",
+                   static_cast<const char *>(path.utf8_str()));
+      return false;
+    }
+    PrintResult("ExtractIcoFromPeExecutable", sizes.size(),
+                RunBenchmark(
+                    [&] {
+                      std::vector<uint8_t> extracted;
+                      ExtractIcoFromPeExecutable(path, extracted);
+                      gSink += extracted.size();
+                    },
+                    options.min_duration, 10));
+  }
+  return true;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  wxInitializer initializer(argc, argv);
+  if (!initializer.IsOk()) {
+    std::fprintf(stderr, "Failed to initialize wxWidgets.\n");
+    return EXIT_FAILURE;
+  }
+  wxLog::SetActiveTarget(new wxLogStderr());
+
+  Options options;
+  if (!ParseOptions(argc, argv, options)) {
+    return EXIT_FAILURE;
+  }
+
+  const bool ownsRoot = options.root.empty();
+  if (ownsRoot) {
+    options.root = wxFileName::CreateTempFileName(
+        wxFileName(wxStandardPaths::Get().GetTempDir(), wxT("ogs_bench")).GetFullPath());
+    wxRemoveFile(options.root);
+  }
+  if (!wxFileName::Mkdir(options.root, wxS_DIR_DEFAULT, wxPATH_MKDIR_FULL)) {
+    std::fprintf(stderr, "Failed to create benchmark root: %s\n",
+                 static_cast<const char *>(options.root.utf8_str()));
+    return EXIT_FAILURE;
+  }
+
+  std::printf("%-36s %6s %14s %12s %14s\n", "benchmark", "scale", "ns/op", "allocs/op",
+              "bytes/op");
+
+  bool ok = true;
+  for (size_t scale : options.scales) {
+    const wxString treeRoot =
+        wxFileName(options.root,
+                   wxString::Format(wxT("tree%lu"), static_cast<unsigned long>(scale)))
+            .GetFullPath();
+    if (!RunTreeBenchmarks(options, scale, treeRoot)) {
+      ok = false;
+      break;
+    }
+  }
+  if (ok) {
+    ok = RunPeBenchmarks(options, options.root);
+  }
+
+  if (options.keep) {
+    std::printf("Fixtures kept in %s\n", static_cast<const char *>(options.root.utf8_str()));
+  } else if (ownsRoot) {
+    wxFileName::Rmdir(options.root, wxPATH_RMDIR_RECURSIVE);
+  }
+  // Otherwise the caller passed --root and owns the directory and its contents.
+  return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
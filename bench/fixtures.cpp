@@ -0,0 +1,374 @@
+#include "fixtures.h"
+
+#include <algorithm>
+#include <map>
+#include <wx/dir.h>
+#include <wx/ffile.h>
+#include <wx/filename.h>
+
+namespace {
+
+constexpr uint16_t kRtIcon = 3;
+constexpr uint16_t kRtGroupIcon = 14;
+constexpr uint32_t kSectionAlignment = 0x1000;
+constexpr uint32_t kFileAlignment = 0x200;
+constexpr uint32_t kResourceRva = 0x1000;
+
+void PutLe16(std::vector<uint8_t> &data, uint16_t value) {
+  data.push_back(static_cast<uint8_t>(value & 0xFFu));
+  data.push_back(static_cast<uint8_t>((value >> 8) & 0xFFu));
+}
+
+void PutLe32(std::vector<uint8_t> &data, uint32_t value) {
+  for (int shift = 0; shift < 32; shift += 8) {
+    data.push_back(static_cast<uint8_t>((value >> shift) & 0xFFu));
+  }
+}
+
+void PatchLe32(std::vector<uint8_t> &data, size_t offset, uint32_t value) {
+  for (size_t i = 0; i < 4; ++i) {
+    data[offset + i] = static_cast<uint8_t>((value >> (8 * i)) & 0xFFu);
+  }
+}
+
+void PadTo(std::vector<uint8_t> &data, size_t alignment) {
+  while (data.size() % alignment != 0) {
+    data.push_back(0);
+  }
+}
+
+uint32_t AlignUp(uint32_t value, uint32_t alignment) {
+  return (value + alignment - 1) / alignment * alignment;
+}
+
+void PutDirectoryHeader(std::vector<uint8_t> &data, uint16_t idEntries) {
+  PutLe32(data, 0); // Characteristics
+  PutLe32(data, 0); // TimeDateStamp
+  PutLe16(data, 0); // MajorVersion
+  PutLe16(data, 0); // MinorVersion
+  PutLe16(data, 0); // NumberOfNamedEntries
+  PutLe16(data, idEntries);
+}
+
+// Builds a three-level (type -> id -> language) resource directory followed
+// by the raw resource data. All offsets are relative to the section start.
+std::vector<uint8_t> BuildResourceSection(const std::vector<PeResource> &resources) {
+  std::map<uint16_t, std::vector<const PeResource *>> byType;
+  for (const PeResource &resource : resources) {
+    byType[resource.type].push_back(&resource);
+  }
+  for (auto &entry : byType) {
+    std::sort(entry.second.begin(), entry.second.end(),
+              [](const PeResource *a, const PeResource *b) { return a->id < b->id; });
+  }
+
+  constexpr uint32_t kDirHeaderSize = 16;
+  constexpr uint32_t kDirEntrySize = 8;
+  constexpr uint32_t kDataEntrySize = 16;
+
+  const uint32_t rootSize =
+      kDirHeaderSize + kDirEntrySize * static_cast<uint32_t>(byType.size());
+  uint32_t typeDirsSize = 0;
+  for (const auto &entry : byType) {
+    typeDirsSize +=
+        kDirHeaderSize + kDirEntrySize * static_cast<uint32_t>(entry.second.size());
+  }
+  const uint32_t count = static_cast<uint32_t>(resources.size());
+  const uint32_t langDirsOffset = rootSize + typeDirsSize;
+  const uint32_t dataEntriesOffset =
+      langDirsOffset + count * (kDirHeaderSize + kDirEntrySize);
+  const uint32_t rawDataOffset = dataEntriesOffset + count * kDataEntrySize;
+
+  std::vector<uint8_t> section;
+  PutDirectoryHeader(section, static_cast<uint16_t>(byType.size()));
+  uint32_t nextTypeDir = rootSize;
+  for (const auto &entry : byType) {
+    PutLe32(section, entry.first);
+    PutLe32(section, 0x80000000u | nextTypeDir);
+    nextTypeDir +=
+        kDirHeaderSize + kDirEntrySize * static_cast<uint32_t>(entry.second.size());
+  }
+
+  uint32_t leafIndex = 0;
+  for (const auto &entry : byType) {
+    PutDirectoryHeader(section, static_cast<uint16_t>(entry.second.size()));
+    for (const PeResource *resource : entry.second) {
+      PutLe32(section, resource->id);
+      PutLe32(section, 0x80000000u |
+                           (langDirsOffset + leafIndex * (kDirHeaderSize + kDirEntrySize)));
+      ++leafIndex;
+    }
+  }
+
+  std::vector<const PeResource *> ordered;
+  for (const auto &entry : byType) {
+    ordered.insert(ordered.end(), entry.second.begin(), entry.second.end());
+  }
+
+  for (uint32_t i = 0; i < count; ++i) {
+    PutDirectoryHeader(section, 1);
+    PutLe32(section, 0x0409); // en-US
+    PutLe32(section, dataEntriesOffset + i * kDataEntrySize);
+  }
+
+  uint32_t nextData = rawDataOffset;
+  for (const PeResource *resource : ordered) {
+    PutLe32(section, kResourceRva + nextData);
+    PutLe32(section, static_cast<uint32_t>(resource->data.size()));
+    PutLe32(section, 0); // CodePage
+    PutLe32(section, 0); // Reserved
+    nextData = AlignUp(nextData + static_cast<uint32_t>(resource->data.size()), 8);
+  }
+
+  for (const PeResource *resource : ordered) {
+    section.insert(section.end(), resource->data.begin(), resource->data.end());
+    PadTo(section, 8);
+  }
+
+  return section;
+}
+
+} // namespace
+
+std::vector<uint8_t> MakeIconImage(int size) {
+  const uint32_t dimension = static_cast<uint32_t>(size);
+  const uint32_t maskStride = ((dimension + 31) / 32) * 4;
+
+  std::vector<uint8_t> image;
+  image.reserve(40 + dimension * dimension * 4 + maskStride * dimension);
+  PutLe32(image, 40); // biSize
+  PutLe32(image, dimension);
+  PutLe32(image, dimension * 2); // XOR + AND mask
+  PutLe16(image, 1);             // biPlanes
+  PutLe16(image, 32);            // biBitCount
+  PutLe32(image, 0);             // BI_RGB
+  PutLe32(image, dimension * dimension * 4 + maskStride * dimension);
+  PutLe32(image, 0);
+  PutLe32(image, 0);
+  PutLe32(image, 0);
+  PutLe32(image, 0);
+
+  for (uint32_t y = 0; y < dimension; ++y) {
+    for (uint32_t x = 0; x < dimension; ++x) {
+      image.push_back(static_cast<uint8_t>((x * 255) / dimension));
+      image.push_back(static_cast<uint8_t>((y * 255) / dimension));
+      image.push_back(static_cast<uint8_t>(((x ^ y) & 1u) ? 0xC0 : 0x40));
+      image.push_back(0xFF);
+    }
+  }
+  image.insert(image.end(), static_cast<size_t>(maskStride) * dimension, 0);
+  return image;
+}
+
+std::vector<uint8_t> MakeIcoFile(const std::vector<int> &sizes) {
+  std::vector<std::vector<uint8_t>> images;
+  images.reserve(sizes.size());
+  for (int size : sizes) {
+    images.push_back(MakeIconImage(size));
+  }
+
+  std::vector<uint8_t> ico;
+  PutLe16(ico, 0);
+  PutLe16(ico, 1);
+  PutLe16(ico, static_cast<uint16_t>(images.size()));
+  uint32_t offset = 6 + 16 * static_cast<uint32_t>(images.size());
+  for (size_t i = 0; i < images.size(); ++i) {
+    const uint8_t dimension = sizes[i] >= 256 ? 0 : static_cast<uint8_t>(sizes[i]);
+    ico.push_back(dimension);
+    ico.push_back(dimension);
+    ico.push_back(0);
+    ico.push_back(0);
+    PutLe16(ico, 1);
+    PutLe16(ico, 32);
+    PutLe32(ico, static_cast<uint32_t>(images[i].size()));
+    PutLe32(ico, offset);
+    offset += static_cast<uint32_t>(images[i].size());
+  }
+  for (const std::vector<uint8_t> &image : images) {
+    ico.insert(ico.end(), image.begin(), image.end());
+  }
+  return ico;
+}
+
+void AppendPeIconResources(const std::vector<int> &sizes,
+                           std::vector<PeResource> &resources) {
+  PeResource group{kRtGroupIcon, 1, {}};
+  PutLe16(group.data, 0);
+  PutLe16(group.data, 1);
+  PutLe16(group.data, static_cast<uint16_t>(sizes.size()));
+
+  for (size_t i = 0; i < sizes.size(); ++i) {
+    PeResource icon{kRtIcon, static_cast<uint16_t>(i + 1), MakeIconImage(sizes[i])};
+    const uint8_t dimension = sizes[i] >= 256 ? 0 : static_cast<uint8_t>(sizes[i]);
+    group.data.push_back(dimension);
+    group.data.push_back(dimension);
+    group.data.push_back(0);
+    group.data.push_back(0);
+    PutLe16(group.data, 1);
+    PutLe16(group.data, 32);
+    PutLe32(group.data, static_cast<uint32_t>(icon.data.size()));
+    PutLe16(group.data, icon.id);
+    resources.push_back(std::move(icon));
+  }
+
+  resources.push_back(std::move(group));
+}
+
+std::vector<uint8_t> MakePeExecutable(const std::vector<PeResource> &resources) {
+  const std::vector<uint8_t> rsrc = BuildResourceSection(resources);
+  const uint32_t rsrcSize = static_cast<uint32_t>(rsrc.size());
+  const uint32_t rawSize = AlignUp(rsrcSize, kFileAlignment);
+
+  std::vector<uint8_t> pe;
+  pe.reserve(kFileAlignment + rawSize);
+
+  // DOS header with e_lfanew pointing right behind it.
+  PutLe16(pe, 0x5A4D); // "MZ"
+  pe.resize(0x3C, 0);
+  PutLe32(pe, 0x40);
+
+  pe.push_back('P');
+  pe.push_back('E');
+  pe.push_back(0);
+  pe.push_back(0);
+
+  // COFF file header.
+  PutLe16(pe, 0x014C); // IMAGE_FILE_MACHINE_I386
+  PutLe16(pe, 1);      // NumberOfSections
+  PutLe32(pe, 0);      // TimeDateStamp
+  PutLe32(pe, 0);      // PointerToSymbolTable
+  PutLe32(pe, 0);      // NumberOfSymbols
+  PutLe16(pe, 224);    // SizeOfOptionalHeader
+  PutLe16(pe, 0x0102); // EXECUTABLE_IMAGE | 32BIT_MACHINE
+
+  // PE32 optional header.
+  PutLe16(pe, 0x010B);
+  pe.push_back(14); // MajorLinkerVersion
+  pe.push_back(0);  // MinorLinkerVersion
+  PutLe32(pe, 0);   // SizeOfCode
+  PutLe32(pe, rawSize);
+  PutLe32(pe, 0);                 // SizeOfUninitializedData
+  PutLe32(pe, 0);                 // AddressOfEntryPoint
+  PutLe32(pe, kResourceRva);      // BaseOfCode
+  PutLe32(pe, kResourceRva);      // BaseOfData
+  PutLe32(pe, 0x00400000);        // ImageBase
+  PutLe32(pe, kSectionAlignment); // SectionAlignment
+  PutLe32(pe, kFileAlignment);    // FileAlignment
+  PutLe16(pe, 4);                 // MajorOperatingSystemVersion
+  PutLe16(pe, 0);
+  PutLe16(pe, 0); // MajorImageVersion
+  PutLe16(pe, 0);
+  PutLe16(pe, 4); // MajorSubsystemVersion
+  PutLe16(pe, 0);
+  PutLe32(pe, 0); // Win32VersionValue
+  PutLe32(pe, kResourceRva + AlignUp(rsrcSize, kSectionAlignment));
+  PutLe32(pe, kFileAlignment); // SizeOfHeaders
+  PutLe32(pe, 0);              // CheckSum
+  PutLe16(pe, 2);              // IMAGE_SUBSYSTEM_WINDOWS_GUI
+  PutLe16(pe, 0);              // DllCharacteristics
+  PutLe32(pe, 0x00100000);     // SizeOfStackReserve
+  PutLe32(pe, 0x00001000);     // SizeOfStackCommit
+  PutLe32(pe, 0x00100000);     // SizeOfHeapReserve
+  PutLe32(pe, 0x00001000);     // SizeOfHeapCommit
+  PutLe32(pe, 0);              // LoaderFlags
+  PutLe32(pe, 16);             // NumberOfRvaAndSizes
+  for (uint32_t i = 0; i < 16; ++i) {
+    const bool isResourceDirectory = i == 2;
+    PutLe32(pe, isResourceDirectory ? kResourceRva : 0);
+    PutLe32(pe, isResourceDirectory ? rsrcSize : 0);
+  }
+
+  // Single .rsrc section header.
+  const char sectionName[8] = {'.', 'r', 's', 'r', 'c', 0, 0, 0};
+  pe.insert(pe.end(), sectionName, sectionName + 8);
+  PutLe32(pe, rsrcSize);
+  PutLe32(pe, kResourceRva);
+  PutLe32(pe, rawSize);
+  PutLe32(pe, kFileAlignment); // PointerToRawData
+  PutLe32(pe, 0);
+  PutLe32(pe, 0);
+  PutLe16(pe, 0);
+  PutLe16(pe, 0);
+  PutLe32(pe, 0x40000040u); // INITIALIZED_DATA | MEM_READ
+
+  pe.resize(kFileAlignment, 0);
+  pe.insert(pe.end(), rsrc.begin(), rsrc.end());
+  pe.resize(kFileAlignment + rawSize, 0);
+  return pe;
+}
+
+bool WriteBinaryFile(const wxString &path, const std::vector<uint8_t> &data,
+                     wxString &error) {
+  wxFFile file(path, wxT("wb"));
+  if (!file.IsOpened() || file.Write(data.data(), data.size()) != data.size()) {
+    error = wxString::Format(wxT("Failed to write fixture file: %s"), path);
+    return false;
+  }
+  return true;
+}
+
+bool WriteTextFile(const wxString &path, const wxString &text, wxString &error) {
+  const std::string utf8 = text.ToStdString(wxConvUTF8);
+  return WriteBinaryFile(path, std::vector<uint8_t>(utf8.begin(), utf8.end()),
+                         error);
+}
+
+bool CreateSyntheticGothicTree(const wxString &root, size_t modCount,
+                               wxString &error) {
+  error.clear();
+  const wxString systemDir = wxFileName(root, wxT("system")).GetFullPath();
+  const wxString dataDir = wxFileName(root, wxT("Data")).GetFullPath();
+  const wxString modVdfDir = wxFileName(dataDir, wxT("modvdf")).GetFullPath();
+  const wxString savesDir = wxFileName(root, wxT("Saves")).GetFullPath();
+  for (const wxString &dir : {systemDir, modVdfDir, savesDir}) {
+    if (!wxFileName::Mkdir(dir, wxS_DIR_DEFAULT, wxPATH_MKDIR_FULL)) {
+      error = wxString::Format(wxT("Failed to create fixture directory: %s"), dir);
+      return false;
+    }
+  }
+
+  const std::vector<uint8_t> empty;
+  const wxString volumes[] = {wxT("Worlds.vdf"), wxT("Anims.vdf"), wxT("Worlds_Addon.vdf"),
+                              wxT("Anims_Addon.vdf"), wxT("Textures_Addon.vdf")};
+  for (const wxString &volume : volumes) {
+    if (!WriteBinaryFile(wxFileName(dataDir, volume).GetFullPath(), empty, error)) {
+      return false;
+    }
+  }
+
+  if (!WriteBinaryFile(wxFileName(systemDir, wxT("OpenGothicStarter")).GetFullPath(),
+                       empty, error) ||
+      !WriteBinaryFile(wxFileName(systemDir, wxT("Gothic2Notr")).GetFullPath(),
+                       empty, error) ||
+      !WriteTextFile(wxFileName(systemDir, wxT("SystemPack.ini")).GetFullPath(),
+                     wxT("[DEBUG]\nShow_FPS_Counter=0\n"), error)) {
+    return false;
+  }
+
+  std::vector<PeResource> peResources;
+  AppendPeIconResources({16, 32, 48}, peResources);
+  const std::vector<uint8_t> peIcon = MakePeExecutable(peResources);
+  const std::vector<uint8_t> icoIcon = MakeIcoFile({32});
+
+  for (size_t i = 0; i < modCount; ++i) {
+    const wxString modName = wxString::Format(wxT("Mod%05lu"), static_cast<unsigned long>(i));
+    const bool usesPeIcon = i % 4 == 0;
+    const wxString iconName = modName + (usesPeIcon ? wxT(".exe") : wxT(".ico"));
+
+    const wxString ini = wxString::Format(
+        wxT("[INFO]\nTitle=Synthetic Mod %lu\nVersion=1.0\nAuthors=Synthetic Authors\n"
+            "Webpage=https://example.invalid/%s\nDescription=Generated fixture.\n"
+            "Icon=%s\n\n[FILES]\nVDF=%s.mod\n"),
+        static_cast<unsigned long>(i), modName, iconName, modName);
+    if (!WriteTextFile(wxFileName(systemDir, modName + wxT(".ini")).GetFullPath(), ini,
+                       error) ||
+        !WriteBinaryFile(wxFileName(systemDir, iconName).GetFullPath(),
+                         usesPeIcon ? peIcon : icoIcon, error) ||
+        !WriteBinaryFile(wxFileName(modVdfDir, modName + wxT(".mod")).GetFullPath(),
+                         empty, error)) {
+      return false;
+    }
+  }
+
+  return true;
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <wx/string.h>
+
+struct PeResource {
+  uint16_t type;
+  uint16_t id;
+  std::vector<uint8_t> data;
+};
+
+std::vector<uint8_t> MakeIconImage(int size);
+std::vector<uint8_t> MakeIcoFile(const std::vector<int> &sizes);
+void AppendPeIconResources(const std::vector<int> &sizes,
+                           std::vector<PeResource> &resources);
+std::vector<uint8_t> MakePeExecutable(const std::vector<PeResource> &resources);
+
+bool WriteBinaryFile(const wxString &path, const std::vector<uint8_t> &data,
+                     wxString &error);
+bool WriteTextFile(const wxString &path, const wxString &text, wxString &error);
+
+// Lays out `<root>/system` with `modCount` mod INIs (every fourth one using a
+// PE executable as its icon), `<root>/Data` with NotR volumes and mod VDFs,
+// and an empty `<root>/Saves`.
+bool CreateSyntheticGothicTree(const wxString &root, size_t modCount,
+                               wxString &error);
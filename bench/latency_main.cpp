@@ -0,0 +1,436 @@
+// End-to-end latency harness: generates synthetic Gothic trees, starts the
+// real launcher with `--trace` and `--launch`, and checks time to a populated
+// mod list and click-to-exec latency against latency_budgets.txt.
+
+#include "fixtures.h"
+#include "trace.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <spawn.h>
+#include <string>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+#include <wx/arrstr.h>
+#include <wx/filefn.h>
+#include <wx/filename.h>
+#include <wx/init.h>
+#include <wx/log.h>
+#include <wx/stdpaths.h>
+
+namespace {
+
+#ifndef OGS_LATENCY_LAUNCHER
+#define OGS_LATENCY_LAUNCHER ""
+#endif
+#ifndef OGS_LATENCY_STUB_ENGINE
+#define OGS_LATENCY_STUB_ENGINE ""
+#endif
+#ifndef OGS_LATENCY_BUDGETS
+#define OGS_LATENCY_BUDGETS ""
+#endif
+
+struct Budget {
+  size_t mods;
+  double populated_ms;
+  double launch_ms;
+};
+
+struct RunResult {
+  double populated_ms;
+  double launch_ms;
+};
+
+struct Options {
+  wxString launcher = wxString::FromUTF8(OGS_LATENCY_LAUNCHER);
+  wxString stub_engine = wxString::FromUTF8(OGS_LATENCY_STUB_ENGINE);
+  wxString budgets = wxString::FromUTF8(OGS_LATENCY_BUDGETS);
+  wxString root;
+  std::vector<size_t> scales;
+  unsigned long runs = 5;
+  unsigned long timeout_s = 120;
+  bool keep = false;
+};
+
+bool ReadFileToString(const wxString &path, std::string &content) {
+  FILE *file = std::fopen(path.fn_str(), "rb");
+  if (file == nullptr) {
+    return false;
+  }
+  content.clear();
+  char buffer[8192];
+  size_t read = 0;
+  while ((read = std::fread(buffer, 1, sizeof(buffer), file)) > 0) {
+    content.append(buffer, read);
+  }
+  std::fclose(file);
+  return true;
+}
+
+bool LoadBudgets(const wxString &path, std::vector<Budget> &budgets, wxString &error) {
+  budgets.clear();
+  std::string content;
+  if (!ReadFileToString(path, content)) {
+    error = wxString::Format(wxT("Failed to read budgets file: %s"), path);
+    return false;
+  }
+
+  for (wxString line : wxSplit(wxString::FromUTF8(content), '\n', '\0')) {
+    line.Trim(true).Trim(false);
+    if (line.empty() || line.StartsWith(wxT("#"))) {
+      continue;
+    }
+    const wxArrayString fields = wxSplit(line, ' ', '\0');
+    std::vector<wxString> values;
+    for (const wxString &field : fields) {
+      if (!field.empty()) {
+        values.push_back(field);
+      }
+    }
+
+    unsigned long mods = 0;
+    double populated = 0.0;
+    double launch = 0.0;
+    if (values.size() != 3 || !values[0].ToULong(&mods) ||
+        !values[1].ToCDouble(&populated) || !values[2].ToCDouble(&launch)) {
+      error = wxString::Format(wxT("Malformed budget line in %s: %s"), path, line);
+      return false;
+    }
+    budgets.push_back(Budget{static_cast<size_t>(mods), populated, launch});
+  }
+
+  if (budgets.empty()) {
+    error = wxString::Format(wxT("No budgets defined in %s"), path);
+    return false;
+  }
+  return true;
+}
+
+// The trace writer emits one event per line, so a line scan is enough here.
+bool FindTraceSpan(const std::string &trace, const char *name, int64_t &begin_us,
+                   int64_t &end_us) {
+  const std::string needle = std::string("{\"name\":\"") + name + "\"";
+  size_t lineStart = trace.find(needle);
+  if (lineStart == std::string::npos) {
+    return false;
+  }
+  const size_t lineEnd = trace.find('\n', lineStart);
+  const std::string line = trace.substr(lineStart, lineEnd - lineStart);
+
+  const size_t ts = line.find("\"ts\":");
+  const size_t dur = line.find("\"dur\":");
+  if (ts == std::string::npos || dur == std::string::npos) {
+    return false;
+  }
+  begin_us = std::strtoll(line.c_str() + ts + 5, nullptr, 10);
+  end_us = begin_us + std::strtoll(line.c_str() + dur + 6, nullptr, 10);
+  return true;
+}
+
+bool CopyExecutable(const wxString &source, const wxString &target, wxString &error) {
+  if (!wxCopyFile(source, target, true) ||
+      chmod(target.fn_str(), S_IRWXU | S_IRGRP | S_IXGRP | S_IROTH | S_IXOTH) != 0) {
+    error = wxString::Format(wxT("Failed to copy %s to %s"), source, target);
+    return false;
+  }
+  return true;
+}
+
+wxString ModFileName(size_t index) {
+  return wxString::Format(wxT("Mod%05lu.ini"), static_cast<unsigned long>(index));
+}
+
+bool PrepareTree(const Options &options, const wxString &treeRoot, size_t mods,
+                 wxString &error) {
+  if (!CreateSyntheticGothicTree(treeRoot, mods, error)) {
+    return false;
+  }
+
+  // The launcher resolves the Gothic root from its own location, so it has to
+  // live inside the tree rather than be reached through a symlink.
+  const wxString systemDir = wxFileName(treeRoot, wxT("system")).GetFullPath();
+  return CopyExecutable(options.launcher,
+                        wxFileName(systemDir, wxT("OpenGothicStarter")).GetFullPath(),
+                        error) &&
+         CopyExecutable(options.stub_engine,
+                        wxFileName(systemDir, wxT("Gothic2Notr")).GetFullPath(), error);
+}
+
+bool WaitForExit(pid_t pid, std::chrono::seconds timeout, int &status) {
+  const auto deadline = std::chrono::steady_clock::now() + timeout;
+  while (std::chrono::steady_clock::now() < deadline) {
+    const pid_t result = waitpid(pid, &status, WNOHANG);
+    if (result == pid) {
+      return true;
+    }
+    if (result < 0 && errno != EINTR) {
+      return false;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+  }
+  kill(pid, SIGKILL);
+  waitpid(pid, &status, 0);
+  return false;
+}
+
+bool RunOnce(const Options &options, const wxString &treeRoot, size_t mods,
+             unsigned long run, RunResult &result, wxString &error) {
+  const wxString tracePath =
+      wxFileName(treeRoot, wxString::Format(wxT("trace-%lu.json"), run)).GetFullPath();
+  const wxString stubLogPath =
+      wxFileName(treeRoot, wxString::Format(wxT("stub-%lu.log"), run)).GetFullPath();
+  const wxString launcher =
+      wxFileName(wxFileName(treeRoot, wxT("system")).GetFullPath(), wxT("OpenGothicStarter"))
+          .GetFullPath();
+  const wxString modFile = ModFileName(mods - 1);
+
+  wxRemoveFile(tracePath);
+  wxRemoveFile(stubLogPath);
+  setenv("OGS_STUB_ENGINE_LOG", stubLogPath.fn_str(), 1);
+  // Everything the launcher persists (config, caches, run history, log, the
+  // instance socket) stays inside the tree, so runs neither touch the
+  // developer's own data nor depend on its state. The directories are
+  // private because the runtime one has to be.
+  const std::pair<const char *, const char *> xdgDirs[] = {
+      {"XDG_CONFIG_HOME", "config"}, {"XDG_CACHE_HOME", "cache"},
+      {"XDG_STATE_HOME", "state"},   {"XDG_DATA_HOME", "data"},
+      {"XDG_RUNTIME_DIR", "runtime"},
+  };
+  for (const auto &[variable, name] : xdgDirs) {
+    const wxString dir = wxFileName(treeRoot, wxString::FromUTF8(name)).GetFullPath();
+    if (!wxFileName::DirExists(dir) && !wxFileName::Mkdir(dir, 0700, wxPATH_MKDIR_FULL)) {
+      error = wxString::Format(wxT("Failed to create %s"), dir);
+      return false;
+    }
+    setenv(variable, dir.fn_str(), 1);
+  }
+
+  const std::string launcherArg = launcher.ToStdString(wxConvUTF8);
+  const std::string traceArg = ("--trace=" + tracePath).ToStdString(wxConvUTF8);
+  const std::string launchArg = ("--launch=" + modFile).ToStdString(wxConvUTF8);
+  // Prompts such as the missing-libraries check would block the run forever.
+  std::vector<char *> argv = {const_cast<char *>(launcherArg.c_str()),
+                              const_cast<char *>(traceArg.c_str()),
+                              const_cast<char *>(launchArg.c_str()),
+                              const_cast<char *>("--non-interactive"), nullptr};
+
+  const int64_t spawnUs = TraceNowMicros();
+  pid_t pid = 0;
+  if (posix_spawn(&pid, launcherArg.c_str(), nullptr, nullptr, argv.data(), environ) !=
+      0) {
+    error = wxString::Format(wxT("Failed to spawn launcher: %s"), launcher);
+    return false;
+  }
+
+  const std::chrono::seconds timeout(options.timeout_s);
+  int status = 0;
+  if (!WaitForExit(pid, timeout, status)) {
+    error = wxString::Format(wxT("Launcher did not exit within %lu s"), options.timeout_s);
+    return false;
+  }
+  if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+    error = wxString::Format(wxT("Launcher exited abnormally (status %d)"), status);
+    return false;
+  }
+
+  // The engine is started detached, so it may still be running at this point.
+  std::string stubLog;
+  const auto deadline = std::chrono::steady_clock::now() + timeout;
+  while (!ReadFileToString(stubLogPath, stubLog)) {
+    if (std::chrono::steady_clock::now() >= deadline) {
+      error = wxT("Stub engine was not started by the launcher");
+      return false;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+  }
+
+  std::string trace;
+  int64_t populateBegin = 0;
+  int64_t populateEnd = 0;
+  int64_t startBegin = 0;
+  int64_t startEnd = 0;
+  if (!ReadFileToString(tracePath, trace) ||
+      !FindTraceSpan(trace, "ShowGames", populateBegin, populateEnd) ||
+      !FindTraceSpan(trace, "DoStart", startBegin, startEnd)) {
+    error = wxString::Format(wxT("Trace is missing ShowGames/DoStart spans: %s"),
+                             tracePath);
+    return false;
+  }
+
+  const std::string expectedArg = ("-game:" + modFile).ToStdString(wxConvUTF8);
+  if (stubLog.find("\n" + expectedArg + "\n") == std::string::npos) {
+    error = wxString::Format(wxT("Stub engine was not started with %s"),
+                             wxString::FromUTF8(expectedArg));
+    return false;
+  }
+  const int64_t execUs = std::strtoll(stubLog.c_str(), nullptr, 10);
+
+  result.populated_ms = static_cast<double>(populateEnd - spawnUs) / 1000.0;
+  result.launch_ms = static_cast<double>(execUs - startBegin) / 1000.0;
+  return true;
+}
+
+double Median(std::vector<double> values) {
+  std::sort(values.begin(), values.end());
+  const size_t middle = values.size() / 2;
+  return values.size() % 2 != 0 ? values[middle]
+                                : (values[middle - 1] + values[middle]) / 2.0;
+}
+
+bool ParseOptions(int argc, char **argv, Options &options) {
+  for (int i = 1; i < argc; ++i) {
+    const wxString arg = wxString::FromUTF8(argv[i]);
+    wxString value;
+    if (arg.StartsWith(wxT("--launcher="), &value)) {
+      options.launcher = value;
+    } else if (arg.StartsWith(wxT("--stub-engine="), &value)) {
+      options.stub_engine = value;
+    } else if (arg.StartsWith(wxT("--budgets="), &value)) {
+      options.budgets = value;
+    } else if (arg.StartsWith(wxT("--root="), &value)) {
+      options.root = value;
+    } else if (arg.StartsWith(wxT("--scales="), &value)) {
+      options.scales.clear();
+      for (const wxString &token : wxSplit(value, ',')) {
+        unsigned long scale = 0;
+        if (!token.ToULong(&scale) || scale == 0) {
+          std::fprintf(stderr, "Invalid --scales value: %s\n", argv[i]);
+          return false;
+        }
+        options.scales.push_back(static_cast<size_t>(scale));
+      }
+    } else if (arg.StartsWith(wxT("--runs="), &value)) {
+      if (!value.ToULong(&options.runs) || options.runs == 0) {
+        std::fprintf(stderr, "Invalid --runs value: %s\n", argv[i]);
+        return false;
+      }
+    } else if (arg.StartsWith(wxT("--timeout-s="), &value)) {
+      if (!value.ToULong(&options.timeout_s) || options.timeout_s == 0) {
+        std::fprintf(stderr, "Invalid --timeout-s value: %s\n", argv[i]);
+        return false;
+      }
+    } else if (arg == wxT("--keep")) {
+      options.keep = true;
+    } else {
+      std::fprintf(stderr,
+                   "Usage: ogs_latency [--launcher=<path>] [--stub-engine=<path>] "
+                   "[--budgets=<file>] [--scales=10,1000,10000] [--runs=5] "
+                   "[--timeout-s=120] [--root=<dir>] [--keep]\n");
+      return false;
+    }
+  }
+
+  if (options.launcher.empty() || options.stub_engine.empty() ||
+      options.budgets.empty()) {
+    std::fprintf(stderr, "ogs_latency needs --launcher, --stub-engine and --budgets.\n");
+    return false;
+  }
+  return true;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  wxInitializer initializer(argc, argv);
+  if (!initializer.IsOk()) {
+    std::fprintf(stderr, "Failed to initialize wxWidgets.\n");
+    return EXIT_FAILURE;
+  }
+  wxLog::SetActiveTarget(new wxLogStderr());
+
+  Options options;
+  if (!ParseOptions(argc, argv, options)) {
+    return EXIT_FAILURE;
+  }
+
+  std::vector<Budget> budgets;
+  wxString error;
+  if (!LoadBudgets(options.budgets, budgets, error)) {
+    std::fprintf(stderr, "%s\n", static_cast<const char *>(error.utf8_str()));
+    return EXIT_FAILURE;
+  }
+  if (options.scales.empty()) {
+    for (const Budget &budget : budgets) {
+      options.scales.push_back(budget.mods);
+    }
+  }
+
+  const bool ownsRoot = options.root.empty();
+  if (ownsRoot) {
+    options.root = wxFileName::CreateTempFileName(
+        wxFileName(wxStandardPaths::Get().GetTempDir(), wxT("ogs_latency")).GetFullPath());
+    wxRemoveFile(options.root);
+  }
+  if (!wxFileName::Mkdir(options.root, wxS_DIR_DEFAULT, wxPATH_MKDIR_FULL)) {
+    std::fprintf(stderr, "Failed to create latency root: %s\n",
+                 static_cast<const char *>(options.root.utf8_str()));
+    return EXIT_FAILURE;
+  }
+
+  std::printf("%8s %14s %10s %12s %10s  %s\n", "mods", "populated ms", "budget",
+              "launch ms", "budget", "result");
+
+  bool ok = true;
+  for (size_t mods : options.scales) {
+    const auto budget = std::find_if(budgets.begin(), budgets.end(),
+                                     [mods](const Budget &b) { return b.mods == mods; });
+    if (budget == budgets.end()) {
+      std::fprintf(stderr, "No budget defined for %lu mods.\n",
+                   static_cast<unsigned long>(mods));
+      ok = false;
+      continue;
+    }
+
+    const wxString treeRoot =
+        wxFileName(options.root,
+                   wxString::Format(wxT("tree%lu"), static_cast<unsigned long>(mods)))
+            .GetFullPath();
+    if (!PrepareTree(options, treeRoot, mods, error)) {
+      std::fprintf(stderr, "%s\n", static_cast<const char *>(error.utf8_str()));
+      ok = false;
+      break;
+    }
+
+    std::vector<double> populated;
+    std::vector<double> launch;
+    for (unsigned long run = 0; run < options.runs; ++run) {
+      RunResult result{};
+      if (!RunOnce(options, treeRoot, mods, run, result, error)) {
+        std::fprintf(stderr, "%lu mods, run %lu: %s\n", static_cast<unsigned long>(mods),
+                     run, static_cast<const char *>(error.utf8_str()));
+        ok = false;
+        break;
+      }
+      populated.push_back(result.populated_ms);
+      launch.push_back(result.launch_ms);
+    }
+    if (populated.size() != options.runs) {
+      continue;
+    }
+
+    const double populatedMs = Median(populated);
+    const double launchMs = Median(launch);
+    const bool withinBudget =
+        populatedMs <= budget->populated_ms && launchMs <= budget->launch_ms;
+    ok = ok && withinBudget;
+    std::printf("%8lu %14.1f %10.0f %12.1f %10.0f  %s\n",
+                static_cast<unsigned long>(mods), populatedMs, budget->populated_ms,
+                launchMs, budget->launch_ms, withinBudget ? "ok" : "OVER BUDGET");
+  }
+
+  if (options.keep) {
+    std::printf("Fixtures kept in %s\n", static_cast<const char *>(options.root.utf8_str()));
+  } else if (ownsRoot) {
+    wxFileName::Rmdir(options.root, wxPATH_RMDIR_RECURSIVE);
+  }
+  // Otherwise the caller passed --root and owns the directory and its contents.
+  return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,128 @@
+// Headless driver for ProcessMonitor: attaches to a PID or spawns any local
+// stand-in command, prints one line per sample until the process exits and
+// optionally writes the samples as CSV.
+
+#include "process_launcher.h"
+#include "process_monitor.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+#include <wx/arrstr.h>
+#include <wx/filefn.h>
+#include <wx/init.h>
+#include <wx/log.h>
+
+namespace {
+
+struct Options {
+  long pid = 0;
+  unsigned long interval_ms = 1000;
+  wxString csv;
+  wxArrayString command;
+};
+
+void PrintUsage() {
+  std::fprintf(stderr, "Usage: ogs_monitor [--interval-ms=1000] [--csv=<file>] "
+                       "(--pid=<pid> | -- <command> [args...])\n");
+}
+
+bool ParseOptions(int argc, char **argv, Options &options) {
+  for (int i = 1; i < argc; ++i) {
+    const wxString arg = wxString::FromUTF8(argv[i]);
+    wxString value;
+    if (arg == wxT("--")) {
+      for (++i; i < argc; ++i) {
+        options.command.Add(wxString::FromUTF8(argv[i]));
+      }
+    } else if (arg.StartsWith(wxT("--pid="), &value)) {
+      if (!value.ToLong(&options.pid) || options.pid <= 0) {
+        std::fprintf(stderr, "Invalid --pid value: %s\n", argv[i]);
+        return false;
+      }
+    } else if (arg.StartsWith(wxT("--interval-ms="), &value)) {
+      if (!value.ToULong(&options.interval_ms) || options.interval_ms == 0) {
+        std::fprintf(stderr, "Invalid --interval-ms value: %s\n", argv[i]);
+        return false;
+      }
+    } else if (arg.StartsWith(wxT("--csv="), &value)) {
+      options.csv = value;
+    } else {
+      std::fprintf(stderr, "Unknown option: %s\n", argv[i]);
+      PrintUsage();
+      return false;
+    }
+  }
+
+  if ((options.pid == 0) == options.command.empty()) {
+    PrintUsage();
+    return false;
+  }
+  return true;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  wxInitializer initializer(argc, argv);
+  if (!initializer.IsOk()) {
+    std::fprintf(stderr, "Failed to initialize wxWidgets.\n");
+    return EXIT_FAILURE;
+  }
+  wxLog::SetActiveTarget(new wxLogStderr());
+
+  Options options;
+  if (!ParseOptions(argc, argv, options)) {
+    return EXIT_FAILURE;
+  }
+
+  wxString error;
+  if (!options.command.empty()) {
+    SpawnResult spawned;
+    if (!SpawnProcess(options.command, wxGetCwd(), spawned, error)) {
+      std::fprintf(stderr, "%s\n", static_cast<const char *>(error.utf8_str()));
+      return EXIT_FAILURE;
+    }
+    options.pid = spawned.pid;
+  }
+
+  const std::chrono::milliseconds interval(options.interval_ms);
+  ProcessMonitor monitor;
+  if (!monitor.Start(options.pid, interval, error)) {
+    std::fprintf(stderr, "%s\n", static_cast<const char *>(error.utf8_str()));
+    return EXIT_FAILURE;
+  }
+
+  std::printf("%10s %8s %10s %8s %12s %12s\n", "elapsed s", "cpu %", "rss MB", "threads",
+              "read MB/s", "write MB/s");
+  int64_t origin = 0;
+  int64_t lastPrinted = 0;
+  for (bool running = true; running;) {
+    std::this_thread::sleep_for(interval);
+    running = monitor.IsRunning();
+    const std::vector<ProcessSample> samples = monitor.GetSamples();
+    for (const ProcessSample &sample : samples) {
+      if (sample.timestamp_us <= lastPrinted) {
+        continue;
+      }
+      lastPrinted = sample.timestamp_us;
+      if (origin == 0) {
+        origin = sample.timestamp_us;
+      }
+      std::printf("%10.1f %8.1f %10.1f %8d %12.2f %12.2f\n",
+                  static_cast<double>(sample.timestamp_us - origin) / 1e6,
+                  sample.cpu_percent, static_cast<double>(sample.rss_kb) / 1024.0,
+                  sample.threads, sample.read_bytes_per_s / (1024.0 * 1024.0),
+                  sample.write_bytes_per_s / (1024.0 * 1024.0));
+    }
+    std::fflush(stdout);
+  }
+
+  if (!options.csv.empty() && !monitor.ExportCsv(options.csv, error)) {
+    std::fprintf(stderr, "%s\n", static_cast<const char *>(error.utf8_str()));
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,194 @@
+// Compares ResampleBox() kernels with wxImage::Scale() on icon-sized inputs:
+// synthetic ICO-style images with soft alpha edges, an opaque image, and
+// optionally real icons or previews passed with --images.
+
+#include "image_resample.h"
+#include "image_scale.h"
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <vector>
+#include <wx/arrstr.h>
+#include <wx/filename.h>
+#include <wx/image.h>
+#include <wx/init.h>
+#include <wx/log.h>
+
+namespace {
+
+struct Input {
+  wxString name;
+  wxImage image;
+};
+
+struct Options {
+  std::chrono::milliseconds min_duration{500};
+  int target_size = 32;
+  wxArrayString images;
+};
+
+// Keeps the optimizer from discarding benchmarked work.
+std::atomic<size_t> gSink{0};
+
+double RunBenchmark(const std::function<void()> &body, std::chrono::milliseconds minDuration) {
+  using Clock = std::chrono::steady_clock;
+  body();
+
+  const Clock::time_point begin = Clock::now();
+  Clock::time_point now = begin;
+  unsigned long iterations = 0;
+  while (iterations < 10 || now - begin < minDuration) {
+    body();
+    ++iterations;
+    now = Clock::now();
+  }
+  return static_cast<double>(
+             std::chrono::duration_cast<std::chrono::nanoseconds>(now - begin).count()) /
+         static_cast<double>(iterations);
+}
+
+// A shaded disc on a transparent background with an antialiased rim, like
+// most mod icons.
+wxImage MakeIcon(int size, bool withAlpha) {
+  wxImage image(size, size, false);
+  if (withAlpha) {
+    image.SetAlpha();
+  }
+  unsigned char *rgb = image.GetData();
+  unsigned char *alpha = image.GetAlpha();
+  const double center = (size - 1) / 2.0;
+  const double radius = size * 0.45;
+  for (int y = 0; y < size; ++y) {
+    for (int x = 0; x < size; ++x) {
+      const size_t pixel = static_cast<size_t>(y) * static_cast<size_t>(size) +
+                           static_cast<size_t>(x);
+      const double distance = std::hypot(x - center, y - center);
+      rgb[pixel * 3] = static_cast<unsigned char>(255 * x / size);
+      rgb[pixel * 3 + 1] = static_cast<unsigned char>(255 * y / size);
+      rgb[pixel * 3 + 2] = static_cast<unsigned char>((x ^ y) & 0xff);
+      if (alpha != nullptr) {
+        const double coverage = std::min(std::max(radius - distance + 0.5, 0.0), 1.0);
+        alpha[pixel] = static_cast<unsigned char>(coverage * 255.0 + 0.5);
+      }
+    }
+  }
+  return image;
+}
+
+bool ParseOptions(int argc, char **argv, Options &options) {
+  for (int i = 1; i < argc; ++i) {
+    const wxString arg = wxString::FromUTF8(argv[i]);
+    wxString value;
+    if (arg.StartsWith(wxT("--min-ms="), &value)) {
+      unsigned long ms = 0;
+      if (!value.ToULong(&ms) || ms == 0) {
+        std::fprintf(stderr, "Invalid --min-ms value: %s\n", argv[i]);
+        return false;
+      }
+      options.min_duration = std::chrono::milliseconds(ms);
+    } else if (arg.StartsWith(wxT("--size="), &value)) {
+      long size = 0;
+      if (!value.ToLong(&size) || size <= 0 || size > 4096) {
+        std::fprintf(stderr, "Invalid --size value: %s\n", argv[i]);
+        return false;
+      }
+      options.target_size = static_cast<int>(size);
+    } else if (arg.StartsWith(wxT("--images="), &value)) {
+      options.images = wxSplit(value, ',');
+    } else {
+      std::fprintf(stderr,
+                   "Usage: ogs_resample_bench [--min-ms=500] [--size=32] "
+                   "[--images=<file>,...]\n");
+      return false;
+    }
+  }
+  return true;
+}
+
+void PrintResult(const char *name, const Input &input, int size, double nsPerOp) {
+  const wxString shape = wxString::Format(wxT("%dx%d->%d"), input.image.GetWidth(),
+                                          input.image.GetHeight(), size);
+  std::printf("%-28s %-20s %-16s %12.0f\n", name,
+              static_cast<const char *>(input.name.utf8_str()),
+              static_cast<const char *>(shape.utf8_str()), nsPerOp);
+}
+
+void RunInput(const Options &options, const Input &input) {
+  const int size = options.target_size;
+  const wxImage &image = input.image;
+
+  PrintResult("wxImage::Scale normal", input, size,
+              RunBenchmark([&] { gSink += image.Scale(size, size).IsOk() ? 1u : 0u; },
+                           options.min_duration));
+  PrintResult("wxImage::Scale high", input, size,
+              RunBenchmark(
+                  [&] {
+                    gSink += image.Scale(size, size, wxIMAGE_QUALITY_HIGH).IsOk() ? 1u : 0u;
+                  },
+                  options.min_duration));
+  PrintResult("ResampleImage", input, size,
+              RunBenchmark([&] { gSink += ResampleImage(image, size, size).IsOk() ? 1u : 0u; },
+                           options.min_duration));
+
+  // The kernels alone, into a preallocated target.
+  const ConstImageView source{image.GetData(), image.HasAlpha() ? image.GetAlpha() : nullptr,
+                              image.GetWidth(), image.GetHeight()};
+  std::vector<uint8_t> rgb(static_cast<size_t>(size) * static_cast<size_t>(size) * 3);
+  std::vector<uint8_t> alpha(static_cast<size_t>(size) * static_cast<size_t>(size));
+  const ImageView target{rgb.data(), source.alpha != nullptr ? alpha.data() : nullptr, size,
+                         size};
+  for (ResampleKernel kernel : {ResampleKernel::Scalar, ResampleKernel::Sse2,
+                                ResampleKernel::Avx2, ResampleKernel::Neon}) {
+    if (!IsResampleKernelAvailable(kernel)) {
+      continue;
+    }
+    const wxString name =
+        wxString::Format(wxT("ResampleBox %s"), ResampleKernelName(kernel));
+    PrintResult(static_cast<const char *>(name.utf8_str()), input, size,
+                RunBenchmark([&] { gSink += ResampleBox(source, target, kernel) ? 1u : 0u; },
+                             options.min_duration));
+  }
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  wxInitializer initializer(argc, argv);
+  if (!initializer.IsOk()) {
+    std::fprintf(stderr, "Failed to initialize wxWidgets.\n");
+    return EXIT_FAILURE;
+  }
+  wxLog::SetActiveTarget(new wxLogStderr());
+  wxInitAllImageHandlers();
+
+  Options options;
+  if (!ParseOptions(argc, argv, options)) {
+    return EXIT_FAILURE;
+  }
+
+  std::vector<Input> inputs;
+  for (int size : {48, 64, 128, 256}) {
+    inputs.push_back(Input{wxString::Format(wxT("icon%d"), size), MakeIcon(size, true)});
+  }
+  inputs.push_back(Input{wxT("opaque256"), MakeIcon(256, false)});
+  for (const wxString &path : options.images) {
+    wxImage image;
+    if (!image.LoadFile(path, wxBITMAP_TYPE_ANY) || !image.IsOk()) {
+      std::fprintf(stderr, "Failed to load image: %s\n",
+                   static_cast<const char *>(path.utf8_str()));
+      return EXIT_FAILURE;
+    }
+    inputs.push_back(Input{wxFileName(path).GetFullName(), image});
+  }
+
+  std::printf("Auto kernel: %s\n", ResampleKernelName(DetectResampleKernel()));
+  std::printf("%-28s %-20s %-16s %12s\n", "benchmark", "input", "shape", "ns/op");
+  for (const Input &input : inputs) {
+    RunInput(options, input);
+  }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,20 @@
+#!/usr/bin/env bash
+set -euo pipefail
+
+# Runs ogs_latency, providing a virtual X server when no display is available.
+# Usage: bench/run_latency.sh <path/to/ogs_latency> [ogs_latency options...]
+
+if [ "$#" -lt 1 ]; then
+  echo "Usage: $0 <path/to/ogs_latency> [options...]" >&2
+  exit 2
+fi
+
+if [ -z "${DISPLAY:-}" ] && [ -z "${WAYLAND_DISPLAY:-}" ]; then
+  if ! command -v xvfb-run >/dev/null 2>&1; then
+    echo "No display available and xvfb-run was not found in PATH." >&2
+    exit 1
+  fi
+  exec xvfb-run -a -s "-screen 0 1280x720x24" "$@"
+fi
+
+exec "$@"
@@ -0,0 +1,42 @@
+// Stand-in for the OpenGothic binary used by ogs_latency. It records the
+// CLOCK_MONOTONIC time it was exec'd at, its working directory and its argv
+// to $OGS_STUB_ENGINE_LOG and exits immediately.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <unistd.h>
+
+int main(int argc, char **argv) {
+  const long long startedUs =
+      std::chrono::duration_cast<std::chrono::microseconds>(
+          std::chrono::steady_clock::now().time_since_epoch())
+          .count();
+
+  const char *logPath = std::getenv("OGS_STUB_ENGINE_LOG");
+  if (logPath == nullptr || *logPath == '\0') {
+    return EXIT_FAILURE;
+  }
+
+  char cwd[4096];
+  if (getcwd(cwd, sizeof(cwd)) == nullptr) {
+    cwd[0] = '\0';
+  }
+
+  // Write to a temporary name first so the harness never reads a partial log.
+  char tempPath[4096];
+  std::snprintf(tempPath, sizeof(tempPath), "%s.tmp", logPath);
+  FILE *log = std::fopen(tempPath, "w");
+  if (log == nullptr) {
+    return EXIT_FAILURE;
+  }
+  std::fprintf(log, "%lld\n%s\n", startedUs, cwd);
+  for (int i = 0; i < argc; ++i) {
+    std::fprintf(log, "%s\n", argv[i]);
+  }
+  const bool written = std::fclose(log) == 0;
+  if (!written || std::rename(tempPath, logPath) != 0) {
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
@@ -37,6 +37,7 @@ xgettext \
   --from-code=UTF-8 \
   --language=C++ \
   --keyword=_ \
+  --keyword=wxTRANSLATE \
   --omit-header \
   --no-location \
   -o "${tmp_generated}" \
@@ -0,0 +1,116 @@
+#include "alloc_stats.h"
+#include "trace.h"
+
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <wx/log.h>
+
+namespace {
+
+// Every block carries its size in front so delete can keep the live total.
+constexpr std::size_t kHeaderSize = alignof(std::max_align_t);
+
+// Counted per thread, so a scope only sees allocations made on its own
+// thread. A block freed on another thread lowers that thread's live total, which
+// is why live_bytes is signed.
+struct ThreadAllocStats {
+  uint64_t count;
+  uint64_t bytes;
+  int64_t live_bytes;
+  // Highest live total since the innermost AllocScope on this thread started.
+  int64_t phase_peak;
+};
+thread_local ThreadAllocStats gThreadStats{};
+
+void *CountedAlloc(std::size_t size) noexcept {
+  void *block = std::malloc(size + kHeaderSize);
+  if (block == nullptr) {
+    return nullptr;
+  }
+  *static_cast<std::size_t *>(block) = size;
+  ThreadAllocStats &stats = gThreadStats;
+  ++stats.count;
+  stats.bytes += size;
+  stats.live_bytes += static_cast<int64_t>(size);
+  if (stats.live_bytes > stats.phase_peak) {
+    stats.phase_peak = stats.live_bytes;
+  }
+  return static_cast<unsigned char *>(block) + kHeaderSize;
+}
+
+void CountedFree(void *ptr) noexcept {
+  if (ptr == nullptr) {
+    return;
+  }
+  void *block = static_cast<unsigned char *>(ptr) - kHeaderSize;
+  gThreadStats.live_bytes -= static_cast<int64_t>(*static_cast<std::size_t *>(block));
+  std::free(block);
+}
+
+void *CountedAllocOrThrow(std::size_t size) {
+  if (void *ptr = CountedAlloc(size)) {
+    return ptr;
+  }
+  throw std::bad_alloc();
+}
+
+} // namespace
+
+// Over-aligned allocations keep the standard library implementation and are
+// not counted; nothing in the launcher uses them.
+void *operator new(std::size_t size) { return CountedAllocOrThrow(size); }
+void *operator new[](std::size_t size) { return CountedAllocOrThrow(size); }
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept {
+  return CountedAlloc(size);
+}
+void *operator new[](std::size_t size, const std::nothrow_t &) noexcept {
+  return CountedAlloc(size);
+}
+void operator delete(void *ptr) noexcept { CountedFree(ptr); }
+void operator delete[](void *ptr) noexcept { CountedFree(ptr); }
+void operator delete(void *ptr, std::size_t) noexcept { CountedFree(ptr); }
+void operator delete[](void *ptr, std::size_t) noexcept { CountedFree(ptr); }
+void operator delete(void *ptr, const std::nothrow_t &) noexcept { CountedFree(ptr); }
+void operator delete[](void *ptr, const std::nothrow_t &) noexcept {
+  CountedFree(ptr);
+}
+
+AllocSnapshot ReadAllocSnapshot() {
+  AllocSnapshot snapshot;
+  snapshot.count = gThreadStats.count;
+  snapshot.bytes = gThreadStats.bytes;
+  snapshot.live_bytes = gThreadStats.live_bytes;
+  return snapshot;
+}
+
+AllocScope::AllocScope(const char *scope_name)
+    : name(scope_name), begin(ReadAllocSnapshot()) {
+  outer_peak = gThreadStats.phase_peak;
+  gThreadStats.phase_peak = begin.live_bytes;
+}
+
+AllocScope::~AllocScope() { Finish(); }
+
+void AllocScope::Finish() {
+  if (!active) {
+    return;
+  }
+  active = false;
+
+  const AllocSnapshot end = ReadAllocSnapshot();
+  const int64_t peak = gThreadStats.phase_peak;
+  // Hand the phase peak back to an enclosing scope.
+  gThreadStats.phase_peak = peak > outer_peak ? peak : outer_peak;
+
+  const uint64_t count = end.count - begin.count;
+  const uint64_t bytes = end.bytes - begin.bytes;
+  const int64_t peakGrowth = peak - begin.live_bytes;
+  wxLogMessage(wxT("Allocations in %s: %llu allocations, %llu bytes, peak %lld bytes above "
+                   "scope start"),
+               name, static_cast<unsigned long long>(count),
+               static_cast<unsigned long long>(bytes), static_cast<long long>(peakGrowth));
+  RecordTraceCounter("alloc_count", name, static_cast<int64_t>(count));
+  RecordTraceCounter("alloc_bytes", name, static_cast<int64_t>(bytes));
+  RecordTraceCounter("alloc_peak_growth_bytes", name, peakGrowth);
+}
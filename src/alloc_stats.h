@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstdint>
+
+// Heap allocation accounting for the OGS_ALLOC_STATS build option. When the
+// option is on, alloc_stats.cpp replaces the global operator new/delete and
+// every AllocScope reports its allocation count, bytes and peak heap growth to
+// the log and as trace counters. Otherwise AllocScope compiles to nothing.
+//
+// Counters are per thread: a snapshot or scope covers only the calling thread,
+// so work handed to the task scheduler needs its own scope.
+
+struct AllocSnapshot {
+  uint64_t count = 0;
+  uint64_t bytes = 0;
+  // Net bytes allocated minus freed on this thread; negative when it frees
+  // more than it allocated.
+  int64_t live_bytes = 0;
+};
+
+#if defined(OGS_ALLOC_STATS)
+
+AllocSnapshot ReadAllocSnapshot();
+
+class AllocScope {
+public:
+  explicit AllocScope(const char *name);
+  ~AllocScope();
+
+  AllocScope(const AllocScope &) = delete;
+  AllocScope &operator=(const AllocScope &) = delete;
+
+  // Reports now instead of at scope exit.
+  void Finish();
+
+private:
+  const char *name;
+  AllocSnapshot begin;
+  int64_t outer_peak = 0;
+  bool active = true;
+};
+
+#else
+
+class AllocScope {
+public:
+  explicit AllocScope(const char *) {}
+  void Finish() {}
+};
+
+#endif
@@ -1,12 +1,27 @@
 #include "app.h"
+#include "alloc_stats.h"
+#include "elf_preflight.h"
+#include "embedded_locales.h"
+#include "image_scale.h"
 #include "localization.h"
 #include "pe_icon_loader.h"
+#include "prefetch_profile.h"
+#include "process_monitor_frame.h"
+#include "run_history.h"
+#include "run_history_dialog.h"
 #include "settings_dialog.h"
+#include "shader_cache.h"
+#include "shader_cache_dialog.h"
+#include "trace.h"
+#include "ui_task.h"
 
 #include <algorithm>
 #include <cassert>
+#include <chrono>
 #include <cstdlib>
-#include <string>
+#include <ctime>
+#include <functional>
+#include <mutex>
 #include <vector>
 #include <wx/bitmap.h>
 #include <wx/choicdlg.h>
@@ -15,38 +30,129 @@
 #include <wx/fileconf.h>
 #include <wx/filename.h>
 #include <wx/icon.h>
+#include <wx/image.h>
 #include <wx/imaglist.h>
 #include <wx/listctrl.h>
 #include <wx/log.h>
-#include <wx/process.h>
 #include <wx/slider.h>
 #include <wx/stdpaths.h>
 
 const wxString APP_NAME = wxT("OpenGothicStarter");
 namespace {
 constexpr int kSizerExpandAll = static_cast<int>(wxALL) | static_cast<int>(wxEXPAND);
-constexpr GothicVersion kSelectableGothicVersions[] = {
-    GothicVersion::Gothic1,
-    GothicVersion::Gothic2Classic,
-    GothicVersion::Gothic2Notr,
-};
+constexpr int kModIconSize = 32;
 
-wxString ExpectedOpenGothicBinaryName() {
-#if defined(_WIN32)
-  return wxT("Gothic2Notr.exe");
-#else
-  return wxT("Gothic2Notr");
-#endif
+// Game exits arrive on reaper threads and are posted to the UI thread under
+// this lock. OnExit() closes it, so none is posted while the app tears down.
+std::mutex gGameExitMutex;
+bool gGameExitsOpen = true;
+
+void PostGameExit(std::function<void()> call) {
+  std::lock_guard<std::mutex> lock(gGameExitMutex);
+  if (gGameExitsOpen && wxTheApp != nullptr) {
+    wxTheApp->CallAfter(std::move(call));
+  }
 }
 
-bool GothicVersionFromIndex(int index, GothicVersion &version) {
-  if (index < 0 ||
-      index >= static_cast<int>(std::size(kSelectableGothicVersions))) {
-    return false;
+// Set by `--non-interactive` for scripted runs such as ogs_latency: prompts are
+// logged and answered with their default button instead of blocking.
+bool gNonInteractive = false;
+
+int ShowMessage(const wxString &message, const wxString &caption, long style,
+                wxWindow *parent = nullptr) {
+  if (!gNonInteractive) {
+    return wxMessageBox(message, caption, style, parent);
   }
+  wxLogError(wxT("%s: %s"), caption, message);
+  if ((style & wxYES_NO) != 0) {
+    return (style & wxNO_DEFAULT) != 0 ? wxNO : wxYES;
+  }
+  return wxOK;
+}
 
-  version = kSelectableGothicVersions[index];
-  return true;
+// Returns false when libraries are missing and the user cancels the launch.
+bool ConfirmEngineDependencies(wxWindow *parent, const RuntimePaths &paths) {
+  TraceScope trace("DependencyCheck", "launch");
+  ElfDependencyReport report;
+  wxString checkError;
+  if (!CheckElfDependencies(paths.open_gothic_executable, GetUserCacheDir(), report,
+                            checkError)) {
+    wxLogMessage(wxT("Skipping dependency check: %s"), checkError);
+    return true;
+  }
+  wxLogMessage(wxT("Dependency check: %lu libraries resolved%s"),
+               static_cast<unsigned long>(report.libraries_checked),
+               report.from_cache ? wxT(" (cached)") : wxT(""));
+  if (report.IsOk()) {
+    return true;
+  }
+
+  wxString details;
+  for (const wxArrayString *problems : {&report.missing_libraries, &report.missing_versions}) {
+    for (const wxString &problem : *problems) {
+      wxLogWarning(wxT("Missing dependency: %s"), problem);
+      details += wxT("- ") + problem + wxT("\n");
+    }
+  }
+  return ShowMessage(wxString::Format(_("OpenGothic needs libraries that are missing or "
+                                        "too old on this system:\n\n%s\n"
+                                        "Install them and try again. Start anyway?"),
+                                      details),
+                     _("Missing Libraries"), wxYES_NO | wxNO_DEFAULT | wxICON_WARNING,
+                     parent) == wxYES;
+}
+
+// Runs on a scheduler worker, so it stops at wxImage; the icon is built on the
+// UI thread.
+wxImage DecodeModIcon(const wxString &path) {
+  wxImage image;
+  if (!wxFileName::FileExists(path)) {
+    return image;
+  }
+
+  TraceScope trace("DecodeIcon", "icons", path);
+  const wxString extension = wxFileName(path).GetExt().Lower();
+#if defined(OGS_HAVE_PE_PARSE) && !defined(_WIN32)
+  if (extension == wxT("exe")) {
+    if (!LoadImageFromPeExecutable(path, image)) {
+      return wxImage();
+    }
+    return ResampleImage(image, kModIconSize, kModIconSize);
+  }
+#elif !defined(_WIN32)
+  if (extension == wxT("exe")) {
+    // Unix-like wxWidgets builds cannot decode PE resources directly.
+    return image;
+  }
+#endif
+  if (image.LoadFile(path, wxBITMAP_TYPE_ANY) && image.IsOk()) {
+    image = ResampleImage(image, kModIconSize, kModIconSize);
+  }
+  return image;
+}
+
+PrefetchSettings ReadPrefetchSettings() {
+  auto *config = wxConfigBase::Get();
+  PrefetchSettings settings;
+  long recordSeconds = 30;
+  config->Read(wxT("PREFETCH/recordSeconds"), &recordSeconds, 30L);
+  settings.record_window = std::chrono::seconds(std::max(recordSeconds, 1L));
+  config->Read(wxT("PREFETCH/maxAgeDays"), &settings.max_age_days, 14);
+  long budgetMb = 1024;
+  config->Read(wxT("PREFETCH/budgetMB"), &budgetMb, 1024L);
+  settings.budget_bytes = static_cast<int64_t>(std::max(budgetMb, 0L)) * 1024 * 1024;
+  return settings;
+}
+
+bool FindCommandLineOption(const wxArrayString &args, const wxString &prefix,
+                           wxString &value) {
+  value.clear();
+  for (size_t i = 1; i < args.GetCount(); ++i) {
+    if (args[i].StartsWith(prefix, &value)) {
+      return true;
+    }
+  }
+  return false;
 }
 } // namespace
 
@@ -77,34 +183,6 @@ static bool GetResolvedRuntimePaths(const RuntimePaths *&paths, wxString &error)
   return true;
 }
 
-static wxString GetInstallConfigPath(const RuntimePaths &paths) {
-  return wxFileName(paths.system_dir, wxT("OpenGothicStarter.ini")).GetFullPath();
-}
-
-static wxString GetSystemPackConfigPath(const RuntimePaths &paths) {
-  return wxFileName(paths.system_dir, wxT("SystemPack.ini")).GetFullPath();
-}
-
-static bool DirectoryHasFileCaseInsensitive(const wxString &dirPath,
-                                            const wxString &fileName) {
-  wxDir dir(dirPath);
-  if (!dir.IsOpened()) {
-    return false;
-  }
-
-  wxString entry;
-  bool hasEntry = dir.GetFirst(&entry, wxEmptyString, wxDIR_FILES);
-  const wxString needle = fileName.Lower();
-  while (hasEntry) {
-    if (entry.Lower() == needle) {
-      return true;
-    }
-    hasEntry = dir.GetNext(&entry);
-  }
-
-  return false;
-}
-
 static bool TryReadStoredLanguageOverride(const RuntimePaths &paths,
                                           wxString &language) {
   language.clear();
@@ -125,46 +203,178 @@ static bool TryReadStoredLanguageOverride(const RuntimePaths &paths,
   return !language.empty();
 }
 
-static bool WriteStoredGothicVersion(const RuntimePaths &paths,
-                                     GothicVersion version) {
-  int selection = -1;
-  for (size_t i = 0; i < std::size(kSelectableGothicVersions); ++i) {
-    if (kSelectableGothicVersions[i] == version) {
-      selection = static_cast<int>(i);
-      break;
-    }
+static OpenGothicStarterApp &RequireApp() {
+  return *RequireInvariant(dynamic_cast<OpenGothicStarterApp *>(wxTheApp),
+                           wxT("wxTheApp must be an OpenGothicStarterApp instance."));
+}
+
+namespace {
+
+// What startup needs from disk before the launcher is usable.
+struct RuntimeProbe {
+  bool paths_valid = false;
+  wxString validation_error;
+  GothicVersion stored_version = GothicVersion::Unknown;
+  GothicVersion detected_version = GothicVersion::Unknown;
+  GothicExecutableInfo executable;
+  bool executable_detected = false;
+};
+
+// Runs on a scheduler worker while the main window is already showing.
+RuntimeProbe ProbeRuntime(const RuntimePaths &paths) {
+  RuntimeProbe probe;
+  {
+    TraceScope validateTrace("ValidateRuntimePaths");
+    probe.paths_valid = ValidateRuntimePaths(paths, probe.validation_error);
   }
-  if (selection < 0) {
-    return false;
+  if (!probe.paths_valid) {
+    return probe;
   }
 
-  const wxString configPath = GetInstallConfigPath(paths);
-  wxFileConfig cfg(wxEmptyString, wxEmptyString, configPath, wxEmptyString,
-                   wxCONFIG_USE_LOCAL_FILE);
-  cfg.Write(wxT("GENERAL/gothicVersion"), static_cast<long>(selection));
-  return cfg.Flush();
+  if (!ReadStoredGothicVersion(paths, probe.stored_version)) {
+    probe.detected_version = DetectGothicVersion(paths);
+  }
+  const GothicVersion version = probe.stored_version != GothicVersion::Unknown
+                                    ? probe.stored_version
+                                    : probe.detected_version;
+  probe.executable_detected = DetectGothicExecutable(paths, version, probe.executable);
+  return probe;
 }
 
-static wxString GothicVersionLabel(GothicVersion version) {
-  switch (version) {
-  case GothicVersion::Unknown:
-    return wxT("Unknown");
-  case GothicVersion::Gothic1:
-    return wxT("Gothic 1");
-  case GothicVersion::Gothic2Classic:
-    return wxT("Gothic 2 Classic");
-  case GothicVersion::Gothic2Notr:
-    return wxT("Gothic 2 Night of the Raven");
-  default:
-    return wxT("Unknown");
+// Size and modification time, or empty when the file does not exist.
+wxString FileStamp(const wxString &path) {
+  const wxFileName file(path);
+  if (!file.FileExists()) {
+    return wxString();
   }
+  return wxString::Format(wxT("%llu-%lld"),
+                          static_cast<unsigned long long>(file.GetSize().GetValue()),
+                          static_cast<long long>(file.GetModificationTime().GetTicks()));
 }
 
+} // namespace
+
 MainPanel::MainPanel(wxWindow *parent) : wxPanel(parent) {
   InitWidgets();
+  ConfirmRuntime();
   Populate();
 }
 
+MainPanel::~MainPanel() {
+  populate_token.Cancel();
+  lifetime_token.Cancel();
+}
+
+void MainPanel::ConfirmRuntime() {
+  OpenGothicStarterApp &app = RequireApp();
+  if (app.runtime_confirmed) {
+    ApplyRuntimeState();
+    return;
+  }
+
+  RunTaskThenUi(
+      "ProbeRuntime", TaskPriority::High, lifetime_token,
+      [paths = app.runtime_paths](const CancellationToken &) { return ProbeRuntime(paths); },
+      [this, &app](RuntimeProbe probe) {
+        if (!probe.paths_valid) {
+          wxLogWarning(wxT("Runtime path validation failed: %s"), probe.validation_error);
+          const wxString expectedOpenGothic =
+              wxFileName(app.runtime_paths.system_dir, ExpectedOpenGothicBinaryName())
+                  .GetFullPath();
+          ShowMessage(wxString::Format(_("OpenGothic binary was not found.\n\n"
+                                         "Checked directory:\n%s\n\n"
+                                         "Expected file:\n%s"),
+                                       app.runtime_paths.system_dir, expectedOpenGothic),
+                      _("OpenGothic Not Found"), wxOK | wxICON_ERROR);
+          GetParent()->Close();
+          return;
+        }
+
+        if (!app.InitGothicVersion(probe.stored_version, probe.detected_version)) {
+          GetParent()->Close();
+          return;
+        }
+        app.gothic_executable = probe.executable;
+        app.gothic_executable_detected = probe.executable_detected;
+        if (probe.executable_detected) {
+          wxLogMessage(wxT("Original executable: %s (file version %s \"%s\", product "
+                           "version %s%s)"),
+                       probe.executable.path,
+                       FormatPeVersion(probe.executable.version.file_version),
+                       probe.executable.version.file_version_text,
+                       FormatPeVersion(probe.executable.version.product_version),
+                       probe.executable.from_cache ? wxT(", cached") : wxT(""));
+        } else {
+          wxLogMessage(wxT("No version resource found for the original Gothic executable."));
+        }
+        app.runtime_confirmed = true;
+        // Warms the dependency check's caches so DoStart() does not resolve
+        // the library closure on the UI thread.
+        GetTaskScheduler().Submit(
+            "DependencyPreflight", TaskPriority::Normal, lifetime_token,
+            [binary = app.runtime_paths.open_gothic_executable,
+             cacheDir = GetUserCacheDir()](const CancellationToken &) {
+              ElfDependencyReport report;
+              wxString checkError;
+              CheckElfDependencies(binary, cacheDir, report, checkError);
+            });
+        ApplyRuntimeState();
+      });
+}
+
+void MainPanel::ApplyRuntimeState() {
+  OpenGothicStarterApp &app = RequireApp();
+  runtime_ready = true;
+  UpdateBuildLabel();
+  Layout();
+
+  button_settings->Enable(true);
+  UpdateStartButton();
+  if (games_ready) {
+    app.MarkInteractive();
+    if (launch_pending) {
+      RunPendingLaunch();
+    }
+  }
+}
+
+void MainPanel::UpdateBuildLabel() {
+  if (!runtime_ready) {
+    value_build->SetLabel(_("Loading..."));
+    return;
+  }
+
+  const OpenGothicStarterApp &app = RequireApp();
+  if (app.gothic_executable_detected) {
+    value_build->SetLabel(DescribeGothicBuild(app.gothic_version, app.gothic_executable));
+    value_build->SetToolTip(app.gothic_executable.path);
+  } else {
+    value_build->SetLabel(GothicVersionLabel(app.gothic_version));
+  }
+}
+
+void MainPanel::UpdateFxaaLabel() {
+  const int fxaa = slide_fxaa->GetValue();
+  if (fxaa == 0) {
+    value_fxaa->SetLabel(_("none"));
+  } else {
+    value_fxaa->SetLabel(wxString::Format(wxT("%d"), fxaa));
+  }
+}
+
+void MainPanel::Relabel() {
+  TraceScope trace("Relabel", "ui");
+  labels.Relabel();
+  UpdateBuildLabel();
+  UpdateFxaaLabel();
+  Layout();
+}
+
+void MainPanel::UpdateStartButton() {
+  button_start->Enable(runtime_ready &&
+                       (check_orig->GetValue() || list_ctrl->GetFirstSelected() != -1));
+}
+
 void MainPanel::InitWidgets() {
   wxBoxSizer *main_sizer = new wxBoxSizer(wxHORIZONTAL);
 
@@ -176,25 +386,43 @@ void MainPanel::InitWidgets() {
   wxBoxSizer *side_sizer = new wxBoxSizer(wxVERTICAL);
   side_sizer->SetMinSize(wxSize(200, -1));
 
-  button_start = new wxButton(this, wxID_ANY, _("Start Game"));
+  button_start = labels.Add(new wxButton(this, wxID_ANY, wxEmptyString),
+                            wxTRANSLATE("Start Game"));
   button_start->Enable(false);
-  button_settings = new wxButton(this, wxID_ANY, _("Settings"));
+  button_settings = labels.Add(new wxButton(this, wxID_ANY, wxEmptyString),
+                               wxTRANSLATE("Settings"));
+  button_settings->Enable(false);
+  button_history = labels.Add(new wxButton(this, wxID_ANY, wxEmptyString),
+                              wxTRANSLATE("Run History"));
+  button_caches = labels.Add(new wxButton(this, wxID_ANY, wxEmptyString),
+                             wxTRANSLATE("Shader Caches"));
+#if !defined(__linux__)
+  button_caches->Enable(false);
+#endif
 
   side_sizer->AddSpacer(5);
   side_sizer->Add(button_start, 0, kSizerExpandAll);
   side_sizer->AddSpacer(3);
   side_sizer->Add(button_settings, 0, kSizerExpandAll);
+  side_sizer->AddSpacer(3);
+  side_sizer->Add(button_history, 0, kSizerExpandAll);
+  side_sizer->AddSpacer(3);
+  side_sizer->Add(button_caches, 0, kSizerExpandAll);
 
-  check_orig = new wxCheckBox(this, wxID_ANY, _("Start game without mods"));
-  check_window = new wxCheckBox(this, wxID_ANY, _("Window mode"));
-  check_marvin = new wxCheckBox(this, wxID_ANY, _("Marvin mode"));
-  check_rt = new wxCheckBox(this, wxID_ANY, _("Ray tracing"));
-  check_rti = new wxCheckBox(this, wxID_ANY, _("Global illumination"));
-  check_meshlets = new wxCheckBox(this, wxID_ANY, _("Meshlets"));
-  check_vsm = new wxCheckBox(this, wxID_ANY, _("Virtual Shadowmap"));
-  check_bench = new wxCheckBox(this, wxID_ANY, _("Benchmark"));
+  auto addCheckBox = [this](const wxString &msgid) {
+    return labels.Add(new wxCheckBox(this, wxID_ANY, wxEmptyString), msgid);
+  };
+  check_orig = addCheckBox(wxTRANSLATE("Start game without mods"));
+  for (size_t i = 0; i < kLaunchToggleCount; ++i) {
+    param_checks[i] = addCheckBox(kLaunchToggles[i].label);
+  }
+  check_monitor = addCheckBox(wxTRANSLATE("Show process monitor"));
+#if !defined(__linux__)
+  check_monitor->Enable(false);
+#endif
 
-  field_fxaa = new wxStaticText(this, wxID_ANY, _("Anti-Aliasing:"));
+  field_fxaa = labels.Add(new wxStaticText(this, wxID_ANY, wxEmptyString),
+                          wxTRANSLATE("Anti-Aliasing:"));
   value_fxaa = new wxStaticText(this, wxID_ANY, wxT(""));
   slide_fxaa = new wxSlider(this, wxID_ANY, 0, 0, 2);
 
@@ -205,21 +433,29 @@ void MainPanel::InitWidgets() {
 
   side_sizer->AddSpacer(3);
   side_sizer->Add(check_orig, 0, kSizerExpandAll);
-  side_sizer->Add(check_window, 0, kSizerExpandAll);
-  side_sizer->Add(check_marvin, 0, kSizerExpandAll);
-  side_sizer->Add(check_rt, 0, kSizerExpandAll);
-  side_sizer->Add(check_rti, 0, kSizerExpandAll);
-  side_sizer->Add(check_meshlets, 0, kSizerExpandAll);
-  side_sizer->Add(check_vsm, 0, kSizerExpandAll);
-  side_sizer->Add(check_bench, 0, kSizerExpandAll);
+  for (wxCheckBox *box : param_checks) {
+    side_sizer->Add(box, 0, kSizerExpandAll);
+  }
   side_sizer->AddSpacer(3);
   side_sizer->Add(fxaa_sizer, 0, kSizerExpandAll);
   side_sizer->Add(slide_fxaa, 0, kSizerExpandAll);
+  side_sizer->AddSpacer(3);
+  side_sizer->Add(check_monitor, 0, kSizerExpandAll);
 
-  main_sizer->Add(side_sizer);
+  // Filled in by ApplyRuntimeState() once the version is known.
+  value_build = new wxStaticText(this, wxID_ANY, wxEmptyString);
+  UpdateBuildLabel();
+  side_sizer->AddStretchSpacer();
+  side_sizer->Add(value_build, 0, kSizerExpandAll);
+
+  main_sizer->Add(side_sizer, 0, wxEXPAND);
   SetSizer(main_sizer);
 
   Bind(wxEVT_SIZE, &MainPanel::OnSize, this);
+  Bind(wxEVT_PAINT, [](wxPaintEvent &event) {
+    RequireApp().MarkFirstPaint();
+    event.Skip();
+  });
   list_ctrl->Bind(wxEVT_LIST_ITEM_SELECTED, &MainPanel::OnSelected, this);
   list_ctrl->Bind(wxEVT_LIST_ITEM_DESELECTED, &MainPanel::OnSelected, this);
   list_ctrl->Bind(wxEVT_LIST_ITEM_ACTIVATED,
@@ -227,251 +463,251 @@ void MainPanel::InitWidgets() {
   button_start->Bind(wxEVT_BUTTON, [this](wxCommandEvent &) { DoStart(); });
   button_settings->Bind(wxEVT_BUTTON,
                         [this](wxCommandEvent &) { DoSettings(); });
+  button_history->Bind(wxEVT_BUTTON, [this](wxCommandEvent &) { DoHistory(); });
+  button_caches->Bind(wxEVT_BUTTON, [this](wxCommandEvent &) { DoShaderCaches(); });
   check_orig->Bind(wxEVT_CHECKBOX, [this](wxCommandEvent &) { DoOrigin(); });
 
   auto bindParamToggle = [this](wxCheckBox *box) {
     box->Bind(wxEVT_CHECKBOX, [this](wxCommandEvent &) { SaveParams(); });
   };
 
-  bindParamToggle(check_window);
-  bindParamToggle(check_marvin);
-  bindParamToggle(check_rt);
-  bindParamToggle(check_rti);
-  bindParamToggle(check_meshlets);
-  bindParamToggle(check_vsm);
-  bindParamToggle(check_bench);
+  for (wxCheckBox *box : param_checks) {
+    bindParamToggle(box);
+  }
+  bindParamToggle(check_monitor);
   slide_fxaa->Bind(wxEVT_SLIDER, &MainPanel::OnFXAAScroll, this);
 }
 
 void MainPanel::Populate() {
-  games = InitGames();
+  TraceScope trace("Populate");
+  populate_token.Cancel();
+  populate_token = CancellationToken();
+  // The previous table travels through the task so its storage is reused.
+  auto table = std::make_shared<ModTable>(std::move(games));
+  games = ModTable();
+  games_ready = false;
+  list_ctrl->DeleteAllItems();
+
+  const RuntimePaths *paths = nullptr;
+  wxString pathError;
+  if (!GetResolvedRuntimePaths(paths, pathError)) {
+    wxLogWarning(wxT("Skipping mod discovery: %s"), pathError);
+  } else {
+    RunTaskThenUi(
+        "DiscoverGames", TaskPriority::High, populate_token,
+        [runtimePaths = *paths, table](const CancellationToken &) {
+          AllocScope allocs("DiscoverMods");
+          DiscoverMods(runtimePaths, *table);
+          return std::move(*table);
+        },
+        [this](ModTable discovered) { ShowGames(std::move(discovered)); });
+  }
+
+  LoadParams();
+}
+
+void MainPanel::ShowGames(ModTable discovered) {
+  TraceScope trace("ShowGames");
+  AllocScope allocs("ShowGames");
+  games = std::move(discovered);
   list_ctrl->DeleteAllItems();
 
   if (!games.empty()) {
-    wxImageList *imageList = new wxImageList(32, 32);
+    IconCache &iconCache = RequireApp().icon_cache;
+    wxImageList *imageList = new wxImageList(kModIconSize, kModIconSize);
+    wxIcon placeholder;
+    placeholder.CopyFromBitmap(wxBitmap(kModIconSize, kModIconSize));
+    unsigned long cachedIcons = 0;
+    unsigned long decodedIcons = 0;
 
     for (size_t i = 0; i < games.size(); i++) {
-      wxIcon icon;
-      if (wxFileName::FileExists(games[i].icon)) {
-        const wxString extension = wxFileName(games[i].icon).GetExt().Lower();
-#if defined(OGS_HAVE_PE_PARSE) && !defined(_WIN32)
-        if (extension == wxT("exe")) {
-          LoadIconFromPeExecutable(games[i].icon, icon);
-        } else
-#elif !defined(_WIN32)
-        if (extension == wxT("exe")) {
-          // Unix-like wxWidgets builds cannot decode PE resources directly.
-        } else
-#endif
-        {
-          wxBitmap bmp(games[i].icon, wxBITMAP_TYPE_ANY);
-          if (bmp.IsOk()) {
-            wxImage img = bmp.ConvertToImage();
-            img = img.Scale(32, 32);
-            bmp = wxBitmap(img);
-            icon.CopyFromBitmap(bmp);
-          }
-        }
-      }
-      if (!icon.IsOk()) {
-        wxBitmap bmp(32, 32);
-        icon.CopyFromBitmap(bmp);
-      }
-
-      imageList->Add(icon);
       const long row = static_cast<long>(i);
       const int imageIndex = static_cast<int>(i);
-      list_ctrl->InsertItem(row, games[i].title, imageIndex);
+      const IconCache::Key key{games.IconPath(i), games.IconIdentity(i), kModIconSize};
+      wxIcon cached;
+      if (!key.path.empty() && iconCache.Find(key, cached)) {
+        imageList->Add(cached);
+        ++cachedIcons;
+      } else {
+        imageList->Add(placeholder);
+        if (!key.path.empty()) {
+          RunTaskThenUi(
+              "LoadModIcon", TaskPriority::High, populate_token,
+              [path = key.path](const CancellationToken &) { return DecodeModIcon(path); },
+              [this, i, key](wxImage image) { ShowIcon(i, key, image); });
+          ++decodedIcons;
+        }
+      }
+      list_ctrl->InsertItem(row, games.Title(i), imageIndex);
     }
 
     list_ctrl->AssignImageList(imageList, wxIMAGE_LIST_SMALL);
+    wxLogVerbose(wxT("Mod icons: %lu cached, %lu decoding"), cachedIcons, decodedIcons);
+    RecordTraceCounter("IconCache", "hits", static_cast<int64_t>(cachedIcons));
+    RecordTraceCounter("IconCache", "misses", static_cast<int64_t>(decodedIcons));
   }
 
-  LoadParams();
+  games_ready = true;
+  if (runtime_ready) {
+    RequireApp().MarkInteractive();
+    if (launch_pending) {
+      RunPendingLaunch();
+    }
+  }
 }
 
-void MainPanel::LoadParams() {
-  auto *config = wxConfigBase::Get();
-
-  bool windowMode;
-  config->Read(wxT("PARAMS/windowMode"), &windowMode, false);
-  check_window->SetValue(windowMode);
-
-  bool marvin;
-  config->Read(wxT("PARAMS/marvin"), &marvin, false);
-  check_marvin->SetValue(marvin);
-
-  bool rayTracing;
-  config->Read(wxT("PARAMS/rayTracing"), &rayTracing, false);
-  check_rt->SetValue(rayTracing);
+void MainPanel::ShowIcon(size_t index, const IconCache::Key &key, const wxImage &image) {
+  wxImageList *imageList = list_ctrl->GetImageList(wxIMAGE_LIST_SMALL);
+  if (!image.IsOk() || imageList == nullptr || index >= games.size()) {
+    return;
+  }
 
-  bool illumination;
-  config->Read(wxT("PARAMS/illumination"), &illumination, false);
-  check_rti->SetValue(illumination);
+  wxIcon icon;
+  icon.CopyFromBitmap(wxBitmap(image));
+  if (icon.IsOk()) {
+    RequireApp().icon_cache.Insert(key, icon);
+    imageList->Replace(static_cast<int>(index), icon);
+    list_ctrl->RefreshItem(static_cast<long>(index));
+  }
+}
 
-  bool meshlets;
-  config->Read(wxT("PARAMS/meshlets"), &meshlets, false);
-  check_meshlets->SetValue(meshlets);
+void MainPanel::LoadParams() {
+  auto *config = wxConfigBase::Get();
 
-  bool vsm;
-  config->Read(wxT("PARAMS/vsm"), &vsm, false);
-  check_vsm->SetValue(vsm);
+  for (size_t i = 0; i < kLaunchToggleCount; ++i) {
+    bool enabled = false;
+    config->Read(kLaunchToggles[i].config_key, &enabled, false);
+    param_checks[i]->SetValue(enabled);
+  }
 
-  bool bench;
-  config->Read(wxT("PARAMS/bench"), &bench, false);
-  check_bench->SetValue(bench);
+  bool monitor;
+  config->Read(wxT("MONITOR/enabled"), &monitor, false);
+  check_monitor->SetValue(monitor);
 
   int fxaa;
   config->Read(wxT("PARAMS/FXAA"), &fxaa, 0L);
   slide_fxaa->SetValue(fxaa);
-
-  if (fxaa == 0) {
-    value_fxaa->SetLabel(_("none"));
-  } else {
-    value_fxaa->SetLabel(wxString::Format(wxT("%d"), fxaa));
-  }
+  UpdateFxaaLabel();
 }
 
 void MainPanel::SaveParams() {
   auto *config = wxConfigBase::Get();
 
-  config->Write(wxT("PARAMS/windowMode"), check_window->GetValue());
-  config->Write(wxT("PARAMS/marvin"), check_marvin->GetValue());
-  config->Write(wxT("PARAMS/rayTracing"), check_rt->GetValue());
-  config->Write(wxT("PARAMS/illumination"), check_rti->GetValue());
-  config->Write(wxT("PARAMS/meshlets"), check_meshlets->GetValue());
-  config->Write(wxT("PARAMS/vsm"), check_vsm->GetValue());
-  config->Write(wxT("PARAMS/bench"), check_bench->GetValue());
+  for (size_t i = 0; i < kLaunchToggleCount; ++i) {
+    config->Write(kLaunchToggles[i].config_key, param_checks[i]->GetValue());
+  }
   config->Write(wxT("PARAMS/FXAA"), static_cast<int>(slide_fxaa->GetValue()));
+  config->Write(wxT("MONITOR/enabled"), check_monitor->GetValue());
   config->Flush();
 }
 
 void MainPanel::OnFXAAScroll(wxCommandEvent &) {
-  int fxaa_value = slide_fxaa->GetValue();
-  if (fxaa_value == 0) {
-    value_fxaa->SetLabel(_("none"));
-  } else {
-    value_fxaa->SetLabel(wxString::Format(wxT("%d"), fxaa_value));
-  }
+  UpdateFxaaLabel();
   SaveParams();
 }
 
-void MainPanel::OnSelected(wxListEvent &) {
-  button_start->Enable(list_ctrl->GetFirstSelected() != -1);
-}
+void MainPanel::OnSelected(wxListEvent &) { UpdateStartButton(); }
 void MainPanel::DoOrigin() {
   bool state = check_orig->GetValue();
   if (state) {
+    populate_token.Cancel();
     list_ctrl->DeleteAllItems();
   } else {
     Populate();
   }
-  button_start->Enable(state);
+  UpdateStartButton();
 }
 
-int MainPanel::GetSelectedGameIndex() const {
-  const long selected = list_ctrl->GetFirstSelected();
-  if (selected < 0 || selected >= static_cast<long>(games.size())) {
-    return -1;
+void MainPanel::LaunchWhenReady(const wxString &file) {
+  pending_launch = file;
+  launch_pending = true;
+  if (games_ready && runtime_ready) {
+    RunPendingLaunch();
   }
-  return static_cast<int>(selected);
 }
 
-bool MainPanel::BuildLaunchCommand(const RuntimePaths &paths, int gameidx,
-                                   wxArrayString &command,
-                                   wxString &error) const {
-  command.clear();
-  error.clear();
-
-  command.Add(paths.open_gothic_executable);
-  command.Add(wxT("-g"));
-  command.Add(paths.gothic_root);
-
-  OpenGothicStarterApp *app = RequireInvariant(
-      dynamic_cast<OpenGothicStarterApp *>(wxTheApp),
-      wxT("wxTheApp must be an OpenGothicStarterApp instance."));
-  switch (app->gothic_version) {
-  case GothicVersion::Gothic1:
-    command.Add(wxT("-g1"));
-    break;
-  case GothicVersion::Gothic2Classic:
-    command.Add(wxT("-g2c"));
-    break;
-  case GothicVersion::Gothic2Notr:
-    command.Add(wxT("-g2"));
-    break;
-  case GothicVersion::Unknown:
-  default:
-    error = _("Stored Gothic version is invalid. Please restart and select a valid version.");
-    return false;
+void MainPanel::RunPendingLaunch() {
+  launch_pending = false;
+  if (!LaunchGame(pending_launch)) {
+    wxLogWarning(wxT("Mod requested by --launch was not found: %s"), pending_launch);
   }
-
-  if (gameidx >= 0) {
-    const size_t selectedIndex = static_cast<size_t>(gameidx);
-    if (selectedIndex < games.size()) {
-      command.Add(wxT("-game:") + games[selectedIndex].file);
-    }
+  // The run is recorded when the game exits, so wait for that hidden.
+  if (running_games > 0) {
+    close_after_games = true;
+    GetParent()->Hide();
+    return;
   }
+  GetParent()->Close();
+}
 
-  if (check_window->GetValue()) {
-    command.Add(wxT("-window"));
+void MainPanel::StayOpen() { close_after_games = false; }
+
+bool MainPanel::LaunchGame(const wxString &file) {
+  // An empty file name starts the base game without a mod.
+  long row = -1;
+  if (!file.empty()) {
+    const size_t found = games.Find(file);
+    if (found != ModTable::npos) {
+      row = static_cast<long>(found);
+    }
   }
-  if (check_marvin->GetValue()) {
-    command.Add(wxT("-devmode"));
+  if (!file.empty() && row < 0) {
+    return false;
   }
 
-  command.Add(wxT("-rt"));
-  command.Add(check_rt->GetValue() ? wxT("1") : wxT("0"));
-  command.Add(wxT("-gi"));
-  command.Add(check_rti->GetValue() ? wxT("1") : wxT("0"));
-  command.Add(wxT("-ms"));
-  command.Add(check_meshlets->GetValue() ? wxT("1") : wxT("0"));
-  command.Add(wxT("-vsm"));
-  command.Add(check_vsm->GetValue() ? wxT("1") : wxT("0"));
-  if (check_bench->GetValue()) {
-    command.Add(wxT("-benchmark"));
+  for (long selected = list_ctrl->GetFirstSelected(); selected >= 0;
+       selected = list_ctrl->GetNextSelected(selected)) {
+    list_ctrl->Select(selected, false);
   }
-
-  int fxaa = slide_fxaa->GetValue();
-  if (fxaa > 0) {
-    command.Add(wxT("-aa"));
-    command.Add(wxString::Format(wxT("%d"), fxaa));
+  if (row >= 0) {
+    list_ctrl->Select(row);
   }
-
+  DoStart();
   return true;
 }
 
-wxString MainPanel::ResolveWorkingDirectory(const RuntimePaths &paths,
-                                            int gameidx) const {
-  if (gameidx >= 0) {
-    const size_t selectedIndex = static_cast<size_t>(gameidx);
-    if (selectedIndex < games.size()) {
-      return games[selectedIndex].datadir;
-    }
+int MainPanel::GetSelectedGameIndex() const {
+  const long selected = list_ctrl->GetFirstSelected();
+  if (selected < 0 || selected >= static_cast<long>(games.size())) {
+    return -1;
   }
-  return GetDefaultWorkingDirectory(paths);
+  return static_cast<int>(selected);
 }
 
-bool MainPanel::EnsureWorkingDirectoryExists(const wxString &path,
-                                             wxString &error) const {
-  error.clear();
-  if (wxDir::Exists(path)) {
-    return true;
+std::optional<GameEntry> MainPanel::GetGame(int gameidx) const {
+  if (gameidx < 0 || static_cast<size_t>(gameidx) >= games.size()) {
+    return std::nullopt;
   }
+  return games.Entry(static_cast<size_t>(gameidx));
+}
 
-  if (!wxFileName::Mkdir(path, wxS_DIR_DEFAULT, wxPATH_MKDIR_FULL)) {
-    error = wxString::Format(wxT("Failed to create working directory: %s"), path);
-    return false;
-  }
+LaunchOptions MainPanel::CollectLaunchOptions(int gameidx) const {
+  OpenGothicStarterApp *app = RequireInvariant(
+      dynamic_cast<OpenGothicStarterApp *>(wxTheApp),
+      wxT("wxTheApp must be an OpenGothicStarterApp instance."));
 
-  return true;
+  LaunchOptions options;
+  options.version = app->gothic_version;
+  if (const std::optional<GameEntry> game = GetGame(gameidx)) {
+    options.mod_file = game->file;
+  }
+  for (size_t i = 0; i < kLaunchToggleCount; ++i) {
+    options.*kLaunchToggles[i].member = param_checks[i]->GetValue();
+  }
+  options.fxaa = slide_fxaa->GetValue();
+  return options;
 }
 
 void MainPanel::DoStart() {
+  if (!runtime_ready) {
+    return;
+  }
+  TraceScope trace("DoStart", "launch");
+  AllocScope allocs("DoStart");
   const RuntimePaths *paths = nullptr;
   wxString pathError;
   if (!GetResolvedRuntimePaths(paths, pathError)) {
-    wxMessageBox(pathError, _("Configuration Error"), wxOK | wxICON_ERROR);
+    ShowMessage(pathError, _("Configuration Error"), wxOK | wxICON_ERROR);
     return;
   }
   if (!ValidateRuntimePaths(*paths, pathError)) {
@@ -481,183 +717,294 @@ void MainPanel::DoStart() {
             .GetFullPath();
     const wxString expectedOpenGothic =
         wxFileName(paths->system_dir, ExpectedOpenGothicBinaryName()).GetFullPath();
-    wxMessageBox(wxString::Format(
-                     _("Cannot start game because the Gothic runtime layout is invalid.\n\n"
-                       "Expected files in the same directory:\n"
-                       "- %s\n"
-                       "- %s\n\n"
-                       "Fix the installation layout and try again."),
-                     expectedLauncher, expectedOpenGothic),
-                 _("Configuration Error"), wxOK | wxICON_ERROR);
+    ShowMessage(wxString::Format(
+                    _("Cannot start game because the Gothic runtime layout is invalid.\n\n"
+                      "Expected files in the same directory:\n"
+                      "- %s\n"
+                      "- %s\n\n"
+                      "Fix the installation layout and try again."),
+                    expectedLauncher, expectedOpenGothic),
+                _("Configuration Error"), wxOK | wxICON_ERROR);
+    return;
+  }
+
+  if (!ConfirmEngineDependencies(this, *paths)) {
     return;
   }
 
   const int gameidx = GetSelectedGameIndex();
   wxArrayString command;
   wxString commandError;
-  if (!BuildLaunchCommand(*paths, gameidx, command, commandError)) {
-    wxMessageBox(commandError, _("Configuration Error"), wxOK | wxICON_ERROR);
+  if (!BuildLaunchCommand(*paths, CollectLaunchOptions(gameidx), command,
+                          commandError)) {
+    ShowMessage(commandError, _("Configuration Error"), wxOK | wxICON_ERROR);
     return;
   }
 
-  wxExecuteEnv env;
-  env.cwd = ResolveWorkingDirectory(*paths, gameidx);
+  const std::optional<GameEntry> selectedGame = GetGame(gameidx);
+  const GameEntry *game = selectedGame ? &*selectedGame : nullptr;
+  const wxString cwd = ResolveWorkingDirectory(*paths, game);
   wxString directoryError;
-  if (!EnsureWorkingDirectoryExists(env.cwd, directoryError)) {
-    wxMessageBox(directoryError, _("Configuration Error"), wxOK | wxICON_ERROR);
+  if (!EnsureWorkingDirectoryExists(cwd, directoryError)) {
+    ShowMessage(directoryError, _("Configuration Error"), wxOK | wxICON_ERROR);
     return;
   }
 
-  wxString renderedCommand;
-  for (size_t i = 0; i < command.GetCount(); ++i) {
-    if (i > 0) {
-      renderedCommand += wxT(" ");
-    }
+  SpawnOptions spawnOptions;
+  wxString profileError;
+  if (!ReadLaunchProfile(*wxConfigBase::Get(), game != nullptr ? game->file : wxString(),
+                         spawnOptions.profile, profileError)) {
+    ShowMessage(profileError, _("Configuration Error"), wxOK | wxICON_ERROR);
+    return;
+  }
 
-    wxString escaped;
-    const wxString &arg = command[i];
-    escaped.reserve(arg.length() + 2);
-    for (wxUniChar ch : arg) {
-      if (ch == wxT('\\') || ch == wxT('"')) {
-        escaped += wxT('\\');
+  wxString shaderCacheDir;
+  PrepareShaderCacheEnvironment(*paths, game, command, spawnOptions, shaderCacheDir);
+
+  wxLogMessage(wxT("Starting game command: %s"), RenderCommandForLog(command));
+  wxLogMessage(wxT("Working directory: %s"), cwd);
+
+  // Runs on the reaper thread once the game exits and only hands the result
+  // to the UI thread; captures are copies.
+  const wxString historyMod = game != nullptr ? game->file : wxString();
+  const wxString historyFlags = DescribeLaunchFlags(command);
+  const int64_t startedUnix = static_cast<int64_t>(std::time(nullptr));
+  auto recordRun = [this, token = lifetime_token, historyMod, historyFlags,
+                    startedUnix](const ProcessExit &exit) {
+    RunRecord record = MakeRunRecord(exit, startedUnix, historyMod, historyFlags);
+    PostGameExit([this, token, exit, record = std::move(record)] {
+      if (!token.IsCancelled()) {
+        OnGameExited(exit, record);
       }
-      escaped += ch;
-    }
+    });
+  };
 
-    renderedCommand += wxString::Format(wxT("\"%s\""), escaped);
+  // Readahead runs alongside the spawn; the plan is inert when disabled.
+  bool prefetch = false;
+  wxConfigBase::Get()->Read(wxT("PREFETCH/enabled"), &prefetch, false);
+  PrefetchPlan prefetchPlan;
+  if (prefetch) {
+    prefetchPlan = BeginPrefetch(GetPrefetchProfileDir(), historyMod, ReadPrefetchSettings(),
+                                 lifetime_token);
   }
-  wxLogMessage(wxT("Starting game command: %s"), renderedCommand);
-  wxLogMessage(wxT("Working directory: %s"), env.cwd);
 
-  std::vector<std::string> argvStorage;
-  argvStorage.reserve(command.GetCount());
-  for (const wxString &arg : command) {
-    const std::string utf8 = arg.ToStdString(wxConvUTF8);
-    if (!arg.empty() && utf8.empty()) {
-      wxLogError(wxT("Failed to encode command argument for process launch."));
-      wxMessageBox(_("Failed to start OpenGothic process."), _("Launch Failed"),
-                   wxOK | wxICON_ERROR);
-      return;
-    }
-    argvStorage.push_back(utf8);
+  // Launcher background work yields to the game until recordRun ends this.
+  GetTaskScheduler().BeginThrottle();
+  SpawnResult spawned;
+  wxString spawnError;
+  bool started = false;
+  {
+    TraceScope spawnTrace("Spawn", "launch");
+    started = SpawnProcess(command, cwd, spawnOptions, spawned, spawnError, recordRun);
+  }
+  if (!started) {
+    ThrottleReport throttle;
+    GetTaskScheduler().EndThrottle(throttle);
+    wxLogError(wxT("%s"), spawnError);
+    ShowMessage(_("Failed to start OpenGothic process."), _("Launch Failed"),
+                wxOK | wxICON_ERROR);
+    return;
+  }
+  ++running_games;
+  wxLogMessage(wxT("Started OpenGothic (pid %ld) in %.2f ms"), spawned.pid,
+               static_cast<double>(spawned.spawn_us) / 1000.0);
+  if (prefetch) {
+    TrackPrefetchLaunch(std::move(prefetchPlan), spawned.pid, lifetime_token);
+  }
+  for (const wxString &warning : spawned.profile_warnings) {
+    wxLogWarning(wxT("Launch profile: %s"), warning);
+  }
+  if (!spawned.applied_limits.empty()) {
+    wxLogMessage(wxT("Launch profile applied: %s"), spawned.applied_limits);
   }
 
-  std::vector<const char *> argv;
-  argv.reserve(argvStorage.size() + 1);
-  for (const std::string &arg : argvStorage) {
-    argv.push_back(arg.c_str());
+  if (!shaderCacheDir.empty()) {
+    long budgetMb = 4096;
+    wxConfigBase::Get()->Read(wxT("SHADER_CACHE/budgetMB"), &budgetMb, 4096L);
+    const int64_t budgetBytes = static_cast<int64_t>(std::max(budgetMb, 0L)) * 1024 * 1024;
+    // Sizing every cache walks their whole trees, so keep it off the UI thread.
+    // As low-priority work it waits until the game has exited.
+    auto enforceBudget = [shaderCacheDir, budgetBytes](const CancellationToken &) {
+      wxArrayString evicted;
+      wxString cacheError;
+      if (!EnforceShaderCacheBudget(GetShaderCacheRoot(), budgetBytes, shaderCacheDir,
+                                    evicted, cacheError)) {
+        wxLogWarning(wxT("%s"), cacheError);
+      }
+      for (const wxString &path : evicted) {
+        wxLogMessage(wxT("Evicted shader cache: %s"), path);
+      }
+    };
+    GetTaskScheduler().Submit("ShaderCacheBudget", TaskPriority::Low, CancellationToken(),
+                              enforceBudget);
   }
-  argv.push_back(nullptr);
 
-  const long pid = wxExecute(argv.data(), wxEXEC_ASYNC, nullptr, &env);
-  if (pid == 0) {
-    wxMessageBox(_("Failed to start OpenGothic process."), _("Launch Failed"),
-                 wxOK | wxICON_ERROR);
-    return;
+  if (check_monitor->GetValue()) {
+    StartMonitor(spawned.pid, game != nullptr ? game->title : _("No mod"));
   }
 }
 
-void MainPanel::DoSettings() {
-  const RuntimePaths *paths = nullptr;
-  wxString pathError;
-  if (!GetResolvedRuntimePaths(paths, pathError)) {
-    wxMessageBox(pathError, _("Configuration Error"), wxOK | wxICON_ERROR);
+void MainPanel::OnGameExited(const ProcessExit &exit, const RunRecord &record) {
+  wxLogMessage(wxT("OpenGothic (pid %ld) exited with code %d after %lld s"), exit.pid,
+               exit.exit_code, static_cast<long long>(exit.wall_us / 1000000));
+  ThrottleReport throttle;
+  if (GetTaskScheduler().EndThrottle(throttle)) {
+    wxLogMessage(wxT("Background work resumed after %lld s: %lu tasks deferred, %lu run "
+                     "at idle priority"),
+                 static_cast<long long>(throttle.throttled_us / 1000000),
+                 static_cast<unsigned long>(throttle.deferred_tasks),
+                 static_cast<unsigned long>(throttle.demoted_tasks));
+  }
+
+  RunTaskThenUi(
+      "RecordRun", TaskPriority::High, lifetime_token,
+      [record, historyDir = GetRunHistoryDir()](const CancellationToken &) {
+        wxString historyError;
+        AppendRunRecord(historyDir, record, historyError);
+        return historyError;
+      },
+      [this](wxString historyError) {
+        if (!historyError.empty()) {
+          wxLogWarning(wxT("%s"), historyError);
+        }
+        --running_games;
+        if (running_games == 0 && close_after_games) {
+          GetParent()->Close();
+        }
+      });
+}
+
+void MainPanel::PrepareShaderCacheEnvironment(const RuntimePaths &paths,
+                                              const GameEntry *game,
+                                              const wxArrayString &command,
+                                              SpawnOptions &options, wxString &cacheDir) {
+  cacheDir.clear();
+#if defined(__linux__)
+  bool enabled = true;
+  wxConfigBase::Get()->Read(wxT("SHADER_CACHE/enabled"), &enabled, true);
+  if (!enabled) {
     return;
   }
 
-  OpenGothicStarterApp *app = RequireInvariant(
-      dynamic_cast<OpenGothicStarterApp *>(wxTheApp),
-      wxT("wxTheApp must be an OpenGothicStarterApp instance."));
+  wxString cacheError;
+  if (!PrepareShaderCache(GetShaderCacheRoot(), game != nullptr ? game->file : wxString(),
+                          DescribeEngineBuild(paths.open_gothic_executable),
+                          DescribeRendererFlags(command), cacheDir, cacheError)) {
+    wxLogWarning(wxT("%s"), cacheError);
+    cacheDir.clear();
+    return;
+  }
+  for (auto &variable : GetShaderCacheEnvironment(cacheDir)) {
+    options.environment.push_back(std::move(variable));
+  }
+  wxLogMessage(wxT("Shader cache: %s"), cacheDir);
+#else
+  (void)paths;
+  (void)game;
+  (void)command;
+  (void)options;
+#endif
+}
+
+void MainPanel::StartMonitor(long pid, const wxString &gameTitle) {
+  long intervalMs = 1000;
+  wxConfigBase::Get()->Read(wxT("MONITOR/intervalMs"), &intervalMs, 1000L);
+  intervalMs = std::max(intervalMs, static_cast<long>(ProcessMonitor::kMinInterval.count()));
 
-  wxString currentLanguage;
-  if (!TryReadStoredLanguageOverride(*paths, currentLanguage)) {
-    currentLanguage.clear();
+  auto monitor = std::make_unique<ProcessMonitor>();
+  wxString monitorError;
+  if (!monitor->Start(pid, std::chrono::milliseconds(intervalMs), monitorError)) {
+    wxLogWarning(wxT("%s"), monitorError);
+    return;
   }
+  auto *frame = new ProcessMonitorFrame(this, gameTitle, std::move(monitor),
+                                        static_cast<int>(intervalMs));
+  frame->Show();
+}
 
-  SystemPackSettings systemPackSettings;
-  {
-    const wxString systemPackPath = GetSystemPackConfigPath(*paths);
-    if (wxFileName::FileExists(systemPackPath)) {
-      wxFileConfig cfg(wxEmptyString, wxEmptyString, systemPackPath, wxEmptyString,
-                       wxCONFIG_USE_LOCAL_FILE);
-      long value = 0;
-      if (cfg.Read(wxT("DEBUG/Show_FPS_Counter"), &value)) {
-        systemPackSettings.show_fps_counter = value != 0;
-      }
-      if (cfg.Read(wxT("PARAMETERS/HideFocus"), &value)) {
-        systemPackSettings.hide_focus = value != 0;
-      }
+void MainPanel::DoHistory() {
+  constexpr size_t kRecentRunCount = 10;
+  const std::optional<GameEntry> selectedGame = GetGame(GetSelectedGameIndex());
+  const GameEntry *game = selectedGame ? &*selectedGame : nullptr;
+  const wxString mod = game != nullptr ? game->file : wxString();
 
-      double doubleValue = 0.0;
-      if (cfg.Read(wxT("PARAMETERS/VerticalFOV"), &doubleValue)) {
-        systemPackSettings.vertical_fov = doubleValue;
-        if (systemPackSettings.vertical_fov < 1.0) {
-          systemPackSettings.vertical_fov = 67.5;
-        }
-      }
-      if (cfg.Read(wxT("INTERFACE/Scale"), &doubleValue)) {
-        systemPackSettings.interface_scale = doubleValue;
-        if (systemPackSettings.interface_scale <= 0.0) {
-          systemPackSettings.interface_scale = 1.0;
-        }
-      }
+  std::vector<RunRecord> runs;
+  wxString historyError;
+  if (!ReadRecentRuns(GetRunHistoryDir(), mod, kRecentRunCount, runs, historyError)) {
+    wxLogWarning(wxT("%s"), historyError);
+  }
 
-      if (cfg.Read(wxT("PARAMETERS/FPS_Limit"), &value)) {
-        systemPackSettings.fps_limit = static_cast<int>(value);
-        if (systemPackSettings.fps_limit < 0) {
-          systemPackSettings.fps_limit = 0;
-        }
-      }
+  RunHistoryDialog dialog(this, game != nullptr ? game->title : _("No mod"), runs);
+  dialog.ShowModal();
+}
 
-      if (cfg.Read(wxT("INTERFACE/InventoryCellSize"), &value)) {
-        systemPackSettings.inventory_cell_size = static_cast<int>(value);
-        if (systemPackSettings.inventory_cell_size < 10) {
-          systemPackSettings.inventory_cell_size = 10;
-        }
-      }
+void MainPanel::DoShaderCaches() {
+  const RuntimePaths *paths = nullptr;
+  wxString pathError;
+  if (!GetResolvedRuntimePaths(paths, pathError)) {
+    ShowMessage(pathError, _("Configuration Error"), wxOK | wxICON_ERROR);
+    return;
+  }
 
-      if (cfg.Read(wxT("INTERFACE/NewChapterSizeX"), &value)) {
-        systemPackSettings.new_chapter_size_x =
-            static_cast<int>(std::max(1L, value));
-      }
-      if (cfg.Read(wxT("INTERFACE/NewChapterSizeY"), &value)) {
-        systemPackSettings.new_chapter_size_y =
-            static_cast<int>(std::max(1L, value));
-      }
+  ShaderCacheDialog dialog(this, GetShaderCacheRoot(),
+                           DescribeEngineBuild(paths->open_gothic_executable));
+  dialog.ShowModal();
+}
 
-      if (cfg.Read(wxT("INTERFACE/SaveGameImageSizeX"), &value)) {
-        systemPackSettings.save_game_image_size_x =
-            static_cast<int>(std::max(0L, value));
-      }
-      if (cfg.Read(wxT("INTERFACE/SaveGameImageSizeY"), &value)) {
-        systemPackSettings.save_game_image_size_y =
-            static_cast<int>(std::max(0L, value));
-      }
+void MainPanel::DoSettings() {
+  AllocScope allocs("SettingsDialog");
+  const RuntimePaths *paths = nullptr;
+  wxString pathError;
+  if (!GetResolvedRuntimePaths(paths, pathError)) {
+    ShowMessage(pathError, _("Configuration Error"), wxOK | wxICON_ERROR);
+    return;
+  }
 
-      if (cfg.Read(wxT("INTERFACE/HideHealthBar"), &value)) {
-        systemPackSettings.show_health_bar = value == 0;
-      }
-      if (cfg.Read(wxT("INTERFACE/ShowManaBar"), &value)) {
-        systemPackSettings.show_mana_bar =
-            std::clamp(static_cast<int>(value), 0, 2);
-      }
-      if (cfg.Read(wxT("INTERFACE/ShowSwimBar"), &value)) {
-        systemPackSettings.show_swim_bar =
-            std::clamp(static_cast<int>(value), 0, 2);
-      }
+  OpenGothicStarterApp *app = RequireInvariant(
+      dynamic_cast<OpenGothicStarterApp *>(wxTheApp),
+      wxT("wxTheApp must be an OpenGothicStarterApp instance."));
+
+  // The dialog keeps its controls between uses and is only refreshed when
+  // the files behind it changed or the last edit was discarded.
+  const wxString installStamp = FileStamp(GetInstallConfigPath(*paths));
+  if (settings_dialog == nullptr || installStamp != settings_install_stamp) {
+    if (!TryReadStoredLanguageOverride(*paths, settings_language)) {
+      settings_language.clear();
     }
+    settings_install_stamp = installStamp;
+    settings_values_current = false;
+  }
+  const wxString systemPackStamp = FileStamp(GetSystemPackConfigPath(*paths));
+  if (settings_dialog == nullptr || systemPackStamp != settings_system_pack_stamp) {
+    settings_system_pack = ReadSystemPackSettings(GetSystemPackConfigPath(*paths));
+    settings_system_pack_stamp = systemPackStamp;
+    settings_values_current = false;
+  }
+  if (settings_version != app->gothic_version) {
+    settings_version = app->gothic_version;
+    settings_values_current = false;
   }
 
-  SettingsDialog dialog(this, app->gothic_version, currentLanguage,
-                        systemPackSettings);
-  if (dialog.ShowModal() != wxID_SAVE) {
+  if (settings_dialog == nullptr) {
+    settings_dialog = new SettingsDialog(this);
+  }
+  SettingsDialog &dialog = *settings_dialog;
+  if (!settings_values_current) {
+    dialog.SetValues(settings_version, settings_language, settings_system_pack);
+    settings_values_current = true;
+  }
+  allocs.Finish();
+  const int result = dialog.ShowModal();
+  // Until everything below is saved the controls no longer match the files.
+  settings_values_current = false;
+  if (result != wxID_SAVE) {
     return;
   }
 
   const GothicVersion selectedVersion = dialog.GetSelectedVersion();
   if (selectedVersion == GothicVersion::Unknown) {
-    wxMessageBox(_("Selected Gothic version is invalid."), _("Configuration Error"),
-                 wxOK | wxICON_ERROR);
+    ShowMessage(_("Selected Gothic version is invalid."), _("Configuration Error"),
+                wxOK | wxICON_ERROR);
     return;
   }
 
@@ -665,7 +1012,7 @@ void MainPanel::DoSettings() {
   const SystemPackSettings selectedSystemPack = dialog.GetSystemPackSettings();
 
   if (!WriteStoredGothicVersion(*paths, selectedVersion)) {
-    wxMessageBox(
+    ShowMessage(
         wxString::Format(_("Failed to save Gothic version to:\n%s"),
                          GetInstallConfigPath(*paths)),
         _("Configuration Error"), wxOK | wxICON_ERROR);
@@ -686,165 +1033,40 @@ void MainPanel::DoSettings() {
   }
 
   if (!cfg.Flush()) {
-    wxMessageBox(
+    ShowMessage(
         wxString::Format(_("Failed to save language setting to:\n%s"),
                          configPath),
         _("Configuration Error"), wxOK | wxICON_ERROR);
     return;
   }
 
-  {
-    const wxString systemPackPath = GetSystemPackConfigPath(*paths);
-    wxFileConfig systemPackCfg(wxEmptyString, wxEmptyString, systemPackPath,
-                               wxEmptyString, wxCONFIG_USE_LOCAL_FILE);
-    systemPackCfg.Write(wxT("DEBUG/Show_FPS_Counter"),
-                        selectedSystemPack.show_fps_counter ? 1L : 0L);
-    systemPackCfg.Write(wxT("PARAMETERS/HideFocus"),
-                        selectedSystemPack.hide_focus ? 1L : 0L);
-    systemPackCfg.Write(wxT("PARAMETERS/VerticalFOV"),
-                        selectedSystemPack.vertical_fov);
-    systemPackCfg.Write(
-        wxT("PARAMETERS/FPS_Limit"),
-        static_cast<long>(std::max(0, selectedSystemPack.fps_limit)));
-    systemPackCfg.Write(wxT("INTERFACE/Scale"),
-                        std::max(0.1, selectedSystemPack.interface_scale));
-    systemPackCfg.Write(
-        wxT("INTERFACE/InventoryCellSize"),
-        static_cast<long>(std::max(10, selectedSystemPack.inventory_cell_size)));
-    systemPackCfg.Write(
-        wxT("INTERFACE/NewChapterSizeX"),
-        static_cast<long>(std::max(1, selectedSystemPack.new_chapter_size_x)));
-    systemPackCfg.Write(
-        wxT("INTERFACE/NewChapterSizeY"),
-        static_cast<long>(std::max(1, selectedSystemPack.new_chapter_size_y)));
-    systemPackCfg.Write(
-        wxT("INTERFACE/SaveGameImageSizeX"),
-        static_cast<long>(std::max(0, selectedSystemPack.save_game_image_size_x)));
-    systemPackCfg.Write(
-        wxT("INTERFACE/SaveGameImageSizeY"),
-        static_cast<long>(std::max(0, selectedSystemPack.save_game_image_size_y)));
-    systemPackCfg.Write(wxT("INTERFACE/HideHealthBar"),
-                        selectedSystemPack.show_health_bar ? 0L : 1L);
-    systemPackCfg.Write(wxT("INTERFACE/ShowManaBar"),
-                        static_cast<long>(std::clamp(selectedSystemPack.show_mana_bar, 0, 2)));
-    systemPackCfg.Write(wxT("INTERFACE/ShowSwimBar"),
-                        static_cast<long>(std::clamp(selectedSystemPack.show_swim_bar, 0, 2)));
-    if (!systemPackCfg.Flush()) {
-      wxMessageBox(
-          wxString::Format(_("Failed to save SystemPack settings to:\n%s"),
-                           systemPackPath),
-          _("Configuration Error"), wxOK | wxICON_ERROR);
-      return;
-    }
+  const wxString systemPackPath = GetSystemPackConfigPath(*paths);
+  if (!WriteSystemPackSettings(systemPackPath, selectedSystemPack)) {
+    ShowMessage(
+        wxString::Format(_("Failed to save SystemPack settings to:\n%s"),
+                         systemPackPath),
+        _("Configuration Error"), wxOK | wxICON_ERROR);
+    return;
   }
 
   app->gothic_version = selectedVersion;
 
-  wxString normalizedCurrentLanguage = currentLanguage;
-  normalizedCurrentLanguage.Trim(true);
-  normalizedCurrentLanguage.Trim(false);
+  const wxString previousLanguage = settings_language;
+  settings_version = selectedVersion;
+  settings_language = normalizedLanguage;
+  settings_system_pack = selectedSystemPack;
+  settings_install_stamp = FileStamp(configPath);
+  settings_system_pack_stamp = FileStamp(systemPackPath);
+  settings_values_current = true;
 
-  if (normalizedLanguage.CmpNoCase(normalizedCurrentLanguage) != 0) {
+  if (normalizedLanguage.CmpNoCase(previousLanguage) != 0) {
+    // Only the catalog changes; the discovered mods and their icons stay.
     InitializeLocalization(app->app_locale, normalizedLanguage);
-
-    wxWindow *topWindow = wxTheApp->GetTopWindow();
-    const bool hasWindowGeometry = topWindow != nullptr;
-    wxPoint framePosition = wxDefaultPosition;
-    wxSize frameSize = wxDefaultSize;
-    if (hasWindowGeometry) {
-      framePosition = topWindow->GetPosition();
-      frameSize = topWindow->GetSize();
-    }
-
-    CallAfter([hasWindowGeometry, framePosition, frameSize]() {
-      wxWindow *currentTopWindow = wxTheApp->GetTopWindow();
-      auto *newFrame = new MainFrame();
-      if (hasWindowGeometry) {
-        newFrame->SetPosition(framePosition);
-        newFrame->SetSize(frameSize);
-      }
-
-      wxTheApp->SetTopWindow(newFrame);
-
-      if (currentTopWindow != nullptr && currentTopWindow != newFrame) {
-        currentTopWindow->Destroy();
-      }
-    });
-  }
-}
-
-std::vector<GameEntry> MainPanel::InitGames() {
-  std::vector<GameEntry> gamesList;
-
-  const RuntimePaths *paths = nullptr;
-  wxString pathError;
-  if (!GetResolvedRuntimePaths(paths, pathError)) {
-    wxLogWarning(wxT("Skipping mod discovery: %s"), pathError);
-    return gamesList;
-  }
-  if (!wxDir::Exists(paths->gothic_root) || !wxDir::Exists(paths->system_dir)) {
-    wxLogWarning(wxT("Skipping mod discovery due to invalid runtime directories."));
-    return gamesList;
-  }
-
-  wxString systemDir = paths->system_dir;
-  wxDir dir(systemDir);
-  wxString iniName;
-  bool hasFile = dir.GetFirst(&iniName, wxEmptyString, wxDIR_FILES);
-
-  while (hasFile) {
-    if (wxFileName(iniName).GetExt().Lower() != wxT("ini")) {
-      hasFile = dir.GetNext(&iniName);
-      continue;
-    }
-
-    wxString iniPath = wxFileName(systemDir, iniName).GetFullPath();
-
-    wxFileConfig cfg(wxEmptyString, wxEmptyString, iniPath, wxEmptyString,
-                     wxCONFIG_USE_LOCAL_FILE);
-
-    if (!cfg.HasGroup("/INFO") || !cfg.HasGroup("/FILES")) {
-      hasFile = dir.GetNext(&iniName);
-      continue;
-    }
-
-    cfg.SetPath("/INFO");
-    wxString title, authors, webpage, iconKey;
-    bool okTitle = cfg.Read("Title", &title);
-    bool okIcon = cfg.Read("Icon", &iconKey);
-    cfg.Read("Authors", &authors);
-    cfg.Read("Webpage", &webpage);
-
-    if (okTitle) {
-      GameEntry entry;
-      entry.file = iniName;
-      entry.title = title;
-      entry.authors = authors;
-      entry.webpage = webpage;
-
-      if (okIcon && !iconKey.IsEmpty()) {
-        entry.icon = wxFileName(systemDir, iconKey).GetFullPath();
-      } else {
-        entry.icon.Clear();
-      }
-
-      wxString modName = wxFileName(iniName).GetName();
-      entry.datadir = GetModWorkingDirectory(*paths, modName);
-
-      if (!wxDir::Exists(entry.datadir) &&
-          !wxFileName::Mkdir(entry.datadir, wxS_DIR_DEFAULT, wxPATH_MKDIR_FULL)) {
-        wxLogError(wxT("Failed to create mod data directory: %s"), entry.datadir);
-        hasFile = dir.GetNext(&iniName);
-        continue;
-      }
-
-      gamesList.push_back(std::move(entry));
-    }
-
-    hasFile = dir.GetNext(&iniName);
+    Relabel();
+    // Rebuilt with the new translations the next time it is opened.
+    settings_dialog->Destroy();
+    settings_dialog = nullptr;
   }
-
-  return gamesList;
 }
 
 void MainPanel::OnSize(wxSizeEvent &event) {
@@ -857,54 +1079,78 @@ void MainPanel::OnSize(wxSizeEvent &event) {
 MainFrame::MainFrame()
     : wxFrame(nullptr, wxID_ANY, APP_NAME, wxDefaultPosition,
               wxSize(550, 400)) {
+  TraceScope trace("MainFrame");
   panel = new MainPanel(this);
   Show();
 }
 
+OpenGothicStarterApp::~OpenGothicStarterApp() {
+  // OnExit() is skipped when OnInit() fails; make sure the trace still lands.
+  StopTracing();
+}
+
 bool OpenGothicStarterApp::OnInit() {
+  wxString tracePath;
+  wxString traceError;
+  if (FindCommandLineOption(argv.GetArguments(), wxT("--trace="), tracePath)) {
+    StartTracing(tracePath, traceError);
+  }
+  gNonInteractive = argv.GetArguments().Index(wxT("--non-interactive")) != wxNOT_FOUND;
+  startup_begin_us = TraceNowMicros();
+  TraceScope trace("OnInit");
+  AllocScope allocs("OnInit");
+
+  // Before any config, locale or discovery work, so a hand-off exits at once.
+  wxString instanceWarning;
+  if (!ClaimSingleInstance(instanceWarning)) {
+    forwarded_to_running_instance = true;
+    return true;
+  }
+  // Overlaps catalog extraction with config and path resolution.
+  PrefetchBundledLocales();
+
   if (!InitConfig()) {
     return false;
   }
 
   wxInitAllImageHandlers();
-  wxLog::SetActiveTarget(new wxLogStderr());
-  InitializeLocalization(app_locale);
+  long iconCacheMb = static_cast<long>(IconCache::kDefaultBudget / (1024 * 1024));
+  wxConfigBase::Get()->Read(wxT("ICONS/cacheBudgetMB"), &iconCacheMb, iconCacheMb);
+  icon_cache.SetBudget(static_cast<size_t>(std::max(iconCacheMb, 0L)) * 1024 * 1024);
+  InitLogging();
+  if (!traceError.empty()) {
+    wxLogWarning(wxT("Tracing disabled: %s"), traceError);
+  }
+  if (!instanceWarning.empty()) {
+    wxLogWarning(wxT("Single-instance mode disabled: %s"), instanceWarning);
+  }
 
   wxString resolveError;
   RuntimePaths detectedPaths;
   if (!ResolveRuntimePaths(detectedPaths, resolveError)) {
+    InitializeLocalization(app_locale);
     wxLogWarning(wxT("Runtime path resolution failed: %s"), resolveError);
-    wxMessageBox(wxString::Format(
-                     _("OpenGothicStarter must be started from '<Gothic>/system'.\n\n"
-                       "Current executable path:\n%s\n\n"
-                       "Expected companion binary in that directory:\n%s"),
-                     wxStandardPaths::Get().GetExecutablePath(),
-                     ExpectedOpenGothicBinaryName()),
-                 _("Invalid Launcher Location"), wxOK | wxICON_ERROR);
+    ShowMessage(wxString::Format(
+                    _("OpenGothicStarter must be started from '<Gothic>/system'.\n\n"
+                      "Current executable path:\n%s\n\n"
+                      "Expected companion binary in that directory:\n%s"),
+                    wxStandardPaths::Get().GetExecutablePath(),
+                    ExpectedOpenGothicBinaryName()),
+                _("Invalid Launcher Location"), wxOK | wxICON_ERROR);
     return false;
   }
 
   runtime_paths = detectedPaths;
   runtime_paths_resolved = true;
 
+  // The stored override is known before any catalog is loaded, so the
+  // locale is initialized once.
   wxString languageOverride;
   if (TryReadStoredLanguageOverride(runtime_paths, languageOverride)) {
     wxLogMessage(wxT("Using stored language override: %s"), languageOverride);
     InitializeLocalization(app_locale, languageOverride);
-  }
-
-  wxString validationError;
-  if (!ValidateRuntimePaths(runtime_paths, validationError)) {
-    wxLogWarning(wxT("Runtime path validation failed: %s"), validationError);
-    const wxString expectedOpenGothic =
-        wxFileName(runtime_paths.system_dir, ExpectedOpenGothicBinaryName()).GetFullPath();
-    wxMessageBox(wxString::Format(
-                     _("OpenGothic binary was not found.\n\n"
-                       "Checked directory:\n%s\n\n"
-                       "Expected file:\n%s"),
-                     runtime_paths.system_dir, expectedOpenGothic),
-                 _("OpenGothic Not Found"), wxOK | wxICON_ERROR);
-    return false;
+  } else {
+    InitializeLocalization(app_locale);
   }
 
   wxLogMessage(wxT("Launcher executable: %s"), runtime_paths.launcher_executable);
@@ -916,15 +1162,136 @@ bool OpenGothicStarterApp::OnInit() {
                  runtime_paths.open_gothic_executable);
   }
 
-  if (!InitGothicVersion()) {
-    return false;
+  // Validation and version detection finish in the background; the window
+  // shows a loading state and keeps Start disabled until then.
+  MainFrame *frame = new MainFrame();
+
+  // `--launch=<mod.ini>` starts the given mod (or the base game when empty)
+  // once the list is populated and then closes the launcher.
+  wxString launchFile;
+  if (FindCommandLineOption(argv.GetArguments(), wxT("--launch="), launchFile)) {
+    frame->panel->LaunchWhenReady(launchFile);
+  }
+  return true;
+}
+
+void OpenGothicStarterApp::MarkFirstPaint() {
+  if (first_paint_logged) {
+    return;
   }
+  first_paint_logged = true;
+  const int64_t nowUs = TraceNowMicros();
+  RecordTraceSpan("TimeToFirstPaint", "startup", startup_begin_us, nowUs);
+  wxLogMessage(wxT("Time to first paint: %.1f ms"),
+               static_cast<double>(nowUs - startup_begin_us) / 1000.0);
+}
+
+void OpenGothicStarterApp::MarkInteractive() {
+  if (interactive_logged) {
+    return;
+  }
+  interactive_logged = true;
+  const int64_t nowUs = TraceNowMicros();
+  RecordTraceSpan("TimeToInteractive", "startup", startup_begin_us, nowUs);
+  wxLogMessage(wxT("Time to interactive: %.1f ms"),
+               static_cast<double>(nowUs - startup_begin_us) / 1000.0);
+}
+
+int OpenGothicStarterApp::OnRun() {
+  if (forwarded_to_running_instance) {
+    return 0;
+  }
+  return wxApp::OnRun();
+}
+
+int OpenGothicStarterApp::OnExit() {
+  {
+    std::lock_guard<std::mutex> lock(gGameExitMutex);
+    gGameExitsOpen = false;
+  }
+  instance_channel.Stop();
+  // Before the scheduler, which runs the recorder's report tasks.
+  StopPrefetchTracking();
+  for (const auto &[name, stats] : ShutdownTaskScheduler()) {
+    wxLogVerbose(wxT("Task %s: %llu run, %llu cancelled, %lld us total, %lld us max, "
+                     "%lld us queued, %llu deferred for %lld us, %llu at idle priority"),
+                 wxString::FromUTF8(name), static_cast<unsigned long long>(stats.completed),
+                 static_cast<unsigned long long>(stats.cancelled),
+                 static_cast<long long>(stats.total_run_us),
+                 static_cast<long long>(stats.max_run_us),
+                 static_cast<long long>(stats.total_wait_us),
+                 static_cast<unsigned long long>(stats.deferred),
+                 static_cast<long long>(stats.total_deferred_us),
+                 static_cast<unsigned long long>(stats.demoted));
+  }
+  const IconCache::Stats iconStats = icon_cache.GetStats();
+  wxLogVerbose(wxT("Icon cache: %llu hits, %llu misses, %llu evicted, %lu icons in %lu bytes"),
+               static_cast<unsigned long long>(iconStats.hits),
+               static_cast<unsigned long long>(iconStats.misses),
+               static_cast<unsigned long long>(iconStats.evictions),
+               static_cast<unsigned long>(iconStats.entries),
+               static_cast<unsigned long>(iconStats.bytes));
+  // The icons must go before wxWidgets shuts down.
+  icon_cache.Clear();
+  StopTracing();
+  // Everything logged so far is on disk before wxWidgets tears down.
+  if (file_log != nullptr) {
+    file_log->Sync();
+  }
+  return wxApp::OnExit();
+}
+
+bool OpenGothicStarterApp::ClaimSingleInstance(wxString &warning) {
+  TraceScope trace("ClaimSingleInstance");
+  const wxArrayString args = argv.GetArguments();
+  const wxString name = GetInstanceChannelName(wxStandardPaths::Get().GetExecutablePath());
+  const InstanceChannel::Handler handler = [this](const wxArrayString &forwarded) {
+    CallAfter([this, forwarded] { HandleForwardedCommandLine(forwarded); });
+  };
 
-  new MainFrame();
+  for (int attempt = 0; attempt < 10; ++attempt) {
+    if (ForwardToRunningInstance(name, args, warning)) {
+      return false;
+    }
+    bool alreadyRunning = false;
+    if (instance_channel.Listen(name, handler, alreadyRunning, warning)) {
+      warning.clear();
+      return true;
+    }
+    if (!alreadyRunning) {
+      return true;
+    }
+    // The owner holds the endpoint but is not accepting yet.
+    wxMilliSleep(20);
+  }
   return true;
 }
 
+void OpenGothicStarterApp::HandleForwardedCommandLine(const wxArrayString &args) {
+  MainFrame *frame = dynamic_cast<MainFrame *>(GetTopWindow());
+  if (frame == nullptr) {
+    return;
+  }
+  wxLogMessage(wxT("Command line forwarded by another launch: %s"), wxJoin(args, ' '));
+  frame->panel->StayOpen();
+  frame->Show();
+  frame->Iconize(false);
+  frame->Raise();
+
+  wxString launchFile;
+  if (FindCommandLineOption(args, wxT("--launch="), launchFile)) {
+    // A modal dialog disables the frame; launching under it would close the
+    // frame from beneath the dialog.
+    if (!frame->IsEnabled()) {
+      wxLogWarning(wxT("Ignoring forwarded --launch while a dialog is open."));
+      return;
+    }
+    frame->panel->LaunchWhenReady(launchFile);
+  }
+}
+
 bool OpenGothicStarterApp::InitConfig() {
+  TraceScope trace("InitConfig");
   wxStandardPaths::Get().SetFileLayout(wxStandardPaths::FileLayout_XDG);
   wxStandardPaths &path = wxStandardPaths::Get();
   const wxString configPath =
@@ -942,50 +1309,45 @@ bool OpenGothicStarterApp::InitConfig() {
   return true;
 }
 
-bool OpenGothicStarterApp::InitGothicVersion() {
+void OpenGothicStarterApp::InitLogging() {
+  TraceScope trace("InitLogging");
+  AsyncFileLog::Options options;
+  options.path = wxFileName(GetUserStateDir(), wxT("launcher.log")).GetFullPath();
+  long maxSizeKb = static_cast<long>(options.max_bytes / 1024);
+  long keepFiles = options.keep_files;
+  wxConfigBase::Get()->Read(wxT("LOG/maxSizeKB"), &maxSizeKb, maxSizeKb);
+  wxConfigBase::Get()->Read(wxT("LOG/files"), &keepFiles, keepFiles);
+  options.max_bytes = static_cast<uint64_t>(std::max(maxSizeKb, 16L)) * 1024;
+  options.keep_files = static_cast<int>(std::min(std::max(keepFiles, 0L), 20L));
+
+  auto *log = new AsyncFileLog();
+  wxString error;
+  if (!log->Open(options, error)) {
+    delete log;
+    wxLog::SetActiveTarget(new wxLogStderr());
+    wxLogWarning(wxT("Logging to stderr only: %s"), error);
+    return;
+  }
+  file_log = log;
+  delete wxLog::SetActiveTarget(log);
+  // The log outlives the scheduler, which OnExit() shuts down first.
+  GetTaskScheduler().SetLogTarget(log);
+  wxLogVerbose(wxT("Logging to %s"), options.path);
+}
+
+bool OpenGothicStarterApp::InitGothicVersion(GothicVersion storedVersion,
+                                             GothicVersion detectedVersion) {
+  TraceScope trace("InitGothicVersion");
   if (!runtime_paths_resolved) {
     return false;
   }
 
   const wxString configPath = GetInstallConfigPath(runtime_paths);
-  if (wxFileName::FileExists(configPath)) {
-    wxFileConfig cfg(wxEmptyString, wxEmptyString, configPath, wxEmptyString,
-                     wxCONFIG_USE_LOCAL_FILE);
-    long value = -1;
-    GothicVersion parsedVersion = GothicVersion::Unknown;
-    if (cfg.Read(wxT("GENERAL/gothicVersion"), &value) &&
-        GothicVersionFromIndex(static_cast<int>(value), parsedVersion)) {
-      gothic_version = parsedVersion;
-      wxLogMessage(wxT("Using stored Gothic version: %s"),
-                   GothicVersionLabel(gothic_version));
-      return true;
-    }
-  }
-
-  const wxString dataDir = wxFileName(runtime_paths.gothic_root, wxT("Data")).GetFullPath();
-  const wxString systemDir = runtime_paths.system_dir;
-
-  const wxString addonMarkers[] = {
-      wxT("Worlds_Addon.vdf"), wxT("Anims_Addon.vdf"), wxT("Meshes_Addon.vdf"),
-      wxT("Textures_Addon.vdf"), wxT("Sounds_Addon.vdf")};
-
-  GothicVersion detectedVersion = GothicVersion::Unknown;
-  for (const wxString &marker : addonMarkers) {
-    if (DirectoryHasFileCaseInsensitive(dataDir, marker)) {
-      detectedVersion = GothicVersion::Gothic2Notr;
-      break;
-    }
-  }
-
-  if (detectedVersion == GothicVersion::Unknown &&
-      DirectoryHasFileCaseInsensitive(systemDir, wxT("Gothic2.exe"))) {
-    detectedVersion = GothicVersion::Gothic2Classic;
-  }
-
-  if (detectedVersion == GothicVersion::Unknown &&
-      (DirectoryHasFileCaseInsensitive(systemDir, wxT("GOTHIC.EXE")) ||
-       DirectoryHasFileCaseInsensitive(systemDir, wxT("GothicMod.exe")))) {
-    detectedVersion = GothicVersion::Gothic1;
+  if (storedVersion != GothicVersion::Unknown) {
+    gothic_version = storedVersion;
+    wxLogMessage(wxT("Using stored Gothic version: %s"),
+                 GothicVersionLabel(gothic_version));
+    return true;
   }
 
   if (detectedVersion != GothicVersion::Unknown) {
@@ -998,6 +1360,12 @@ bool OpenGothicStarterApp::InitGothicVersion() {
     return true;
   }
 
+  if (gNonInteractive) {
+    wxLogError(wxT("Gothic version could not be detected; start the launcher once "
+                   "interactively to choose it."));
+    return false;
+  }
+
   wxArrayString choices;
   choices.Add(_("Gothic 1"));
   choices.Add(_("Gothic 2 Classic"));
@@ -1018,8 +1386,8 @@ bool OpenGothicStarterApp::InitGothicVersion() {
 
   GothicVersion selectedVersion = GothicVersion::Unknown;
   if (!GothicVersionFromIndex(dialog.GetSelection(), selectedVersion)) {
-    wxMessageBox(_("Selected Gothic version is invalid."), _("Configuration Error"),
-                 wxOK | wxICON_ERROR);
+    ShowMessage(_("Selected Gothic version is invalid."), _("Configuration Error"),
+                wxOK | wxICON_ERROR);
     return false;
   }
   gothic_version = selectedVersion;
@@ -1,8 +1,23 @@
 #pragma once
 
+#include "async_log.h"
+#include "gothic_version.h"
+#include "icon_cache.h"
+#include "instance_channel.h"
+#include "launch_command.h"
+#include "mod_discovery.h"
+#include "mod_table.h"
+#include "process_launcher.h"
+#include "run_history.h"
 #include "runtime_paths.h"
+#include "settings_dialog.h"
+#include "task_scheduler.h"
+#include "translatable_controls.h"
 
+#include <array>
+#include <cstdint>
 #include <memory>
+#include <optional>
 #include <vector>
 #include <wx/intl.h>
 #include <wx/listctrl.h>
@@ -10,60 +25,85 @@
 
 extern const wxString APP_NAME;
 
-enum class GothicVersion : int {
-  Unknown = -1,
-  Gothic1 = 0,
-  Gothic2Classic = 1,
-  Gothic2Notr = 2
-};
-
-struct GameEntry {
-  wxString file;
-  wxString title;
-  wxString authors;
-  wxString webpage;
-  wxString icon;
-  wxString datadir;
-};
-
 class MainPanel : public wxPanel {
 public:
   MainPanel(wxWindow *parent);
+  ~MainPanel() override;
   void Populate();
+  bool LaunchGame(const wxString &file);
+  // Runs LaunchGame() once discovery has finished, then closes the frame. A
+  // started game keeps the launcher running hidden until its run is recorded.
+  void LaunchWhenReady(const wxString &file);
+  // Keeps the frame open after a hidden --launch game exits.
+  void StayOpen();
 
 private:
   void InitWidgets();
+  void ConfirmRuntime();
+  void ApplyRuntimeState();
+  void ShowGames(ModTable discovered);
+  void ShowIcon(size_t index, const IconCache::Key &key, const wxImage &image);
+  void RunPendingLaunch();
+  void UpdateStartButton();
+  void UpdateBuildLabel();
+  void UpdateFxaaLabel();
+  // Re-applies translated strings after the active catalog changed.
+  void Relabel();
   void OnSize(wxSizeEvent &event);
   void OnSelected(wxListEvent &);
   void OnFXAAScroll(wxCommandEvent &);
   void DoStart();
   void DoSettings();
+  void DoHistory();
+  void DoShaderCaches();
   void DoOrigin();
-  bool BuildLaunchCommand(const RuntimePaths &paths, int gameidx,
-                          wxArrayString &command, wxString &error) const;
-  wxString ResolveWorkingDirectory(const RuntimePaths &paths, int gameidx) const;
-  bool EnsureWorkingDirectoryExists(const wxString &path, wxString &error) const;
+  void StartMonitor(long pid, const wxString &gameTitle);
+  void OnGameExited(const ProcessExit &exit, const RunRecord &record);
+  void PrepareShaderCacheEnvironment(const RuntimePaths &paths, const GameEntry *game,
+                                     const wxArrayString &command,
+                                     SpawnOptions &options, wxString &cacheDir);
+  LaunchOptions CollectLaunchOptions(int gameidx) const;
+  std::optional<GameEntry> GetGame(int gameidx) const;
   int GetSelectedGameIndex() const;
   void SaveParams();
   void LoadParams();
-  std::vector<GameEntry> InitGames();
 
   wxListView *list_ctrl;
   wxButton *button_start;
   wxButton *button_settings;
+  wxButton *button_history;
+  wxButton *button_caches;
   wxCheckBox *check_orig;
-  wxCheckBox *check_window;
-  wxCheckBox *check_marvin;
-  wxCheckBox *check_rt;
-  wxCheckBox *check_rti;
-  wxCheckBox *check_meshlets;
-  wxCheckBox *check_vsm;
-  wxCheckBox *check_bench;
+  // One checkbox per kLaunchToggles row.
+  std::array<wxCheckBox *, kLaunchToggleCount> param_checks;
+  wxCheckBox *check_monitor;
   wxStaticText *field_fxaa;
   wxStaticText *value_fxaa;
   wxSlider *slide_fxaa;
-
-  std::vector<GameEntry> games;
+  wxStaticText *value_build;
+  TranslatableControls labels;
+  // Created by the first DoSettings() and reused afterwards.
+  SettingsDialog *settings_dialog = nullptr;
+  // The values shown by settings_dialog and stamps of the files they came from.
+  GothicVersion settings_version = GothicVersion::Unknown;
+  wxString settings_language;
+  SystemPackSettings settings_system_pack;
+  wxString settings_install_stamp;
+  wxString settings_system_pack_stamp;
+  bool settings_values_current = false;
+
+  ModTable games;
+  // Cancelled on repopulation and destruction; see RunTaskThenUi().
+  CancellationToken populate_token;
+  // Cancelled on destruction.
+  CancellationToken lifetime_token;
+  bool games_ready = false;
+  bool runtime_ready = false;
+  bool launch_pending = false;
+  wxString pending_launch;
+  // Games started from this panel whose runs are not recorded yet.
+  int running_games = 0;
+  bool close_after_games = false;
 };
 
 class MainFrame : public wxFrame {
@@ -75,17 +115,44 @@ public:
 
 class OpenGothicStarterApp : public wxApp {
 public:
+  ~OpenGothicStarterApp() override;
+
   bool OnInit() override;
+  int OnRun() override;
+  int OnExit() override;
 
   RuntimePaths runtime_paths;
   bool runtime_paths_resolved = false;
   GothicVersion gothic_version = GothicVersion::Unknown;
+  GothicExecutableInfo gothic_executable;
+  bool gothic_executable_detected = false;
+  // Set once the paths are validated and the version is known; the main
+  // window is shown before that.
+  bool runtime_confirmed = false;
+  // Mod icons, kept across list repopulations.
+  IconCache icon_cache;
 
 private:
   friend class MainPanel;
 
+  // Returns false when the command line was handed to a launcher that is
+  // already running. Any other outcome keeps this process as a normal
+  // instance; `warning` then says why single-instance mode is off.
+  bool ClaimSingleInstance(wxString &warning);
+  void HandleForwardedCommandLine(const wxArrayString &args);
   bool InitConfig();
-  bool InitGothicVersion();
+  bool InitGothicVersion(GothicVersion stored, GothicVersion detected);
+  void InitLogging();
+  void MarkFirstPaint();
+  void MarkInteractive();
+
+  int64_t startup_begin_us = 0;
+  bool first_paint_logged = false;
+  bool interactive_logged = false;
+  bool forwarded_to_running_instance = false;
+  InstanceChannel instance_channel;
+  // The active log target, owned by wxLog; null when logging to stderr only.
+  AsyncFileLog *file_log = nullptr;
 
   std::unique_ptr<wxLocale> app_locale;
 };
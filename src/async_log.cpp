@@ -0,0 +1,355 @@
+#include "async_log.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <wx/datetime.h>
+#include <wx/filefn.h>
+#include <wx/filename.h>
+#include <wx/time.h>
+#include <wx/utils.h>
+
+namespace {
+
+// Lines are written in chunks of about this size.
+constexpr size_t kWriteBatchBytes = 64 * 1024;
+// Backstop for a wake-up lost between a push and the writer going to sleep.
+constexpr std::chrono::milliseconds kWriterPollInterval{100};
+
+const char *LevelName(wxLogLevel level) {
+  switch (level) {
+  case wxLOG_FatalError:
+    return "FATAL";
+  case wxLOG_Error:
+    return "ERROR";
+  case wxLOG_Warning:
+    return "WARN";
+  case wxLOG_Message:
+    return "INFO";
+  case wxLOG_Status:
+    return "STATUS";
+  case wxLOG_Info:
+    return "VERBOSE";
+  case wxLOG_Debug:
+    return "DEBUG";
+  case wxLOG_Trace:
+    return "TRACE";
+  default:
+    return "USER";
+  }
+}
+
+void AppendPrefix(std::string &line, int64_t elapsedMs, const char *level) {
+  char prefix[48];
+  std::snprintf(prefix, sizeof(prefix), "+%4lld.%03lld %-7s ",
+                static_cast<long long>(elapsedMs / 1000),
+                static_cast<long long>(elapsedMs % 1000), level);
+  line += prefix;
+}
+
+// The wxLOG_COMPONENT when one is set, else the source file's stem, so
+// records from mod_discovery.cpp read as "mod_discovery".
+void AppendCategory(std::string &line, const wxLogRecordInfo &info) {
+  if (info.component != nullptr && *info.component != '\0') {
+    line += info.component;
+    return;
+  }
+  if (info.filename == nullptr || *info.filename == '\0') {
+    line += "app";
+    return;
+  }
+  const char *begin = info.filename;
+  const char *end = begin;
+  for (const char *p = begin; *p != '\0'; ++p) {
+    if (*p == '/' || *p == '\\') {
+      begin = p + 1;
+    }
+    end = p + 1;
+  }
+  for (const char *p = end; p > begin; --p) {
+    if (p[-1] == '.') {
+      end = p - 1;
+      break;
+    }
+  }
+  line.append(begin, end);
+}
+
+size_t RoundUpToPowerOfTwo(size_t value) {
+  size_t result = 2;
+  while (result < value) {
+    result <<= 1;
+  }
+  return result;
+}
+
+wxString RotatedPath(const wxString &path, int index) {
+  return wxString::Format(wxT("%s.%d"), path, index);
+}
+
+} // namespace
+
+AsyncFileLog::~AsyncFileLog() { Close(); }
+
+bool AsyncFileLog::Open(const Options &requested, wxString &error) {
+  if (writer.joinable()) {
+    error = wxT("The log is already open.");
+    return false;
+  }
+  options = requested;
+
+  const wxString dir = wxFileName(options.path).GetPath();
+  if (!dir.empty() && !wxFileName::DirExists(dir) &&
+      !wxFileName::Mkdir(dir, wxS_DIR_DEFAULT, wxPATH_MKDIR_FULL)) {
+    error = wxString::Format(wxT("Cannot create log directory '%s'."), dir);
+    return false;
+  }
+  if (!file.Open(options.path, wxT("ab"))) {
+    error = wxString::Format(wxT("Cannot open log file '%s'."), options.path);
+    return false;
+  }
+  file_size = static_cast<uint64_t>(std::max<wxFileOffset>(file.Length(), 0));
+  if (file_size >= options.max_bytes) {
+    Rotate();
+    if (!file.IsOpened()) {
+      error = wxString::Format(wxT("Cannot rotate log file '%s'."), options.path);
+      return false;
+    }
+  }
+
+  const size_t capacity = RoundUpToPowerOfTwo(options.queue_capacity);
+  slots.reset(new Slot[capacity]);
+  for (size_t i = 0; i < capacity; ++i) {
+    slots[i].sequence.store(i, std::memory_order_relaxed);
+  }
+  mask = capacity - 1;
+  enqueue_pos.store(0, std::memory_order_relaxed);
+  dequeue_pos.store(0, std::memory_order_relaxed);
+  dropped.store(0, std::memory_order_relaxed);
+  stopping = false;
+  sync_requested = 0;
+  sync_completed = 0;
+
+  start_ms = wxGetUTCTimeMillis().GetValue();
+  const wxString header = wxString::Format(
+      wxT("=== OpenGothicStarter log opened %s, pid %lu ===\n"),
+      wxDateTime::Now().FormatISOCombined(' '),
+      static_cast<unsigned long>(wxGetProcessId()));
+  const wxScopedCharBuffer utf8 = header.utf8_str();
+  file.Write(utf8.data(), utf8.length());
+  file_size += utf8.length();
+
+  accepting.store(true, std::memory_order_release);
+  writer = std::thread([this] { Run(); });
+  return true;
+}
+
+void AsyncFileLog::Flush() {
+  wxLog::Flush();
+  if (writer.joinable() && HasPending()) {
+    wake.notify_one();
+  }
+}
+
+void AsyncFileLog::Sync() {
+  wxLog::Flush();
+  if (!writer.joinable() || std::this_thread::get_id() == writer.get_id()) {
+    return;
+  }
+  std::unique_lock<std::mutex> lock(wake_mutex);
+  const uint64_t ticket = ++sync_requested;
+  wake.notify_one();
+  synced.wait(lock, [&] { return sync_completed >= ticket || stopping; });
+}
+
+void AsyncFileLog::Close() {
+  if (!writer.joinable()) {
+    return;
+  }
+  accepting.store(false, std::memory_order_seq_cst);
+  while (producers.load(std::memory_order_seq_cst) != 0) {
+    std::this_thread::yield();
+  }
+  {
+    std::lock_guard<std::mutex> lock(wake_mutex);
+    stopping = true;
+  }
+  wake.notify_one();
+  synced.notify_all();
+  writer.join();
+  // The writer has exited, so this thread is the only consumer now.
+  Drain();
+  file.Close();
+}
+
+void AsyncFileLog::DoLogRecord(wxLogLevel level, const wxString &message,
+                               const wxLogRecordInfo &info) {
+  std::string line;
+  // wxWidgets stamps the record where it was logged, which also holds for
+  // records from other threads that it buffers and replays on the UI thread.
+  AppendPrefix(line, std::max<int64_t>(info.timestampMS - start_ms, 0), LevelName(level));
+  AppendCategory(line, info);
+  line += ": ";
+  const wxScopedCharBuffer utf8 = message.utf8_str();
+  size_t length = utf8.length();
+  while (length > 0 && utf8.data()[length - 1] == '\n') {
+    --length;
+  }
+  // Continuation lines are indented so every record starts with its prefix.
+  for (size_t i = 0; i < length; ++i) {
+    line += utf8.data()[i];
+    if (utf8.data()[i] == '\n') {
+      line += '\t';
+    }
+  }
+  line += '\n';
+
+  producers.fetch_add(1, std::memory_order_seq_cst);
+  if (!accepting.load(std::memory_order_seq_cst)) {
+    producers.fetch_sub(1, std::memory_order_seq_cst);
+    std::fwrite(line.data(), 1, line.size(), stderr);
+    return;
+  }
+  if (Push(line)) {
+    wake.notify_one();
+  } else {
+    dropped.fetch_add(1, std::memory_order_relaxed);
+  }
+  producers.fetch_sub(1, std::memory_order_release);
+
+  if (level == wxLOG_FatalError) {
+    // wxWidgets aborts right after a fatal error.
+    Sync();
+  }
+}
+
+// Bounded multi-producer queue after Dmitry Vyukov: each slot's sequence
+// says whether it is free for the producer at `pos` (== pos) or holds the
+// record for the consumer at `pos` (== pos + 1).
+bool AsyncFileLog::Push(std::string &line) {
+  size_t pos = enqueue_pos.load(std::memory_order_relaxed);
+  for (;;) {
+    Slot &slot = slots[pos & mask];
+    const size_t sequence = slot.sequence.load(std::memory_order_acquire);
+    const intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+    if (diff == 0) {
+      if (enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+        slot.line.swap(line);
+        slot.sequence.store(pos + 1, std::memory_order_release);
+        return true;
+      }
+    } else if (diff < 0) {
+      return false;
+    } else {
+      pos = enqueue_pos.load(std::memory_order_relaxed);
+    }
+  }
+}
+
+bool AsyncFileLog::Pop(std::string &line) {
+  const size_t pos = dequeue_pos.load(std::memory_order_relaxed);
+  Slot &slot = slots[pos & mask];
+  if (slot.sequence.load(std::memory_order_acquire) != pos + 1) {
+    return false;
+  }
+  line.swap(slot.line);
+  slot.line.clear();
+  slot.sequence.store(pos + mask + 1, std::memory_order_release);
+  dequeue_pos.store(pos + 1, std::memory_order_relaxed);
+  return true;
+}
+
+bool AsyncFileLog::HasPending() const {
+  return enqueue_pos.load(std::memory_order_relaxed) !=
+         dequeue_pos.load(std::memory_order_relaxed);
+}
+
+void AsyncFileLog::Run() {
+  // Write errors must not be logged back into the queue.
+  wxLogNull noLog;
+  for (;;) {
+    uint64_t ticket = 0;
+    bool stop = false;
+    {
+      std::unique_lock<std::mutex> lock(wake_mutex);
+      wake.wait_for(lock, kWriterPollInterval, [&] {
+        return stopping || sync_requested != sync_completed || HasPending();
+      });
+      ticket = sync_requested;
+      stop = stopping;
+    }
+    Drain();
+    {
+      std::lock_guard<std::mutex> lock(wake_mutex);
+      sync_completed = ticket;
+    }
+    synced.notify_all();
+    if (stop) {
+      return;
+    }
+  }
+}
+
+void AsyncFileLog::Drain() {
+  std::string batch;
+  std::string line;
+  bool wrote = false;
+  for (;;) {
+    batch.clear();
+    while (batch.size() < kWriteBatchBytes && Pop(line)) {
+      batch += line;
+    }
+    const uint64_t lost = dropped.exchange(0, std::memory_order_relaxed);
+    if (lost != 0) {
+      AppendPrefix(batch, wxGetUTCTimeMillis().GetValue() - start_ms, "WARN");
+      char note[64];
+      std::snprintf(note, sizeof(note), "log: %llu messages dropped, queue full\n",
+                    static_cast<unsigned long long>(lost));
+      batch += note;
+    }
+    if (batch.empty()) {
+      break;
+    }
+    Write(batch);
+    wrote = true;
+  }
+  if (wrote && file.IsOpened()) {
+    file.Flush();
+  }
+}
+
+void AsyncFileLog::Write(const std::string &text) {
+  if (options.mirror_stderr) {
+    std::fwrite(text.data(), 1, text.size(), stderr);
+  }
+  if (!file.IsOpened()) {
+    return;
+  }
+  file.Write(text.data(), text.size());
+  file_size += text.size();
+  if (file_size >= options.max_bytes) {
+    Rotate();
+  }
+}
+
+void AsyncFileLog::Rotate() {
+  wxLogNull noLog;
+  file.Close();
+  if (options.keep_files > 0) {
+    const wxString oldest = RotatedPath(options.path, options.keep_files);
+    if (wxFileExists(oldest)) {
+      wxRemoveFile(oldest);
+    }
+    for (int i = options.keep_files - 1; i >= 1; --i) {
+      const wxString from = RotatedPath(options.path, i);
+      if (wxFileExists(from)) {
+        wxRenameFile(from, RotatedPath(options.path, i + 1));
+      }
+    }
+    wxRenameFile(options.path, RotatedPath(options.path, 1));
+  } else {
+    wxRemoveFile(options.path);
+  }
+  file.Open(options.path, wxT("ab"));
+  file_size = 0;
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <wx/ffile.h>
+#include <wx/log.h>
+#include <wx/string.h>
+
+// Log target that keeps file I/O off the logging thread. Each record is
+// formatted into one line,
+//
+//   +   1.234 WARN    mod_discovery: Skipping unreadable mod.ini
+//
+// (seconds since Open() at the time the record was logged, level, and the
+// wxLOG_COMPONENT or else the source file name), and handed through a bounded
+// lock-free queue to a writer thread that appends it to the log file and
+// stderr. A full queue drops records and the writer reports how many.
+//
+// Records are formatted on the thread that logs them only where this is its
+// wxLog target: the UI thread, and scheduler workers once it is passed to
+// TaskScheduler::SetLogTarget(). Other threads' records are buffered by
+// wxWidgets and formatted when the UI thread flushes them.
+class AsyncFileLog : public wxLog {
+public:
+  struct Options {
+    wxString path;
+    // The file is rotated to `<path>.1` once it grows past this; older
+    // copies move up and the one past `keep_files` is deleted.
+    uint64_t max_bytes = 1024 * 1024;
+    int keep_files = 3;
+    bool mirror_stderr = true;
+    // Rounded up to a power of two.
+    size_t queue_capacity = 4096;
+  };
+
+  AsyncFileLog() = default;
+  AsyncFileLog(const AsyncFileLog &) = delete;
+  AsyncFileLog &operator=(const AsyncFileLog &) = delete;
+  ~AsyncFileLog() override;
+
+  // Appends to `options.path`, creating its directory, and starts the writer.
+  bool Open(const Options &options, wxString &error);
+  // Wakes the writer without waiting; wxWidgets calls this on every idle.
+  void Flush() override;
+  // Returns once every record logged before the call is on disk.
+  void Sync();
+  // Writes out everything queued and stops the writer. Records logged
+  // afterwards go straight to stderr.
+  void Close();
+
+protected:
+  void DoLogRecord(wxLogLevel level, const wxString &message,
+                   const wxLogRecordInfo &info) override;
+
+private:
+  struct Slot {
+    std::atomic<size_t> sequence{0};
+    std::string line;
+  };
+
+  bool Push(std::string &line);
+  bool Pop(std::string &line);
+  bool HasPending() const;
+  void Run();
+  void Drain();
+  void Write(const std::string &text);
+  void Rotate();
+
+  Options options;
+  wxFFile file;
+  uint64_t file_size = 0;
+  // Wall-clock milliseconds at Open(), the epoch of wxLogRecordInfo::timestampMS.
+  int64_t start_ms = 0;
+
+  std::unique_ptr<Slot[]> slots;
+  size_t mask = 0;
+  std::atomic<size_t> enqueue_pos{0};
+  // Advanced only by the consumer: the writer, or Close() once it is gone.
+  std::atomic<size_t> dequeue_pos{0};
+  std::atomic<uint64_t> dropped{0};
+  std::atomic<bool> accepting{false};
+  // Producers between checking `accepting` and finishing their push.
+  std::atomic<int> producers{0};
+
+  std::thread writer;
+  std::mutex wake_mutex;
+  std::condition_variable wake;
+  std::condition_variable synced;
+  uint64_t sync_requested = 0;
+  uint64_t sync_completed = 0;
+  bool stopping = false;
+};
@@ -0,0 +1,630 @@
+#include "elf_preflight.h"
+
+#if defined(__linux__)
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <dirent.h>
+#include <fcntl.h>
+#include <glob.h>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include <wx/ffile.h>
+#include <wx/filename.h>
+#endif
+
+#if defined(__linux__)
+
+namespace {
+
+constexpr uint32_t kPtLoad = 1;
+constexpr uint32_t kPtDynamic = 2;
+constexpr int64_t kDtNull = 0;
+constexpr int64_t kDtNeeded = 1;
+constexpr int64_t kDtStrtab = 5;
+constexpr int64_t kDtStrsz = 10;
+constexpr int64_t kDtRpath = 15;
+constexpr int64_t kDtRunpath = 29;
+constexpr int64_t kDtVerdef = 0x6ffffffc;
+constexpr int64_t kDtVerdefnum = 0x6ffffffd;
+constexpr int64_t kDtVerneed = 0x6ffffffe;
+constexpr int64_t kDtVerneednum = 0x6fffffff;
+constexpr size_t kMaxStringTable = 16 * 1024 * 1024;
+const char kCacheVersion[] = "1";
+
+struct LoadSegment {
+  uint64_t vaddr;
+  uint64_t offset;
+  uint64_t size;
+};
+
+struct VersionNeed {
+  std::string library;
+  std::vector<std::string> versions;
+};
+
+struct ElfObject {
+  unsigned char elf_class = 0;
+  uint16_t machine = 0;
+  std::vector<std::string> needed;
+  std::string rpath;
+  std::string runpath;
+  std::vector<VersionNeed> version_needs;
+  std::unordered_set<std::string> version_defs;
+};
+
+class ElfReader {
+public:
+  explicit ElfReader(int file) : fd(file) {}
+
+  bool Read(ElfObject &object, bool headerOnly) {
+    unsigned char ident[64];
+    if (!ReadAt(0, ident, sizeof(ident)) || std::memcmp(ident, "\x7f" "ELF", 4) != 0 ||
+        (ident[4] != 1 && ident[4] != 2) || ident[5] != 1) {
+      // Only little-endian ELF is supported, which covers every target
+      // OpenGothic ships for.
+      return false;
+    }
+    wide = ident[4] == 2;
+    object.elf_class = ident[4];
+    object.machine = static_cast<uint16_t>(Field(ident, 18, 2));
+    if (headerOnly) {
+      return true;
+    }
+
+    const uint64_t phoff = wide ? Field(ident, 32, 8) : Field(ident, 28, 4);
+    const uint64_t phentsize = wide ? Field(ident, 54, 2) : Field(ident, 42, 2);
+    const uint64_t phnum = wide ? Field(ident, 56, 2) : Field(ident, 44, 2);
+    if (phentsize < (wide ? 56u : 32u) || phnum == 0 || phnum > 4096) {
+      return false;
+    }
+    std::vector<unsigned char> headers(static_cast<size_t>(phentsize * phnum));
+    if (!ReadAt(phoff, headers.data(), headers.size())) {
+      return false;
+    }
+
+    uint64_t dynamicOffset = 0;
+    uint64_t dynamicSize = 0;
+    for (uint64_t i = 0; i < phnum; ++i) {
+      const unsigned char *header = headers.data() + i * phentsize;
+      const uint64_t type = Field(header, 0, 4);
+      const uint64_t offset = wide ? Field(header, 8, 8) : Field(header, 4, 4);
+      const uint64_t vaddr = wide ? Field(header, 16, 8) : Field(header, 8, 4);
+      const uint64_t filesz = wide ? Field(header, 32, 8) : Field(header, 16, 4);
+      if (type == kPtLoad) {
+        segments.push_back({vaddr, offset, filesz});
+      } else if (type == kPtDynamic) {
+        dynamicOffset = offset;
+        dynamicSize = filesz;
+      }
+    }
+    if (dynamicSize == 0) {
+      // Statically linked.
+      return true;
+    }
+
+    std::vector<unsigned char> dynamic(static_cast<size_t>(std::min<uint64_t>(dynamicSize, 1 << 20)));
+    if (!ReadAt(dynamicOffset, dynamic.data(), dynamic.size())) {
+      return false;
+    }
+    const size_t entrySize = wide ? 16 : 8;
+    std::vector<uint64_t> needed;
+    uint64_t strtab = 0, strsz = 0, rpath = 0, runpath = 0;
+    uint64_t verdef = 0, verdefnum = 0, verneed = 0, verneednum = 0;
+    bool hasRpath = false, hasRunpath = false;
+    for (size_t pos = 0; pos + entrySize <= dynamic.size(); pos += entrySize) {
+      const int64_t tag = static_cast<int64_t>(Field(dynamic.data(), pos, entrySize / 2));
+      const uint64_t value = Field(dynamic.data(), pos + entrySize / 2, entrySize / 2);
+      if (tag == kDtNull) {
+        break;
+      }
+      switch (tag) {
+      case kDtNeeded:
+        needed.push_back(value);
+        break;
+      case kDtStrtab:
+        strtab = value;
+        break;
+      case kDtStrsz:
+        strsz = value;
+        break;
+      case kDtRpath:
+        rpath = value;
+        hasRpath = true;
+        break;
+      case kDtRunpath:
+        runpath = value;
+        hasRunpath = true;
+        break;
+      case kDtVerdef:
+        verdef = value;
+        break;
+      case kDtVerdefnum:
+        verdefnum = value;
+        break;
+      case kDtVerneed:
+        verneed = value;
+        break;
+      case kDtVerneednum:
+        verneednum = value;
+        break;
+      default:
+        break;
+      }
+    }
+
+    uint64_t strtabOffset = 0;
+    if (strsz == 0 || strsz > kMaxStringTable || !ToOffset(strtab, strtabOffset)) {
+      return false;
+    }
+    strings.resize(static_cast<size_t>(strsz));
+    if (!ReadAt(strtabOffset, &strings[0], strings.size())) {
+      return false;
+    }
+    for (uint64_t index : needed) {
+      object.needed.push_back(String(index));
+    }
+    if (hasRpath) {
+      object.rpath = String(rpath);
+    }
+    if (hasRunpath) {
+      object.runpath = String(runpath);
+    }
+    ReadVersionNeeds(verneed, verneednum, object);
+    ReadVersionDefs(verdef, verdefnum, object);
+    return true;
+  }
+
+private:
+  static uint64_t Field(const unsigned char *data, size_t offset, size_t size) {
+    uint64_t value = 0;
+    for (size_t i = 0; i < size; ++i) {
+      value |= static_cast<uint64_t>(data[offset + i]) << (8 * i);
+    }
+    return value;
+  }
+
+  bool ReadAt(uint64_t offset, void *buffer, size_t size) const {
+    return pread(fd, buffer, size, static_cast<off_t>(offset)) == static_cast<ssize_t>(size);
+  }
+
+  bool ToOffset(uint64_t vaddr, uint64_t &offset) const {
+    for (const LoadSegment &segment : segments) {
+      if (vaddr >= segment.vaddr && vaddr < segment.vaddr + segment.size) {
+        offset = vaddr - segment.vaddr + segment.offset;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  std::string String(uint64_t index) const {
+    if (index >= strings.size()) {
+      return std::string();
+    }
+    return std::string(strings.c_str() + index);
+  }
+
+  // Elf_Verneed and Elf_Vernaux have the same layout in both classes.
+  void ReadVersionNeeds(uint64_t vaddr, uint64_t count, ElfObject &object) const {
+    uint64_t offset = 0;
+    if (count == 0 || !ToOffset(vaddr, offset)) {
+      return;
+    }
+    for (uint64_t i = 0; i < count && i < 1024; ++i) {
+      unsigned char need[16];
+      if (!ReadAt(offset, need, sizeof(need))) {
+        return;
+      }
+      VersionNeed entry;
+      entry.library = String(Field(need, 4, 4));
+      uint64_t auxOffset = offset + Field(need, 8, 4);
+      for (uint64_t j = 0; j < Field(need, 2, 2); ++j) {
+        unsigned char aux[16];
+        if (!ReadAt(auxOffset, aux, sizeof(aux))) {
+          return;
+        }
+        entry.versions.push_back(String(Field(aux, 8, 4)));
+        auxOffset += Field(aux, 12, 4);
+      }
+      object.version_needs.push_back(std::move(entry));
+      const uint64_t next = Field(need, 12, 4);
+      if (next == 0) {
+        return;
+      }
+      offset += next;
+    }
+  }
+
+  void ReadVersionDefs(uint64_t vaddr, uint64_t count, ElfObject &object) const {
+    uint64_t offset = 0;
+    if (count == 0 || !ToOffset(vaddr, offset)) {
+      return;
+    }
+    for (uint64_t i = 0; i < count && i < 4096; ++i) {
+      unsigned char def[20];
+      unsigned char aux[8];
+      if (!ReadAt(offset, def, sizeof(def)) ||
+          !ReadAt(offset + Field(def, 12, 4), aux, sizeof(aux))) {
+        return;
+      }
+      object.version_defs.insert(String(Field(aux, 0, 4)));
+      const uint64_t next = Field(def, 16, 4);
+      if (next == 0) {
+        return;
+      }
+      offset += next;
+    }
+  }
+
+  int fd;
+  bool wide = false;
+  std::vector<LoadSegment> segments;
+  std::string strings;
+};
+
+bool ReadElfFile(const std::string &path, ElfObject &object, bool headerOnly) {
+  const int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return false;
+  }
+  ElfReader reader(fd);
+  const bool ok = reader.Read(object, headerOnly);
+  close(fd);
+  return ok;
+}
+
+std::string DirName(const std::string &path) {
+  const size_t slash = path.rfind('/');
+  return slash == std::string::npos ? std::string(".") : path.substr(0, slash);
+}
+
+std::string BaseName(const std::string &path) {
+  const size_t slash = path.rfind('/');
+  return slash == std::string::npos ? path : path.substr(slash + 1);
+}
+
+// Appends the directories of a DT_RPATH/DT_RUNPATH or LD_LIBRARY_PATH list.
+// Like ld.so, every $ORIGIN and ${ORIGIN} becomes `origin`, the directory of
+// the object that carries the list.
+void AppendPathList(const std::string &list, const std::string &origin,
+                    std::vector<std::string> &dirs) {
+  size_t begin = 0;
+  while (begin <= list.size()) {
+    size_t end = list.find(':', begin);
+    if (end == std::string::npos) {
+      end = list.size();
+    }
+    std::string dir = list.substr(begin, end - begin);
+    for (const char *token : {"$ORIGIN", "${ORIGIN}"}) {
+      for (size_t at = dir.find(token); at != std::string::npos;
+           at = dir.find(token, at + origin.size())) {
+        dir.replace(at, std::strlen(token), origin);
+      }
+    }
+    if (!dir.empty()) {
+      dirs.push_back(dir);
+    }
+    begin = end + 1;
+  }
+}
+
+void ReadLdSoConf(const std::string &path, std::vector<std::string> &dirs, int depth) {
+  wxFFile file(wxString::FromUTF8(path), wxT("rb"));
+  wxString text;
+  if (depth > 8 || !file.IsOpened() || !file.ReadAll(&text, wxConvUTF8)) {
+    return;
+  }
+  for (const wxString &rawLine : wxSplit(text, '\n', '\0')) {
+    const std::string line =
+        rawLine.BeforeFirst('#').Strip(wxString::both).ToStdString(wxConvUTF8);
+    if (line.compare(0, 8, "include ") == 0) {
+      std::string pattern = line.substr(8);
+      if (!pattern.empty() && pattern[0] != '/') {
+        pattern = DirName(path) + "/" + pattern;
+      }
+      glob_t matches{};
+      if (glob(pattern.c_str(), 0, nullptr, &matches) == 0) {
+        for (size_t i = 0; i < matches.gl_pathc; ++i) {
+          ReadLdSoConf(matches.gl_pathv[i], dirs, depth + 1);
+        }
+      }
+      globfree(&matches);
+    } else if (!line.empty() && line[0] == '/') {
+      dirs.push_back(line);
+    }
+  }
+}
+
+struct DirectoryListing {
+  dev_t device = 0;
+  ino_t inode = 0;
+  timespec mtime{};
+  std::shared_ptr<const std::unordered_set<std::string>> names;
+};
+
+// Shared by every check and re-read only when a directory changes, so a
+// repeated check does not list the system directories again.
+std::mutex gListingsMutex;
+std::unordered_map<std::string, DirectoryListing> gListings;
+
+// Serializes the result cache file between the warm-up check and DoStart.
+std::mutex gResultCacheMutex;
+
+std::shared_ptr<const std::unordered_set<std::string>> ListDirectory(const std::string &dir) {
+  struct stat info {};
+  if (stat(dir.c_str(), &info) != 0 || !S_ISDIR(info.st_mode)) {
+    return nullptr;
+  }
+  std::lock_guard<std::mutex> lock(gListingsMutex);
+  DirectoryListing &listing = gListings[dir];
+  if (listing.names == nullptr || listing.device != info.st_dev ||
+      listing.inode != info.st_ino || listing.mtime.tv_sec != info.st_mtim.tv_sec ||
+      listing.mtime.tv_nsec != info.st_mtim.tv_nsec) {
+    // The mtime is taken before listing, so a change made while reading
+    // invalidates the listing on the next check.
+    auto names = std::make_shared<std::unordered_set<std::string>>();
+    if (DIR *handle = opendir(dir.c_str())) {
+      while (dirent *entry = readdir(handle)) {
+        names->insert(entry->d_name);
+      }
+      closedir(handle);
+    }
+    listing.device = info.st_dev;
+    listing.inode = info.st_ino;
+    listing.mtime = info.st_mtim;
+    listing.names = std::move(names);
+  }
+  return listing.names;
+}
+
+// Most libraries live in the same handful of directories; each one is
+// checked against the shared listings once per check.
+class DirectoryIndex {
+public:
+  bool Contains(const std::string &dir, const std::string &name) {
+    auto it = listings.find(dir);
+    if (it == listings.end()) {
+      it = listings.emplace(dir, ListDirectory(dir)).first;
+    }
+    return it->second != nullptr && it->second->count(name) != 0;
+  }
+
+private:
+  std::unordered_map<std::string, std::shared_ptr<const std::unordered_set<std::string>>>
+      listings;
+};
+
+class DependencyResolver {
+public:
+  DependencyResolver(const ElfObject &executable, const std::string &executablePath) {
+    if (const char *libraryPath = std::getenv("LD_LIBRARY_PATH")) {
+      AppendPathList(libraryPath, DirName(executablePath), library_path);
+    }
+    // DT_RPATH of the executable applies to the whole closure unless it also
+    // has DT_RUNPATH.
+    if (executable.runpath.empty()) {
+      AppendPathList(executable.rpath, DirName(executablePath), executable_rpath);
+    }
+    ReadLdSoConf("/etc/ld.so.conf", system_dirs, 0);
+    for (const char *dir : {"/lib64", "/usr/lib64", "/lib", "/usr/lib"}) {
+      system_dirs.push_back(dir);
+    }
+    machine = executable.machine;
+    elf_class = executable.elf_class;
+  }
+
+  // Returns the path ld.so would load for `name` when needed by `object`.
+  std::string Resolve(const std::string &name, const ElfObject &object,
+                      const std::string &objectPath) {
+    if (name.find('/') != std::string::npos) {
+      return Compatible(name) ? name : std::string();
+    }
+    std::vector<std::string> dirs;
+    if (object.runpath.empty()) {
+      AppendPathList(object.rpath, DirName(objectPath), dirs);
+      dirs.insert(dirs.end(), executable_rpath.begin(), executable_rpath.end());
+    }
+    dirs.insert(dirs.end(), library_path.begin(), library_path.end());
+    AppendPathList(object.runpath, DirName(objectPath), dirs);
+    dirs.insert(dirs.end(), system_dirs.begin(), system_dirs.end());
+
+    for (const std::string &dir : dirs) {
+      if (index.Contains(dir, name)) {
+        const std::string candidate = dir + "/" + name;
+        if (Compatible(candidate)) {
+          return candidate;
+        }
+      }
+    }
+    return std::string();
+  }
+
+private:
+  // ld.so skips libraries built for another class or machine, e.g. the
+  // 32-bit copies in multilib directories.
+  bool Compatible(const std::string &path) {
+    ElfObject header;
+    return ReadElfFile(path, header, true) && header.machine == machine &&
+           header.elf_class == elf_class;
+  }
+
+  std::vector<std::string> library_path;
+  std::vector<std::string> executable_rpath;
+  std::vector<std::string> system_dirs;
+  DirectoryIndex index;
+  uint16_t machine = 0;
+  unsigned char elf_class = 0;
+};
+
+std::string CacheKey(const struct stat &info) {
+  const char *libraryPath = std::getenv("LD_LIBRARY_PATH");
+  return std::string(kCacheVersion) + "\t" + std::to_string(info.st_dev) + "\t" +
+         std::to_string(info.st_ino) + "\t" + std::to_string(info.st_mtim.tv_sec) + "." +
+         std::to_string(info.st_mtim.tv_nsec) + "\t" + std::to_string(info.st_size) + "\t" +
+         (libraryPath != nullptr ? libraryPath : "");
+}
+
+wxString CachePath(const wxString &cache_dir) {
+  return wxFileName(cache_dir, wxT("elf-preflight.cache")).GetFullPath();
+}
+
+// A hit needs the same key and every library resolved last time to still
+// exist, so removing a library invalidates the cache too.
+bool ReadCachedResult(const wxString &cache_dir, const std::string &key,
+                      ElfDependencyReport &report) {
+  std::lock_guard<std::mutex> lock(gResultCacheMutex);
+  wxFFile file(CachePath(cache_dir), wxT("rb"));
+  wxString text;
+  if (!file.IsOpened() || !file.ReadAll(&text, wxConvUTF8)) {
+    return false;
+  }
+  const wxArrayString lines = wxSplit(text, '\n', '\0');
+  if (lines.IsEmpty() || lines[0].ToStdString(wxConvUTF8) != key) {
+    return false;
+  }
+  size_t libraries = 0;
+  for (size_t i = 1; i < lines.GetCount(); ++i) {
+    if (lines[i].empty()) {
+      continue;
+    }
+    if (access(lines[i].ToStdString(wxConvUTF8).c_str(), R_OK) != 0) {
+      return false;
+    }
+    ++libraries;
+  }
+  report.libraries_checked = libraries;
+  report.from_cache = true;
+  return true;
+}
+
+void WriteCachedResult(const wxString &cache_dir, const std::string &key,
+                       const std::vector<std::string> &libraries) {
+  std::lock_guard<std::mutex> lock(gResultCacheMutex);
+  if (!wxFileName::DirExists(cache_dir) &&
+      !wxFileName::Mkdir(cache_dir, wxS_DIR_DEFAULT, wxPATH_MKDIR_FULL)) {
+    return;
+  }
+  std::string text = key + "\n";
+  for (const std::string &library : libraries) {
+    text += library + "\n";
+  }
+  wxFFile file(CachePath(cache_dir), wxT("wb"));
+  if (file.IsOpened()) {
+    file.Write(text.data(), text.size());
+  }
+}
+
+} // namespace
+
+bool CheckElfDependencies(const wxString &binary, const wxString &cache_dir,
+                          ElfDependencyReport &report, wxString &error) {
+  error.clear();
+  report = ElfDependencyReport();
+  const std::string path = binary.ToStdString(wxConvUTF8);
+  struct stat info {};
+  if (stat(path.c_str(), &info) != 0) {
+    error = wxString::Format(wxT("Cannot inspect %s: %s"), binary,
+                             wxString::FromUTF8(std::strerror(errno)));
+    return false;
+  }
+  const std::string key = CacheKey(info);
+  if (!cache_dir.empty() && ReadCachedResult(cache_dir, key, report)) {
+    return true;
+  }
+
+  ElfObject executable;
+  if (!ReadElfFile(path, executable, false)) {
+    error = wxString::Format(wxT("Not a supported ELF executable: %s"), binary);
+    return false;
+  }
+  ElfObject self;
+  if (ReadElfFile("/proc/self/exe", self, true) &&
+      (self.machine != executable.machine || self.elf_class != executable.elf_class)) {
+    report.missing_libraries.Add(
+        wxString::Format(wxT("%s is built for a different CPU architecture"),
+                         wxString::FromUTF8(BaseName(path))));
+    return true;
+  }
+
+  DependencyResolver resolver(executable, path);
+  // Soname to path, and path to parsed object, for the whole closure.
+  std::unordered_map<std::string, std::string> resolved;
+  std::unordered_map<std::string, std::shared_ptr<ElfObject>> parsed;
+  std::vector<std::string> libraries;
+  std::deque<std::pair<std::string, std::shared_ptr<ElfObject>>> pending;
+  pending.emplace_back(path, std::make_shared<ElfObject>(std::move(executable)));
+  std::unordered_set<std::string> reportedMissing;
+
+  while (!pending.empty()) {
+    const std::string objectPath = pending.front().first;
+    const std::shared_ptr<ElfObject> object = pending.front().second;
+    pending.pop_front();
+    const wxString objectName = wxString::FromUTF8(BaseName(objectPath));
+
+    for (const std::string &name : object->needed) {
+      if (resolved.count(name) != 0) {
+        continue;
+      }
+      const std::string library = resolver.Resolve(name, *object, objectPath);
+      if (library.empty()) {
+        if (reportedMissing.insert(name).second) {
+          report.missing_libraries.Add(wxString::Format(
+              wxT("%s (needed by %s)"), wxString::FromUTF8(name), objectName));
+        }
+        continue;
+      }
+      resolved.emplace(name, library);
+      libraries.push_back(library);
+      auto dependency = std::make_shared<ElfObject>();
+      if (ReadElfFile(library, *dependency, false)) {
+        parsed.emplace(library, dependency);
+        pending.emplace_back(library, dependency);
+      }
+    }
+
+    for (const VersionNeed &need : object->version_needs) {
+      const auto library = resolved.find(need.library);
+      if (library == resolved.end()) {
+        continue;
+      }
+      const auto provider = parsed.find(library->second);
+      if (provider == parsed.end()) {
+        continue;
+      }
+      for (const std::string &version : need.versions) {
+        if (provider->second->version_defs.count(version) == 0) {
+          report.missing_versions.Add(wxString::Format(
+              wxT("%s from %s (needed by %s)"), wxString::FromUTF8(version),
+              wxString::FromUTF8(need.library), objectName));
+        }
+      }
+    }
+  }
+
+  report.libraries_checked = libraries.size();
+  if (report.IsOk() && !cache_dir.empty()) {
+    WriteCachedResult(cache_dir, key, libraries);
+  }
+  return true;
+}
+
+#else
+
+bool CheckElfDependencies(const wxString &, const wxString &, ElfDependencyReport &report,
+                          wxString &error) {
+  error.clear();
+  report = ElfDependencyReport();
+  return true;
+}
+
+#endif
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstddef>
+#include <wx/arrstr.h>
+#include <wx/string.h>
+
+struct ElfDependencyReport {
+  // "libvulkan.so.1 (needed by Gothic2Notr)"
+  wxArrayString missing_libraries;
+  // "GLIBCXX_3.4.32 from libstdc++.so.6 (needed by Gothic2Notr)"
+  wxArrayString missing_versions;
+  size_t libraries_checked = 0;
+  bool from_cache = false;
+
+  bool IsOk() const { return missing_libraries.IsEmpty() && missing_versions.IsEmpty(); }
+};
+
+// Resolves the DT_NEEDED closure of `binary` the way ld.so would (RPATH,
+// LD_LIBRARY_PATH, RUNPATH, ld.so.conf, default directories) without
+// running it or ldd, and checks the symbol versions it requires. Clean
+// results are cached in `cache_dir`, keyed by the binary's device, inode,
+// mtime and size; directory listings are kept for the process until the
+// directory changes. Safe to call from any thread. Returns false when
+// `binary` cannot be inspected (not an ELF file, unreadable); the report is
+// only meaningful on success. Linux only; elsewhere it reports success
+// without checking.
+bool CheckElfDependencies(const wxString &binary, const wxString &cache_dir,
+                          ElfDependencyReport &report, wxString &error);
@@ -2,4 +2,9 @@
 
 #include <wx/string.h>
 
+// Starts extracting the embedded catalogs on the task scheduler, so the first
+// GetBundledLocaleRoot() call only waits for whatever is left.
+void PrefetchBundledLocales();
+// Extracts the embedded catalogs into the user cache once and returns their
+// root; empty with `error` set when that failed.
 wxString GetBundledLocaleRoot(wxString &error);
@@ -0,0 +1,220 @@
+#include "gothic_version.h"
+#include "path_index.h"
+#include "trace.h"
+
+#include <cstdint>
+#include <iterator>
+#include <wx/arrstr.h>
+#include <wx/fileconf.h>
+#include <wx/filename.h>
+#include <wx/log.h>
+
+namespace {
+
+constexpr GothicVersion kSelectableGothicVersions[] = {
+    GothicVersion::Gothic1,
+    GothicVersion::Gothic2Classic,
+    GothicVersion::Gothic2Notr,
+};
+
+bool DirectoryHasFileCaseInsensitive(const wxString &dirPath,
+                                     const wxString &fileName) {
+  wxString path;
+  return ResolvePathCaseInsensitive(dirPath, fileName, path);
+}
+
+wxString DescribeFileIdentity(const wxString &path) {
+  const wxFileName file(path);
+  return wxString::Format(wxT("%s:%llu-%lld"), file.GetFullName(),
+                          static_cast<unsigned long long>(file.GetSize().GetValue()),
+                          static_cast<long long>(file.GetModificationTime().GetTicks()));
+}
+
+bool ParseStoredVersion(const wxString &text, uint16_t (&version)[4]) {
+  const wxArrayString parts = wxSplit(text, '.', '\0');
+  if (parts.GetCount() != 4) {
+    return false;
+  }
+  for (size_t i = 0; i < 4; ++i) {
+    unsigned long value = 0;
+    if (!parts[i].ToULong(&value) || value > UINT16_MAX) {
+      return false;
+    }
+    version[i] = static_cast<uint16_t>(value);
+  }
+  return true;
+}
+
+// The install config remembers the version resource of the executable it was
+// read from; a patched or replaced executable changes size or mtime and is
+// read again.
+bool ReadCachedExecutableVersion(const wxString &configPath, const wxString &identity,
+                                 PeVersionInfo &version) {
+  if (!wxFileName::FileExists(configPath)) {
+    return false;
+  }
+  wxFileConfig cfg(wxEmptyString, wxEmptyString, configPath, wxEmptyString,
+                   wxCONFIG_USE_LOCAL_FILE);
+  wxString storedIdentity;
+  wxString fileVersion;
+  wxString productVersion;
+  if (!cfg.Read(wxT("EXECUTABLE/identity"), &storedIdentity) ||
+      storedIdentity != identity ||
+      !cfg.Read(wxT("EXECUTABLE/fileVersion"), &fileVersion) ||
+      !cfg.Read(wxT("EXECUTABLE/productVersion"), &productVersion) ||
+      !ParseStoredVersion(fileVersion, version.file_version) ||
+      !ParseStoredVersion(productVersion, version.product_version)) {
+    return false;
+  }
+  cfg.Read(wxT("EXECUTABLE/fileVersionText"), &version.file_version_text);
+  cfg.Read(wxT("EXECUTABLE/productName"), &version.product_name);
+  return true;
+}
+
+void WriteCachedExecutableVersion(const wxString &configPath, const wxString &identity,
+                                  const PeVersionInfo &version) {
+  wxFileConfig cfg(wxEmptyString, wxEmptyString, configPath, wxEmptyString,
+                   wxCONFIG_USE_LOCAL_FILE);
+  cfg.Write(wxT("EXECUTABLE/identity"), identity);
+  cfg.Write(wxT("EXECUTABLE/fileVersion"), FormatPeVersion(version.file_version));
+  cfg.Write(wxT("EXECUTABLE/productVersion"), FormatPeVersion(version.product_version));
+  cfg.Write(wxT("EXECUTABLE/fileVersionText"), version.file_version_text);
+  cfg.Write(wxT("EXECUTABLE/productName"), version.product_name);
+  if (!cfg.Flush()) {
+    wxLogDebug(wxT("Failed to cache executable version in %s"), configPath);
+  }
+}
+
+} // namespace
+
+bool GothicVersionFromIndex(int index, GothicVersion &version) {
+  if (index < 0 ||
+      index >= static_cast<int>(std::size(kSelectableGothicVersions))) {
+    return false;
+  }
+
+  version = kSelectableGothicVersions[index];
+  return true;
+}
+
+int GothicVersionToIndex(GothicVersion version) {
+  for (size_t i = 0; i < std::size(kSelectableGothicVersions); ++i) {
+    if (kSelectableGothicVersions[i] == version) {
+      return static_cast<int>(i);
+    }
+  }
+  return -1;
+}
+
+wxString GothicVersionLabel(GothicVersion version) {
+  switch (version) {
+  case GothicVersion::Unknown:
+    return wxT("Unknown");
+  case GothicVersion::Gothic1:
+    return wxT("Gothic 1");
+  case GothicVersion::Gothic2Classic:
+    return wxT("Gothic 2 Classic");
+  case GothicVersion::Gothic2Notr:
+    return wxT("Gothic 2 Night of the Raven");
+  default:
+    return wxT("Unknown");
+  }
+}
+
+bool ReadStoredGothicVersion(const RuntimePaths &paths, GothicVersion &version) {
+  const wxString configPath = GetInstallConfigPath(paths);
+  if (!wxFileName::FileExists(configPath)) {
+    return false;
+  }
+
+  wxFileConfig cfg(wxEmptyString, wxEmptyString, configPath, wxEmptyString,
+                   wxCONFIG_USE_LOCAL_FILE);
+  long value = -1;
+  return cfg.Read(wxT("GENERAL/gothicVersion"), &value) &&
+         GothicVersionFromIndex(static_cast<int>(value), version);
+}
+
+bool WriteStoredGothicVersion(const RuntimePaths &paths, GothicVersion version) {
+  const int selection = GothicVersionToIndex(version);
+  if (selection < 0) {
+    return false;
+  }
+
+  const wxString configPath = GetInstallConfigPath(paths);
+  wxFileConfig cfg(wxEmptyString, wxEmptyString, configPath, wxEmptyString,
+                   wxCONFIG_USE_LOCAL_FILE);
+  cfg.Write(wxT("GENERAL/gothicVersion"), static_cast<long>(selection));
+  return cfg.Flush();
+}
+
+GothicVersion DetectGothicVersion(const RuntimePaths &paths) {
+  TraceScope trace("DetectGothicVersion");
+  const wxString systemDir = paths.system_dir;
+
+  const wxString addonMarkers[] = {
+      wxT("Worlds_Addon.vdf"), wxT("Anims_Addon.vdf"), wxT("Meshes_Addon.vdf"),
+      wxT("Textures_Addon.vdf"), wxT("Sounds_Addon.vdf")};
+
+  for (const wxString &marker : addonMarkers) {
+    if (DirectoryHasFileCaseInsensitive(paths.gothic_root, wxT("Data/") + marker)) {
+      return GothicVersion::Gothic2Notr;
+    }
+  }
+
+  if (DirectoryHasFileCaseInsensitive(systemDir, wxT("Gothic2.exe"))) {
+    return GothicVersion::Gothic2Classic;
+  }
+
+  if (DirectoryHasFileCaseInsensitive(systemDir, wxT("GOTHIC.EXE")) ||
+      DirectoryHasFileCaseInsensitive(systemDir, wxT("GothicMod.exe"))) {
+    return GothicVersion::Gothic1;
+  }
+
+  return GothicVersion::Unknown;
+}
+
+bool DetectGothicExecutable(const RuntimePaths &paths, GothicVersion version,
+                            GothicExecutableInfo &info) {
+  TraceScope trace("DetectGothicExecutable");
+  info = GothicExecutableInfo();
+
+  const bool gothic2 = version == GothicVersion::Gothic2Classic ||
+                       version == GothicVersion::Gothic2Notr;
+  wxArrayString candidates;
+  if (version != GothicVersion::Gothic1) {
+    candidates.Add(wxT("Gothic2.exe"));
+  }
+  if (!gothic2) {
+    candidates.Add(wxT("GOTHIC.EXE"));
+    candidates.Add(wxT("GothicMod.exe"));
+  }
+  for (const wxString &name : candidates) {
+    if (ResolvePathCaseInsensitive(paths.system_dir, name, info.path)) {
+      break;
+    }
+  }
+  if (info.path.empty()) {
+    return false;
+  }
+
+  const wxString configPath = GetInstallConfigPath(paths);
+  const wxString identity = DescribeFileIdentity(info.path);
+  if (ReadCachedExecutableVersion(configPath, identity, info.version)) {
+    info.from_cache = true;
+    return true;
+  }
+  if (!ReadPeVersionInfo(info.path, info.version)) {
+    return false;
+  }
+  WriteCachedExecutableVersion(configPath, identity, info.version);
+  return true;
+}
+
+wxString DescribeGothicBuild(GothicVersion version, const GothicExecutableInfo &info) {
+  // The fixed numbers cannot carry patch letters such as the "k" in 1.08k, so
+  // prefer the version string when the executable has one.
+  const wxString number = info.version.file_version_text.empty()
+                              ? FormatPeVersion(info.version.file_version)
+                              : info.version.file_version_text;
+  return GothicVersionLabel(version) + wxT(" ") + number;
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include "pe_resources.h"
+#include "runtime_paths.h"
+
+#include <wx/string.h>
+
+enum class GothicVersion : int {
+  Unknown = -1,
+  Gothic1 = 0,
+  Gothic2Classic = 1,
+  Gothic2Notr = 2
+};
+
+bool GothicVersionFromIndex(int index, GothicVersion &version);
+int GothicVersionToIndex(GothicVersion version);
+wxString GothicVersionLabel(GothicVersion version);
+
+bool ReadStoredGothicVersion(const RuntimePaths &paths, GothicVersion &version);
+bool WriteStoredGothicVersion(const RuntimePaths &paths, GothicVersion version);
+GothicVersion DetectGothicVersion(const RuntimePaths &paths);
+
+struct GothicExecutableInfo {
+  wxString path;
+  PeVersionInfo version;
+  bool from_cache = false;
+};
+
+// Locates the original executable for `version` in the system directory
+// (Gothic2.exe, GOTHIC.EXE or GothicMod.exe, any case) and reads its version
+// resource. The result is cached in the install config, keyed by the
+// executable's name, size and mtime.
+bool DetectGothicExecutable(const RuntimePaths &paths, GothicVersion version,
+                            GothicExecutableInfo &info);
+// "Gothic 2 Night of the Raven 2.6.0.0"
+wxString DescribeGothicBuild(GothicVersion version, const GothicExecutableInfo &info);
@@ -0,0 +1,83 @@
+#include "icon_cache.h"
+
+#include "trace.h"
+
+namespace {
+
+std::string MakeKey(const IconCache::Key &key) {
+  std::string text = key.path.ToStdString(wxConvUTF8);
+  text += '\0';
+  text += std::to_string(key.identity.size);
+  text += ':';
+  text += std::to_string(key.identity.mtime_ms);
+  text += ':';
+  text += std::to_string(key.size);
+  return text;
+}
+
+} // namespace
+
+IconCache::IconCache(size_t budget_bytes) : budget(budget_bytes) {}
+
+bool IconCache::Find(const Key &key, wxIcon &icon) {
+  const auto found = index.find(MakeKey(key));
+  if (found == index.end()) {
+    ++stats.misses;
+    return false;
+  }
+  ++stats.hits;
+  lru.splice(lru.begin(), lru, found->second);
+  icon = found->second->icon;
+  return true;
+}
+
+void IconCache::Insert(const Key &key, const wxIcon &icon) {
+  if (!icon.IsOk()) {
+    return;
+  }
+  std::string text = MakeKey(key);
+  const size_t bytes = static_cast<size_t>(icon.GetWidth()) *
+                       static_cast<size_t>(icon.GetHeight()) * 4;
+  const auto found = index.find(text);
+  if (found != index.end()) {
+    stats.bytes -= found->second->bytes;
+    lru.erase(found->second);
+    index.erase(found);
+  }
+  if (bytes > budget) {
+    return;
+  }
+
+  lru.push_front(Entry{text, icon, bytes});
+  index.emplace(std::move(text), lru.begin());
+  stats.bytes += bytes;
+  EvictToBudget();
+}
+
+void IconCache::SetBudget(size_t budget_bytes) {
+  budget = budget_bytes;
+  EvictToBudget();
+}
+
+IconCache::Stats IconCache::GetStats() const {
+  Stats current = stats;
+  current.entries = lru.size();
+  return current;
+}
+
+void IconCache::Clear() {
+  lru.clear();
+  index.clear();
+  stats.bytes = 0;
+}
+
+void IconCache::EvictToBudget() {
+  while (stats.bytes > budget && !lru.empty()) {
+    const Entry &oldest = lru.back();
+    stats.bytes -= oldest.bytes;
+    index.erase(oldest.key);
+    lru.pop_back();
+    ++stats.evictions;
+  }
+  RecordTraceCounter("IconCache", "bytes", static_cast<int64_t>(stats.bytes));
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include "mod_table.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <wx/icon.h>
+#include <wx/string.h>
+
+// Decoded mod icons by resolved path, file identity and edge length, kept for
+// the whole process so repopulating the list reuses them without decoding or
+// touching the disk. A changed file has a new identity and misses. Entries are
+// evicted least recently used first once their pixel bytes exceed the
+// budget. UI thread only: wxIcon is not thread-safe. One instance lives on the
+// application object.
+class IconCache {
+public:
+  // About 4000 icons at 32x32.
+  static constexpr size_t kDefaultBudget = 16 * 1024 * 1024;
+
+  struct Key {
+    wxString path;
+    FileIdentity identity;
+    int size = 0;
+  };
+
+  struct Stats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t evictions = 0;
+    size_t entries = 0;
+    size_t bytes = 0;
+  };
+
+  explicit IconCache(size_t budget_bytes = kDefaultBudget);
+
+  // Counts a hit or a miss; a hit becomes the most recently used entry.
+  bool Find(const Key &key, wxIcon &icon);
+  void Insert(const Key &key, const wxIcon &icon);
+  // Evicts immediately when the new budget is smaller.
+  void SetBudget(size_t budget_bytes);
+  Stats GetStats() const;
+  // Drops every entry; the counters are kept.
+  void Clear();
+
+private:
+  struct Entry {
+    std::string key;
+    wxIcon icon;
+    size_t bytes;
+  };
+
+  void EvictToBudget();
+
+  size_t budget;
+  std::list<Entry> lru;
+  std::unordered_map<std::string, std::list<Entry>::iterator> index;
+  Stats stats;
+};
@@ -0,0 +1,401 @@
+#include "image_resample.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <vector>
+
+// x86 kernels need SSE2 as the baseline; AVX2 is detected at runtime.
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define OGS_RESAMPLE_SSE2 1
+#define OGS_RESAMPLE_AVX2 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#if defined(__GNUC__) || defined(__clang__)
+#define OGS_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define OGS_TARGET_AVX2
+#endif
+#elif defined(__ARM_NEON) || defined(__aarch64__) || defined(_M_ARM64)
+#define OGS_RESAMPLE_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace {
+
+// Source pixels under each target pixel along one axis: `count[i]` taps from
+// `first[i]`, with their weights at `weights[i * stride]`.
+struct BoxTaps {
+  std::vector<int> first;
+  std::vector<int> count;
+  std::vector<float> weights;
+  size_t stride = 0;
+};
+
+BoxTaps ComputeBoxTaps(int sourceSize, int targetSize) {
+  BoxTaps taps;
+  const double scale = static_cast<double>(sourceSize) / static_cast<double>(targetSize);
+  // A span of `scale` pixels overlaps at most ceil(scale) + 1 of them.
+  taps.stride = static_cast<size_t>(std::ceil(scale)) + 1;
+  taps.first.resize(static_cast<size_t>(targetSize));
+  taps.count.resize(static_cast<size_t>(targetSize));
+  taps.weights.assign(static_cast<size_t>(targetSize) * taps.stride, 0.0f);
+
+  for (int i = 0; i < targetSize; ++i) {
+    const double begin = static_cast<double>(i) * scale;
+    const double end = std::min(static_cast<double>(i + 1) * scale,
+                                static_cast<double>(sourceSize));
+    const int last = std::min(static_cast<int>(std::ceil(end)), sourceSize);
+    float *weights = &taps.weights[static_cast<size_t>(i) * taps.stride];
+    int first = static_cast<int>(std::floor(begin));
+    size_t count = 0;
+    double total = 0.0;
+    for (int pixel = first; pixel < last && count < taps.stride; ++pixel) {
+      const double coverage =
+          std::min(end, pixel + 1.0) - std::max(begin, static_cast<double>(pixel));
+      if (coverage <= 1e-9) {
+        // Rounding left a sliver of the previous pixel.
+        if (count == 0) {
+          first = pixel + 1;
+        }
+        continue;
+      }
+      weights[count++] = static_cast<float>(coverage);
+      total += coverage;
+    }
+    for (size_t k = 0; k < count; ++k) {
+      weights[k] = static_cast<float>(static_cast<double>(weights[k]) / total);
+    }
+    taps.first[static_cast<size_t>(i)] = first;
+    taps.count[static_cast<size_t>(i)] = static_cast<int>(count);
+  }
+  return taps;
+}
+
+constexpr float kInverse255 = 1.0f / 255.0f;
+
+// Both passes work on rows of premultiplied RGBA floats in 0..255.
+struct KernelOps {
+  // Converts one source row; `alpha` is null for opaque images.
+  void (*load)(const uint8_t *rgb, const uint8_t *alpha, int width, float *row);
+  // Resamples one row to the width described by `taps`.
+  void (*horizontal)(const float *source, const BoxTaps &taps, float *target);
+  // sum[i] += weight * row[i].
+  void (*accumulate)(float *sum, const float *row, float weight, size_t count);
+};
+
+void LoadScalar(const uint8_t *rgb, const uint8_t *alpha, int width, float *row) {
+  for (int x = 0; x < width; ++x, rgb += 3, row += 4) {
+    const float a = alpha != nullptr ? static_cast<float>(alpha[x]) : 255.0f;
+    const float scale = a * kInverse255;
+    row[0] = static_cast<float>(rgb[0]) * scale;
+    row[1] = static_cast<float>(rgb[1]) * scale;
+    row[2] = static_cast<float>(rgb[2]) * scale;
+    row[3] = a;
+  }
+}
+
+void HorizontalScalar(const float *source, const BoxTaps &taps, float *target) {
+  for (size_t x = 0; x < taps.first.size(); ++x) {
+    const float *pixel = source + static_cast<size_t>(taps.first[x]) * 4;
+    const float *weights = &taps.weights[x * taps.stride];
+    float sum[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+    for (int k = 0; k < taps.count[x]; ++k, pixel += 4) {
+      for (int channel = 0; channel < 4; ++channel) {
+        sum[channel] += weights[k] * pixel[channel];
+      }
+    }
+    std::memcpy(target + x * 4, sum, sizeof(sum));
+  }
+}
+
+void AccumulateScalar(float *sum, const float *row, float weight, size_t count) {
+  for (size_t i = 0; i < count; ++i) {
+    sum[i] += weight * row[i];
+  }
+}
+
+#if defined(OGS_RESAMPLE_SSE2)
+// Widens one pixel to four lanes and scales RGB by alpha in a single multiply.
+// Also used by the AVX2 kernel, which has nothing wider to offer here.
+void LoadSse2(const uint8_t *rgb, const uint8_t *alpha, int width, float *row) {
+  const __m128i zero = _mm_setzero_si128();
+  for (int x = 0; x < width; ++x, rgb += 3, row += 4) {
+    const uint32_t a = alpha != nullptr ? alpha[x] : 255u;
+    const uint32_t packed = static_cast<uint32_t>(rgb[0]) |
+                            static_cast<uint32_t>(rgb[1]) << 8 |
+                            static_cast<uint32_t>(rgb[2]) << 16 | a << 24;
+    const __m128i pixel = _mm_unpacklo_epi16(
+        _mm_unpacklo_epi8(_mm_cvtsi32_si128(static_cast<int>(packed)), zero), zero);
+    const float scale = static_cast<float>(a) * kInverse255;
+    _mm_storeu_ps(row,
+                  _mm_mul_ps(_mm_cvtepi32_ps(pixel), _mm_set_ps(1.0f, scale, scale, scale)));
+  }
+}
+
+void HorizontalSse2(const float *source, const BoxTaps &taps, float *target) {
+  for (size_t x = 0; x < taps.first.size(); ++x) {
+    const float *pixel = source + static_cast<size_t>(taps.first[x]) * 4;
+    const float *weights = &taps.weights[x * taps.stride];
+    __m128 sum = _mm_setzero_ps();
+    for (int k = 0; k < taps.count[x]; ++k, pixel += 4) {
+      sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(weights[k]), _mm_loadu_ps(pixel)));
+    }
+    _mm_storeu_ps(target + x * 4, sum);
+  }
+}
+
+void AccumulateSse2(float *sum, const float *row, float weight, size_t count) {
+  const __m128 scale = _mm_set1_ps(weight);
+  size_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    _mm_storeu_ps(sum + i,
+                  _mm_add_ps(_mm_loadu_ps(sum + i), _mm_mul_ps(scale, _mm_loadu_ps(row + i))));
+  }
+  AccumulateScalar(sum + i, row + i, weight, count - i);
+}
+#endif
+
+#if defined(OGS_RESAMPLE_AVX2)
+// Two source pixels per 256-bit multiply; the halves are folded at the end.
+OGS_TARGET_AVX2 void HorizontalAvx2(const float *source, const BoxTaps &taps,
+                                    float *target) {
+  for (size_t x = 0; x < taps.first.size(); ++x) {
+    const float *pixel = source + static_cast<size_t>(taps.first[x]) * 4;
+    const float *weights = &taps.weights[x * taps.stride];
+    const int count = taps.count[x];
+    __m256 pairs = _mm256_setzero_ps();
+    int k = 0;
+    for (; k + 2 <= count; k += 2, pixel += 8) {
+      const __m256 scale = _mm256_insertf128_ps(
+          _mm256_castps128_ps256(_mm_set1_ps(weights[k])), _mm_set1_ps(weights[k + 1]), 1);
+      pairs = _mm256_add_ps(pairs, _mm256_mul_ps(scale, _mm256_loadu_ps(pixel)));
+    }
+    __m128 sum =
+        _mm_add_ps(_mm256_castps256_ps128(pairs), _mm256_extractf128_ps(pairs, 1));
+    if (k < count) {
+      sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(weights[k]), _mm_loadu_ps(pixel)));
+    }
+    _mm_storeu_ps(target + x * 4, sum);
+  }
+}
+
+OGS_TARGET_AVX2 void AccumulateAvx2(float *sum, const float *row, float weight,
+                                    size_t count) {
+  const __m256 scale = _mm256_set1_ps(weight);
+  size_t i = 0;
+  for (; i + 8 <= count; i += 8) {
+    _mm256_storeu_ps(sum + i, _mm256_add_ps(_mm256_loadu_ps(sum + i),
+                                            _mm256_mul_ps(scale, _mm256_loadu_ps(row + i))));
+  }
+  AccumulateScalar(sum + i, row + i, weight, count - i);
+}
+
+bool CpuHasAvx2() {
+#if defined(_MSC_VER) && !defined(__clang__)
+  int info[4];
+  __cpuid(info, 0);
+  if (info[0] < 7) {
+    return false;
+  }
+  __cpuid(info, 1);
+  // AVX state must also be enabled by the OS (OSXSAVE and XCR0 bits 1-2).
+  const bool osAvx = (info[2] & (1 << 27)) != 0 && (info[2] & (1 << 28)) != 0 &&
+                     (_xgetbv(0) & 6) == 6;
+  if (!osAvx) {
+    return false;
+  }
+  __cpuidex(info, 7, 0);
+  return (info[1] & (1 << 5)) != 0;
+#else
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("avx2") != 0;
+#endif
+}
+#endif
+
+#if defined(OGS_RESAMPLE_NEON)
+void LoadNeon(const uint8_t *rgb, const uint8_t *alpha, int width, float *row) {
+  int x = 0;
+  // Eight pixels at a time: de-interleave RGB, widen to float, premultiply
+  // and store interleaved as RGBA.
+  for (; x + 8 <= width; x += 8, rgb += 24, row += 32) {
+    const uint8x8x3_t channels = vld3_u8(rgb);
+    const uint16x8_t wide[4] = {
+        vmovl_u8(channels.val[0]), vmovl_u8(channels.val[1]), vmovl_u8(channels.val[2]),
+        alpha != nullptr ? vmovl_u8(vld1_u8(alpha + x)) : vdupq_n_u16(255)};
+    for (int half = 0; half < 2; ++half) {
+      float32x4x4_t pixels;
+      for (int channel = 0; channel < 4; ++channel) {
+        const uint16x4_t part =
+            half == 0 ? vget_low_u16(wide[channel]) : vget_high_u16(wide[channel]);
+        pixels.val[channel] = vcvtq_f32_u32(vmovl_u16(part));
+      }
+      const float32x4_t scale = vmulq_n_f32(pixels.val[3], kInverse255);
+      for (int channel = 0; channel < 3; ++channel) {
+        pixels.val[channel] = vmulq_f32(pixels.val[channel], scale);
+      }
+      vst4q_f32(row + half * 16, pixels);
+    }
+  }
+  LoadScalar(rgb, alpha != nullptr ? alpha + x : nullptr, width - x, row);
+}
+
+void HorizontalNeon(const float *source, const BoxTaps &taps, float *target) {
+  for (size_t x = 0; x < taps.first.size(); ++x) {
+    const float *pixel = source + static_cast<size_t>(taps.first[x]) * 4;
+    const float *weights = &taps.weights[x * taps.stride];
+    float32x4_t sum = vdupq_n_f32(0.0f);
+    for (int k = 0; k < taps.count[x]; ++k, pixel += 4) {
+      sum = vmlaq_n_f32(sum, vld1q_f32(pixel), weights[k]);
+    }
+    vst1q_f32(target + x * 4, sum);
+  }
+}
+
+void AccumulateNeon(float *sum, const float *row, float weight, size_t count) {
+  size_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    vst1q_f32(sum + i, vmlaq_n_f32(vld1q_f32(sum + i), vld1q_f32(row + i), weight));
+  }
+  AccumulateScalar(sum + i, row + i, weight, count - i);
+}
+#endif
+
+const KernelOps *FindKernelOps(ResampleKernel kernel) {
+  static const KernelOps kScalarOps{LoadScalar, HorizontalScalar, AccumulateScalar};
+#if defined(OGS_RESAMPLE_SSE2)
+  static const KernelOps kSse2Ops{LoadSse2, HorizontalSse2, AccumulateSse2};
+#endif
+#if defined(OGS_RESAMPLE_AVX2)
+  static const KernelOps kAvx2Ops{LoadSse2, HorizontalAvx2, AccumulateAvx2};
+  static const bool hasAvx2 = CpuHasAvx2();
+#endif
+#if defined(OGS_RESAMPLE_NEON)
+  static const KernelOps kNeonOps{LoadNeon, HorizontalNeon, AccumulateNeon};
+#endif
+
+  switch (kernel) {
+  case ResampleKernel::Scalar:
+    return &kScalarOps;
+#if defined(OGS_RESAMPLE_SSE2)
+  case ResampleKernel::Sse2:
+    return &kSse2Ops;
+#endif
+#if defined(OGS_RESAMPLE_AVX2)
+  case ResampleKernel::Avx2:
+    return hasAvx2 ? &kAvx2Ops : nullptr;
+#endif
+#if defined(OGS_RESAMPLE_NEON)
+  case ResampleKernel::Neon:
+    return &kNeonOps;
+#endif
+  default:
+    return nullptr;
+  }
+}
+
+uint8_t ToByte(float value) {
+  return static_cast<uint8_t>(std::min(std::max(value, 0.0f), 255.0f) + 0.5f);
+}
+
+void StoreRow(const float *row, const ImageView &target, int y) {
+  const size_t offset = static_cast<size_t>(y) * static_cast<size_t>(target.width);
+  uint8_t *rgb = target.rgb + offset * 3;
+  uint8_t *alpha = target.alpha != nullptr ? target.alpha + offset : nullptr;
+  for (int x = 0; x < target.width; ++x, rgb += 3, row += 4) {
+    // Fully transparent pixels have no color left to recover.
+    const float unpremultiply = row[3] > 0.5f ? 255.0f / row[3] : 0.0f;
+    rgb[0] = ToByte(row[0] * unpremultiply);
+    rgb[1] = ToByte(row[1] * unpremultiply);
+    rgb[2] = ToByte(row[2] * unpremultiply);
+    if (alpha != nullptr) {
+      alpha[x] = ToByte(row[3]);
+    }
+  }
+}
+
+} // namespace
+
+bool ResampleBox(const ConstImageView &source, const ImageView &target,
+                 ResampleKernel kernel) {
+  if (source.rgb == nullptr || target.rgb == nullptr || source.width <= 0 ||
+      source.height <= 0 || target.width <= 0 || target.height <= 0) {
+    return false;
+  }
+  const KernelOps *ops =
+      FindKernelOps(kernel == ResampleKernel::Auto ? DetectResampleKernel() : kernel);
+  if (ops == nullptr) {
+    return false;
+  }
+
+  const BoxTaps columns = ComputeBoxTaps(source.width, target.width);
+  const BoxTaps rows = ComputeBoxTaps(source.height, target.height);
+  const size_t rowFloats = static_cast<size_t>(target.width) * 4;
+
+  // Horizontally resampled source rows. Target rows walk the source top to
+  // bottom and neighbours share at most their boundary rows, so a ring one
+  // larger than the widest tap keeps every row needed again.
+  const size_t slots = rows.stride + 1;
+  std::vector<float> ring(slots * rowFloats);
+  std::vector<int> ringRows(slots, -1);
+  std::vector<float> sourceRow(static_cast<size_t>(source.width) * 4);
+  std::vector<float> sum(rowFloats);
+
+  for (int y = 0; y < target.height; ++y) {
+    std::fill(sum.begin(), sum.end(), 0.0f);
+    const size_t tapBase = static_cast<size_t>(y) * rows.stride;
+    const int first = rows.first[static_cast<size_t>(y)];
+    for (int k = 0; k < rows.count[static_cast<size_t>(y)]; ++k) {
+      const int sourceY = first + k;
+      const size_t slot = static_cast<size_t>(sourceY) % slots;
+      float *resampled = &ring[slot * rowFloats];
+      if (ringRows[slot] != sourceY) {
+        const size_t offset =
+            static_cast<size_t>(sourceY) * static_cast<size_t>(source.width);
+        ops->load(source.rgb + offset * 3,
+                  source.alpha != nullptr ? source.alpha + offset : nullptr, source.width,
+                  sourceRow.data());
+        ops->horizontal(sourceRow.data(), columns, resampled);
+        ringRows[slot] = sourceY;
+      }
+      ops->accumulate(sum.data(), resampled, rows.weights[tapBase + static_cast<size_t>(k)],
+                      rowFloats);
+    }
+    StoreRow(sum.data(), target, y);
+  }
+  return true;
+}
+
+ResampleKernel DetectResampleKernel() {
+  for (ResampleKernel kernel :
+       {ResampleKernel::Avx2, ResampleKernel::Sse2, ResampleKernel::Neon}) {
+    if (IsResampleKernelAvailable(kernel)) {
+      return kernel;
+    }
+  }
+  return ResampleKernel::Scalar;
+}
+
+bool IsResampleKernelAvailable(ResampleKernel kernel) {
+  return kernel == ResampleKernel::Auto || FindKernelOps(kernel) != nullptr;
+}
+
+const char *ResampleKernelName(ResampleKernel kernel) {
+  switch (kernel) {
+  case ResampleKernel::Auto:
+    return ResampleKernelName(DetectResampleKernel());
+  case ResampleKernel::Scalar:
+    return "scalar";
+  case ResampleKernel::Sse2:
+    return "sse2";
+  case ResampleKernel::Avx2:
+    return "avx2";
+  case ResampleKernel::Neon:
+    return "neon";
+  }
+  return "unknown";
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstdint>
+
+// 8-bit RGB pixels with an optional separate alpha plane, the layout wxImage
+// uses, so images are resampled without repacking.
+struct ConstImageView {
+  const uint8_t *rgb = nullptr;
+  // Null when the image is opaque.
+  const uint8_t *alpha = nullptr;
+  int width = 0;
+  int height = 0;
+};
+
+struct ImageView {
+  uint8_t *rgb = nullptr;
+  // Null to drop the alpha channel.
+  uint8_t *alpha = nullptr;
+  int width = 0;
+  int height = 0;
+};
+
+enum class ResampleKernel { Auto, Scalar, Sse2, Avx2, Neon };
+
+// Area-averaging (box) resampler. Each target pixel is the coverage-weighted
+// mean of the source pixels under it, computed on premultiplied alpha so
+// transparent pixels do not bleed their color into the edges. Both passes
+// run on the widest SIMD kernel the CPU supports; `Auto` picks it at runtime
+// and any other value forces that kernel if it is available. Returns false on
+// empty images or an unavailable kernel.
+bool ResampleBox(const ConstImageView &source, const ImageView &target,
+                 ResampleKernel kernel = ResampleKernel::Auto);
+
+// The kernel `Auto` resolves to on this CPU.
+ResampleKernel DetectResampleKernel();
+bool IsResampleKernelAvailable(ResampleKernel kernel);
+const char *ResampleKernelName(ResampleKernel kernel);
@@ -0,0 +1,27 @@
+#include "image_scale.h"
+
+#include "image_resample.h"
+
+wxImage ResampleImage(const wxImage &image, int width, int height) {
+  if (!image.IsOk() || (image.GetWidth() == width && image.GetHeight() == height)) {
+    return image;
+  }
+
+  wxImage source = image;
+  if (source.HasMask() && !source.HasAlpha()) {
+    source = image.Copy();
+    source.InitAlpha();
+  }
+
+  wxImage target(width, height, false);
+  if (source.HasAlpha()) {
+    target.SetAlpha();
+  }
+  const ConstImageView from{source.GetData(), source.HasAlpha() ? source.GetAlpha() : nullptr,
+                            source.GetWidth(), source.GetHeight()};
+  const ImageView to{target.GetData(), target.GetAlpha(), width, height};
+  if (!ResampleBox(from, to)) {
+    return image.Scale(width, height, wxIMAGE_QUALITY_HIGH);
+  }
+  return target;
+}
@@ -0,0 +1,9 @@
+#pragma once
+
+#include <wx/image.h>
+
+// `image` resized with ResampleBox(), so downscaled icons average the pixels
+// they cover instead of sampling one of them. A mask is turned into alpha
+// first so its key color does not bleed into the edges. Falls back to
+// wxImage::Scale() when the resampler rejects the image.
+wxImage ResampleImage(const wxImage &image, int width, int height);
@@ -0,0 +1,441 @@
+#include "instance_channel.h"
+#include "text_hash.h"
+
+#include <cstdint>
+#include <string>
+#include <wx/filename.h>
+#include <wx/stdpaths.h>
+#include <wx/utils.h>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/file.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+// Far more than any command line the launcher accepts.
+constexpr size_t kMaxMessageBytes = 64 * 1024;
+
+// One NUL-terminated UTF-8 string per argument.
+std::string EncodeArgs(const wxArrayString &args) {
+  std::string payload;
+  for (const wxString &arg : args) {
+    payload += arg.ToStdString(wxConvUTF8);
+    payload += '\0';
+  }
+  return payload;
+}
+
+wxArrayString DecodeArgs(const std::string &payload) {
+  wxArrayString args;
+  size_t begin = 0;
+  for (size_t end = payload.find('\0'); end != std::string::npos;
+       begin = end + 1, end = payload.find('\0', begin)) {
+    args.Add(wxString::FromUTF8(payload.data() + begin, end - begin));
+  }
+  return args;
+}
+
+#if defined(_WIN32)
+wxString LastErrorText() {
+  return wxString::Format(wxT("error %lu"), static_cast<unsigned long>(GetLastError()));
+}
+
+HANDLE OpenPipeClient(const std::wstring &name) {
+  HANDLE pipe =
+      CreateFileW(name.c_str(), GENERIC_WRITE, 0, nullptr, OPEN_EXISTING, 0, nullptr);
+  // The listener serves one client at a time; wait briefly for our turn.
+  if (pipe == INVALID_HANDLE_VALUE && GetLastError() == ERROR_PIPE_BUSY &&
+      WaitNamedPipeW(name.c_str(), 500)) {
+    pipe = CreateFileW(name.c_str(), GENERIC_WRITE, 0, nullptr, OPEN_EXISTING, 0, nullptr);
+  }
+  return pipe;
+}
+#else
+wxString LastErrorText() { return wxString::FromUTF8(std::strerror(errno)); }
+
+void SetCloseOnExec(int fd) {
+  const int flags = fcntl(fd, F_GETFD);
+  if (flags >= 0) {
+    fcntl(fd, F_SETFD, flags | FD_CLOEXEC);
+  }
+}
+
+int OpenSocket() {
+  const int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (fd >= 0) {
+    SetCloseOnExec(fd);
+#if defined(SO_NOSIGPIPE)
+    const int enabled = 1;
+    setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &enabled, sizeof(enabled));
+#endif
+  }
+  return fd;
+}
+
+bool MakeSocketAddress(const std::string &path, sockaddr_un &address, wxString &error) {
+  if (path.size() >= sizeof(address.sun_path)) {
+    error = wxString::Format(wxT("Instance socket path is too long: %s"),
+                             wxString::FromUTF8(path));
+    return false;
+  }
+  std::memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+  std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+  return true;
+}
+
+// The socket and its lock live in a directory only this user can enter, so
+// nobody else can take the name first. The directory is checked rather than
+// trusted: in a shared temp directory another user may have created it.
+bool EnsurePrivateDirectory(const std::string &socket_path, wxString &error) {
+  const std::string dir = socket_path.substr(0, socket_path.rfind('/'));
+  if (mkdir(dir.c_str(), 0700) != 0 && errno != EEXIST) {
+    error = wxString::Format(wxT("Failed to create %s: %s"), wxString::FromUTF8(dir),
+                             LastErrorText());
+    return false;
+  }
+  struct stat info;
+  if (lstat(dir.c_str(), &info) != 0) {
+    error = wxString::Format(wxT("Failed to inspect %s: %s"), wxString::FromUTF8(dir),
+                             LastErrorText());
+    return false;
+  }
+  if (!S_ISDIR(info.st_mode) || info.st_uid != geteuid() || (info.st_mode & 077) != 0) {
+    error = wxString::Format(wxT("%s is not a private directory of this user"),
+                             wxString::FromUTF8(dir));
+    return false;
+  }
+  return true;
+}
+
+bool PeerIsCurrentUser(int fd) {
+#if defined(__linux__)
+  ucred credentials{};
+  socklen_t size = sizeof(credentials);
+  return getsockopt(fd, SOL_SOCKET, SO_PEERCRED, &credentials, &size) == 0 &&
+         credentials.uid == geteuid();
+#else
+  uid_t uid = 0;
+  gid_t gid = 0;
+  return getpeereid(fd, &uid, &gid) == 0 && uid == geteuid();
+#endif
+}
+
+bool WriteAll(int fd, const char *data, size_t size) {
+#if defined(MSG_NOSIGNAL)
+  constexpr int kSendFlags = MSG_NOSIGNAL;
+#else
+  constexpr int kSendFlags = 0;
+#endif
+  while (size > 0) {
+    const ssize_t written = send(fd, data, size, kSendFlags);
+    if (written < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return false;
+    }
+    data += written;
+    size -= static_cast<size_t>(written);
+  }
+  return true;
+}
+
+// Reads until the sender closes its end. A client that stalls for a second
+// or sends too much is dropped.
+bool ReadMessage(int fd, std::string &payload) {
+  char buffer[4096];
+  pollfd client{fd, POLLIN, 0};
+  while (true) {
+    const int ready = poll(&client, 1, 1000);
+    if (ready < 0 && errno == EINTR) {
+      continue;
+    }
+    if (ready <= 0) {
+      return false;
+    }
+    const ssize_t received = recv(fd, buffer, sizeof(buffer), 0);
+    if (received < 0 && errno == EINTR) {
+      continue;
+    }
+    if (received <= 0) {
+      return received == 0;
+    }
+    payload.append(buffer, static_cast<size_t>(received));
+    if (payload.size() > kMaxMessageBytes) {
+      return false;
+    }
+  }
+}
+#endif
+
+} // namespace
+
+wxString GetInstanceChannelName(const wxString &executable) {
+  wxString key = wxFileName(executable).GetFullPath();
+#if defined(_WIN32)
+  key.MakeLower();
+#endif
+  key += wxT("\n") + wxGetUserId();
+
+  // Hashing keeps the name short enough for sockaddr_un.
+  const wxString id = wxString::Format(wxT("OpenGothicStarter-%016llx"),
+                                       static_cast<unsigned long long>(HashUtf8Fnv64(key)));
+#if defined(_WIN32)
+  return wxT("\\\\.\\pipe\\") + id;
+#else
+  // $XDG_RUNTIME_DIR is private to the user already; the shared temp
+  // directory gets a per-user subdirectory.
+  wxString dir;
+  if (wxGetEnv(wxT("XDG_RUNTIME_DIR"), &dir) && wxFileName(dir).IsAbsolute()) {
+    dir = wxFileName(dir, wxT("OpenGothicStarter")).GetFullPath();
+  } else {
+    dir = wxFileName(wxStandardPaths::Get().GetTempDir(),
+                     wxString::Format(wxT("OpenGothicStarter-%lu"),
+                                      static_cast<unsigned long>(geteuid())))
+              .GetFullPath();
+  }
+  return wxFileName(dir, id + wxT(".sock")).GetFullPath();
+#endif
+}
+
+bool ForwardToRunningInstance(const wxString &name, const wxArrayString &args,
+                              wxString &error) {
+  error.clear();
+  const std::string payload = EncodeArgs(args);
+#if defined(_WIN32)
+  HANDLE pipe = OpenPipeClient(name.ToStdWstring());
+  if (pipe == INVALID_HANDLE_VALUE) {
+    error = wxString::Format(wxT("No launcher is listening on %s (%s)"), name,
+                             LastErrorText());
+    return false;
+  }
+  DWORD written = 0;
+  const bool sent = WriteFile(pipe, payload.data(), static_cast<DWORD>(payload.size()),
+                               &written, nullptr) &&
+                     written == payload.size();
+  if (!sent) {
+    error = wxString::Format(wxT("Failed to forward to %s (%s)"), name, LastErrorText());
+  }
+  CloseHandle(pipe);
+  return sent;
+#else
+  const std::string path = name.ToStdString(wxConvUTF8);
+  sockaddr_un address;
+  if (!MakeSocketAddress(path, address, error) || !EnsurePrivateDirectory(path, error)) {
+    return false;
+  }
+  const int fd = OpenSocket();
+  if (fd < 0 ||
+      connect(fd, reinterpret_cast<const sockaddr *>(&address), sizeof(address)) != 0) {
+    error = wxString::Format(wxT("No launcher is listening on %s (%s)"), name,
+                             LastErrorText());
+    if (fd >= 0) {
+      close(fd);
+    }
+    return false;
+  }
+  if (!PeerIsCurrentUser(fd)) {
+    error = wxString::Format(wxT("%s is served by another user"), name);
+    close(fd);
+    return false;
+  }
+  const bool sent = WriteAll(fd, payload.data(), payload.size());
+  if (!sent) {
+    error = wxString::Format(wxT("Failed to forward to %s (%s)"), name, LastErrorText());
+  }
+  close(fd);
+  return sent;
+#endif
+}
+
+InstanceChannel::~InstanceChannel() { Stop(); }
+
+#if defined(_WIN32)
+
+bool InstanceChannel::Listen(const wxString &name, Handler handler, bool &already_running,
+                             wxString &error) {
+  Stop();
+  already_running = false;
+  error.clear();
+
+  // FILE_FLAG_FIRST_PIPE_INSTANCE makes ownership of the name exclusive; the
+  // one instance is reconnected for every client, so the name is never free
+  // while this process listens.
+  HANDLE handle = CreateNamedPipeW(
+      name.ToStdWstring().c_str(), PIPE_ACCESS_INBOUND | FILE_FLAG_FIRST_PIPE_INSTANCE,
+      PIPE_TYPE_BYTE | PIPE_READMODE_BYTE | PIPE_WAIT | PIPE_REJECT_REMOTE_CLIENTS, 1, 0,
+      static_cast<DWORD>(kMaxMessageBytes), 0, nullptr);
+  if (handle == INVALID_HANDLE_VALUE) {
+    already_running = GetLastError() == ERROR_ACCESS_DENIED;
+    error = already_running
+                ? wxString(wxT("Another launcher is already running."))
+                : wxString::Format(wxT("Failed to create %s (%s)"), name, LastErrorText());
+    return false;
+  }
+
+  pipe = handle;
+  endpoint = name;
+  on_message = std::move(handler);
+  stopping = false;
+  worker = std::thread(&InstanceChannel::Run, this);
+  return true;
+}
+
+void InstanceChannel::Stop() {
+  if (worker.joinable()) {
+    stopping = true;
+    // Wakes ConnectNamedPipe() with a connection of our own.
+    HANDLE wake = OpenPipeClient(endpoint.ToStdWstring());
+    if (wake != INVALID_HANDLE_VALUE) {
+      CloseHandle(wake);
+    }
+    worker.join();
+  }
+  if (pipe != nullptr) {
+    CloseHandle(static_cast<HANDLE>(pipe));
+    pipe = nullptr;
+  }
+}
+
+void InstanceChannel::Run() {
+  HANDLE handle = static_cast<HANDLE>(pipe);
+  while (!stopping) {
+    const bool connected =
+        ConnectNamedPipe(handle, nullptr) || GetLastError() == ERROR_PIPE_CONNECTED;
+    if (stopping) {
+      break;
+    }
+    std::string payload;
+    bool complete = false;
+    if (connected) {
+      char buffer[4096];
+      DWORD received = 0;
+      while (payload.size() <= kMaxMessageBytes) {
+        if (!ReadFile(handle, buffer, sizeof(buffer), &received, nullptr)) {
+          complete = GetLastError() == ERROR_BROKEN_PIPE;
+          break;
+        }
+        payload.append(buffer, received);
+      }
+    }
+    DisconnectNamedPipe(handle);
+    if (complete) {
+      on_message(DecodeArgs(payload));
+    }
+  }
+}
+
+#else
+
+bool InstanceChannel::Listen(const wxString &name, Handler handler, bool &already_running,
+                             wxString &error) {
+  Stop();
+  already_running = false;
+  error.clear();
+
+  const std::string path = name.ToStdString(wxConvUTF8);
+  sockaddr_un address;
+  if (!MakeSocketAddress(path, address, error) || !EnsurePrivateDirectory(path, error)) {
+    return false;
+  }
+
+  // The lock decides ownership. Whoever holds it may replace a socket file
+  // left behind by a crashed instance without racing another launch.
+  const std::string lockPath = path + ".lock";
+  lock_fd = open(lockPath.c_str(), O_RDWR | O_CREAT, 0600);
+  if (lock_fd < 0) {
+    error = wxString::Format(wxT("Failed to open %s: %s"), wxString::FromUTF8(lockPath),
+                             LastErrorText());
+    return false;
+  }
+  SetCloseOnExec(lock_fd);
+  if (flock(lock_fd, LOCK_EX | LOCK_NB) != 0) {
+    already_running = errno == EWOULDBLOCK;
+    error = already_running
+                ? wxString(wxT("Another launcher is already running."))
+                : wxString::Format(wxT("Failed to lock %s: %s"), wxString::FromUTF8(lockPath),
+                                   LastErrorText());
+    Stop();
+    return false;
+  }
+
+  unlink(path.c_str());
+  listen_fd = OpenSocket();
+  if (listen_fd < 0 ||
+      bind(listen_fd, reinterpret_cast<const sockaddr *>(&address), sizeof(address)) != 0 ||
+      listen(listen_fd, 8) != 0 || pipe(wake_fds) != 0) {
+    error = wxString::Format(wxT("Failed to listen on %s: %s"), name, LastErrorText());
+    unlink(path.c_str());
+    Stop();
+    return false;
+  }
+  SetCloseOnExec(wake_fds[0]);
+  SetCloseOnExec(wake_fds[1]);
+
+  endpoint = name;
+  on_message = std::move(handler);
+  stopping = false;
+  worker = std::thread(&InstanceChannel::Run, this);
+  return true;
+}
+
+void InstanceChannel::Stop() {
+  if (worker.joinable()) {
+    stopping = true;
+    const char wake = 0;
+    while (write(wake_fds[1], &wake, 1) < 0 && errno == EINTR) {
+    }
+    worker.join();
+    // Only removed while the lock is still held, so it is ours.
+    unlink(endpoint.ToStdString(wxConvUTF8).c_str());
+  }
+  for (int *fd : {&listen_fd, &wake_fds[0], &wake_fds[1], &lock_fd}) {
+    if (*fd >= 0) {
+      close(*fd);
+      *fd = -1;
+    }
+  }
+}
+
+void InstanceChannel::Run() {
+  pollfd fds[2] = {{listen_fd, POLLIN, 0}, {wake_fds[0], POLLIN, 0}};
+  while (!stopping) {
+    if (poll(fds, 2, -1) < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      break;
+    }
+    if (fds[1].revents != 0) {
+      break;
+    }
+    if ((fds[0].revents & POLLIN) == 0) {
+      continue;
+    }
+    const int client = accept(listen_fd, nullptr, nullptr);
+    if (client < 0) {
+      continue;
+    }
+    SetCloseOnExec(client);
+    std::string payload;
+    const bool complete = PeerIsCurrentUser(client) && ReadMessage(client, payload);
+    close(client);
+    if (complete) {
+      on_message(DecodeArgs(payload));
+    }
+  }
+}
+
+#endif
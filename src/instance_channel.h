@@ -0,0 +1,56 @@
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <thread>
+#include <wx/arrstr.h>
+#include <wx/string.h>
+
+// Endpoint shared by every launch of one launcher executable by the current
+// user: a Unix domain socket in a 0700 directory under $XDG_RUNTIME_DIR (or
+// the temp directory), a named pipe on Windows.
+wxString GetInstanceChannelName(const wxString &executable);
+
+// Hands `args` to the instance listening on `name`. Returns false without
+// waiting when nothing is listening, and without sending when the directory
+// or the listener belongs to another user.
+bool ForwardToRunningInstance(const wxString &name, const wxArrayString &args,
+                              wxString &error);
+
+// The receiving end. While listening, each forwarded command line is passed
+// to the handler on the channel's own thread. The endpoint is owned
+// exclusively, so of two launches racing for it exactly one listens.
+class InstanceChannel {
+public:
+  using Handler = std::function<void(const wxArrayString &args)>;
+
+  InstanceChannel() = default;
+  InstanceChannel(const InstanceChannel &) = delete;
+  InstanceChannel &operator=(const InstanceChannel &) = delete;
+  ~InstanceChannel();
+
+  // Fails when another instance owns `name` (`already_running` is then set)
+  // or the endpoint cannot be created. A socket left behind by a crashed
+  // instance is replaced.
+  bool Listen(const wxString &name, Handler handler, bool &already_running,
+              wxString &error);
+  void Stop();
+  bool IsListening() const { return worker.joinable(); }
+
+private:
+  void Run();
+
+  Handler on_message;
+  wxString endpoint;
+  std::thread worker;
+  std::atomic<bool> stopping{false};
+#if defined(_WIN32)
+  void *pipe = nullptr;
+#else
+  // flock()ed for as long as this instance owns the endpoint.
+  int lock_fd = -1;
+  int listen_fd = -1;
+  // Written by Stop() to wake the poll() in Run().
+  int wake_fds[2] = {-1, -1};
+#endif
+};
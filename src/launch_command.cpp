@@ -0,0 +1,110 @@
+#include "launch_command.h"
+
+#include <wx/dir.h>
+#include <wx/filename.h>
+#include <wx/translation.h>
+
+bool BuildLaunchCommand(const RuntimePaths &paths, const LaunchOptions &options,
+                        wxArrayString &command, wxString &error) {
+  command.clear();
+  error.clear();
+
+  command.Add(paths.open_gothic_executable);
+  command.Add(wxT("-g"));
+  command.Add(paths.gothic_root);
+
+  switch (options.version) {
+  case GothicVersion::Gothic1:
+    command.Add(wxT("-g1"));
+    break;
+  case GothicVersion::Gothic2Classic:
+    command.Add(wxT("-g2c"));
+    break;
+  case GothicVersion::Gothic2Notr:
+    command.Add(wxT("-g2"));
+    break;
+  case GothicVersion::Unknown:
+  default:
+    error = _("Stored Gothic version is invalid. Please restart and select a valid version.");
+    return false;
+  }
+
+  if (!options.mod_file.empty()) {
+    command.Add(wxT("-game:") + options.mod_file);
+  }
+
+  for (const LaunchToggle &toggle : kLaunchToggles) {
+    const bool enabled = options.*toggle.member;
+    if (toggle.explicit_value) {
+      command.Add(toggle.flag);
+      command.Add(enabled ? wxT("1") : wxT("0"));
+    } else if (enabled) {
+      command.Add(toggle.flag);
+    }
+  }
+
+  if (options.fxaa > 0) {
+    command.Add(wxT("-aa"));
+    command.Add(wxString::Format(wxT("%d"), options.fxaa));
+  }
+
+  return true;
+}
+
+wxString ResolveWorkingDirectory(const RuntimePaths &paths, const GameEntry *game) {
+  if (game != nullptr) {
+    return game->datadir;
+  }
+  return GetDefaultWorkingDirectory(paths);
+}
+
+bool EnsureWorkingDirectoryExists(const wxString &path, wxString &error) {
+  error.clear();
+  if (wxDir::Exists(path)) {
+    return true;
+  }
+
+  if (!wxFileName::Mkdir(path, wxS_DIR_DEFAULT, wxPATH_MKDIR_FULL)) {
+    error = wxString::Format(wxT("Failed to create working directory: %s"), path);
+    return false;
+  }
+
+  return true;
+}
+
+wxString RenderCommandForLog(const wxArrayString &command) {
+  wxString renderedCommand;
+  for (size_t i = 0; i < command.GetCount(); ++i) {
+    if (i > 0) {
+      renderedCommand += wxT(" ");
+    }
+
+    wxString escaped;
+    const wxString &arg = command[i];
+    escaped.reserve(arg.length() + 2);
+    for (wxUniChar ch : arg) {
+      if (ch == wxT('\\') || ch == wxT('"')) {
+        escaped += wxT('\\');
+      }
+      escaped += ch;
+    }
+
+    renderedCommand += wxString::Format(wxT("\"%s\""), escaped);
+  }
+  return renderedCommand;
+}
+
+wxString DescribeLaunchFlags(const wxArrayString &command) {
+  // Skip the executable and `-g <root>`; the mod is recorded separately.
+  wxString flags;
+  for (size_t i = 3; i < command.GetCount(); ++i) {
+    if (command[i].StartsWith(wxT("-game:"))) {
+      continue;
+    }
+    if (!flags.empty()) {
+      flags += wxT(" ");
+    }
+    flags += command[i];
+  }
+  return flags;
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include "gothic_version.h"
+#include "mod_discovery.h"
+#include "runtime_paths.h"
+
+#include <cstddef>
+#include <iterator>
+#include <wx/arrstr.h>
+#include <wx/string.h>
+#include <wx/translation.h>
+
+struct LaunchOptions {
+  GothicVersion version = GothicVersion::Unknown;
+  wxString mod_file;
+  bool window_mode = false;
+  bool marvin = false;
+  bool ray_tracing = false;
+  bool illumination = false;
+  bool meshlets = false;
+  bool vsm = false;
+  bool benchmark = false;
+  int fxaa = 0;
+};
+
+// One launcher checkbox: its key in the launcher config, its msgid, the
+// LaunchOptions member it fills and the OpenGothic flag it maps to. A new
+// engine toggle is one row here plus its LaunchOptions member.
+struct LaunchToggle {
+  const char *config_key;
+  const char *label;
+  bool LaunchOptions::*member;
+  const char *flag;
+  // Passed as `<flag> 0|1` every time instead of only when enabled.
+  bool explicit_value;
+};
+
+// In side-panel and argv order.
+inline constexpr LaunchToggle kLaunchToggles[] = {
+    {"PARAMS/windowMode", wxTRANSLATE("Window mode"), &LaunchOptions::window_mode,
+     "-window", false},
+    {"PARAMS/marvin", wxTRANSLATE("Marvin mode"), &LaunchOptions::marvin, "-devmode", false},
+    {"PARAMS/rayTracing", wxTRANSLATE("Ray tracing"), &LaunchOptions::ray_tracing, "-rt",
+     true},
+    {"PARAMS/illumination", wxTRANSLATE("Global illumination"),
+     &LaunchOptions::illumination, "-gi", true},
+    {"PARAMS/meshlets", wxTRANSLATE("Meshlets"), &LaunchOptions::meshlets, "-ms", true},
+    {"PARAMS/vsm", wxTRANSLATE("Virtual Shadowmap"), &LaunchOptions::vsm, "-vsm", true},
+    {"PARAMS/bench", wxTRANSLATE("Benchmark"), &LaunchOptions::benchmark, "-benchmark",
+     false},
+};
+
+inline constexpr size_t kLaunchToggleCount = std::size(kLaunchToggles);
+
+bool BuildLaunchCommand(const RuntimePaths &paths, const LaunchOptions &options,
+                        wxArrayString &command, wxString &error);
+wxString ResolveWorkingDirectory(const RuntimePaths &paths, const GameEntry *game);
+bool EnsureWorkingDirectoryExists(const wxString &path, wxString &error);
+wxString RenderCommandForLog(const wxArrayString &command);
+wxString DescribeLaunchFlags(const wxArrayString &command);
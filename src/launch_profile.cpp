@@ -0,0 +1,473 @@
+#include "launch_profile.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <string>
+#include <wx/config.h>
+
+#if defined(__linux__)
+#include <fcntl.h>
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+constexpr int kIoPriorityClassShift = 13;
+constexpr int kIoPriorityWhoProcess = 1;
+
+const char *IoClassName(IoPriorityClass ioClass) {
+  switch (ioClass) {
+  case IoPriorityClass::Realtime:
+    return "realtime";
+  case IoPriorityClass::BestEffort:
+    return "best-effort";
+  case IoPriorityClass::Idle:
+    return "idle";
+  case IoPriorityClass::Inherit:
+    break;
+  }
+  return "none";
+}
+
+// Reads `key` from the per-mod group first, then from [PROFILE].
+bool ReadProfileValue(const wxConfigBase &config, const wxString &mod,
+                      const wxString &key, wxString &value) {
+  if (!mod.empty() && config.Read(wxT("PROFILE/") + mod + wxT("/") + key, &value)) {
+    return true;
+  }
+  return config.Read(wxT("PROFILE/") + key, &value);
+}
+
+#if defined(__linux__)
+
+std::string ToUtf8(const wxString &text) { return text.ToStdString(wxConvUTF8); }
+
+wxString LastErrorText() { return wxString::FromUTF8(std::strerror(errno)); }
+
+bool ReadSmallFile(const std::string &path, std::string &contents) {
+  const int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return false;
+  }
+  char buffer[512];
+  const ssize_t read = ::read(fd, buffer, sizeof(buffer) - 1);
+  close(fd);
+  if (read < 0) {
+    return false;
+  }
+  contents.assign(buffer, static_cast<size_t>(read));
+  while (!contents.empty() && (contents.back() == '\n' || contents.back() == ' ')) {
+    contents.pop_back();
+  }
+  return true;
+}
+
+bool WriteSmallFile(const std::string &path, const std::string &contents) {
+  const int fd = open(path.c_str(), O_WRONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return false;
+  }
+  const ssize_t written = write(fd, contents.data(), contents.size());
+  const int savedErrno = errno;
+  close(fd);
+  errno = savedErrno;
+  return written == static_cast<ssize_t>(contents.size());
+}
+
+// cgroup v2 path of `pid` relative to the hierarchy root, e.g.
+// "/user.slice/user-1000.slice/user@1000.service/app.slice/foo.scope".
+bool ReadProcessCgroup(const std::string &pid, std::string &cgroup) {
+  std::string contents;
+  if (!ReadSmallFile("/proc/" + pid + "/cgroup", contents)) {
+    return false;
+  }
+  const size_t begin = contents.find("0::");
+  if (begin == std::string::npos) {
+    return false;
+  }
+  const size_t end = contents.find('\n', begin);
+  cgroup = contents.substr(begin + 3, end == std::string::npos ? end : end - begin - 3);
+  return !cgroup.empty();
+}
+
+bool ListsController(const std::string &list, const std::string &controller) {
+  size_t begin = 0;
+  while (begin < list.size()) {
+    size_t end = list.find(' ', begin);
+    if (end == std::string::npos) {
+      end = list.size();
+    }
+    if (list.compare(begin, end - begin, controller) == 0) {
+      return true;
+    }
+    begin = end + 1;
+  }
+  return false;
+}
+
+// Makes `controller` available to the children of `parent`, enabling it in
+// cgroup.subtree_control when the session has delegated it. Returns false
+// with a warning when a limit on it cannot take effect.
+bool EnableController(const std::string &parent, const std::string &controller,
+                      wxArrayString &warnings) {
+  std::string available;
+  std::string enabled;
+  if (!ReadSmallFile(parent + "/cgroup.controllers", available) ||
+      !ListsController(available, controller)) {
+    warnings.Add(wxString::Format(
+        wxT("The %s controller is not delegated to %s; its limit needs a delegated "
+            "slice."),
+        wxString::FromUTF8(controller), wxString::FromUTF8(parent)));
+    return false;
+  }
+  if (ReadSmallFile(parent + "/cgroup.subtree_control", enabled) &&
+      ListsController(enabled, controller)) {
+    return true;
+  }
+  if (!WriteSmallFile(parent + "/cgroup.subtree_control", "+" + controller)) {
+    warnings.Add(wxString::Format(wxT("Failed to enable the %s controller in %s: %s"),
+                                  wxString::FromUTF8(controller),
+                                  wxString::FromUTF8(parent), LastErrorText()));
+    return false;
+  }
+  return true;
+}
+
+#endif
+
+// A single new directory name. Anything else, such as "." or a dot-prefixed
+// interface file name, would make the limits land on an existing cgroup.
+bool IsValidCgroupName(const wxString &name) {
+  if (name.empty() || name.length() > 64) {
+    return false;
+  }
+  for (const wxUniChar ch : name) {
+    const bool allowed = (ch >= 'a' && ch <= 'z') || (ch >= 'A' && ch <= 'Z') ||
+                         (ch >= '0' && ch <= '9') || ch == '_' || ch == '-';
+    if (!allowed) {
+      return false;
+    }
+  }
+  return true;
+}
+
+} // namespace
+
+bool LaunchProfile::HasThreadLimits() const {
+  return !cpus.empty() || set_nice || io_class != IoPriorityClass::Inherit;
+}
+
+bool LaunchProfile::IsEmpty() const { return !HasThreadLimits() && cgroup.empty(); }
+
+bool ParseCpuList(const wxString &text, std::vector<int> &cpus) {
+  cpus.clear();
+  for (const wxString &token : wxSplit(text, ',', '\0')) {
+    const wxString range = token.Strip(wxString::both);
+    if (range.empty()) {
+      continue;
+    }
+    long first = 0;
+    long last = 0;
+    const wxString firstText = range.BeforeFirst('-');
+    const wxString lastText = range.Contains(wxT("-")) ? range.AfterFirst('-') : firstText;
+    if (!firstText.ToLong(&first) || !lastText.ToLong(&last) || first < 0 || last < first ||
+        last >= 1024) {
+      cpus.clear();
+      return false;
+    }
+    for (long cpu = first; cpu <= last; ++cpu) {
+      cpus.push_back(static_cast<int>(cpu));
+    }
+  }
+  std::sort(cpus.begin(), cpus.end());
+  cpus.erase(std::unique(cpus.begin(), cpus.end()), cpus.end());
+  return !cpus.empty();
+}
+
+bool ParseByteSize(const wxString &text, int64_t &bytes) {
+  wxString number = text.Strip(wxString::both).Upper();
+  int64_t multiplier = 1;
+  if (number.EndsWith(wxT("K"), &number)) {
+    multiplier = int64_t{1} << 10;
+  } else if (number.EndsWith(wxT("M"), &number)) {
+    multiplier = int64_t{1} << 20;
+  } else if (number.EndsWith(wxT("G"), &number)) {
+    multiplier = int64_t{1} << 30;
+  }
+  long long value = 0;
+  if (!number.ToLongLong(&value) || value <= 0 ||
+      value > INT64_MAX / multiplier) {
+    return false;
+  }
+  bytes = static_cast<int64_t>(value) * multiplier;
+  return true;
+}
+
+wxString FormatCpuList(const std::vector<int> &cpus) {
+  wxString text;
+  for (size_t i = 0; i < cpus.size();) {
+    size_t end = i;
+    while (end + 1 < cpus.size() && cpus[end + 1] == cpus[end] + 1) {
+      ++end;
+    }
+    if (!text.empty()) {
+      text += wxT(",");
+    }
+    text += end == i ? wxString::Format(wxT("%d"), cpus[i])
+                     : wxString::Format(wxT("%d-%d"), cpus[i], cpus[end]);
+    i = end + 1;
+  }
+  return text;
+}
+
+bool ReadLaunchProfile(const wxConfigBase &config, const wxString &mod,
+                       LaunchProfile &profile, wxString &error) {
+  error.clear();
+  profile = LaunchProfile();
+  wxString value;
+
+  if (ReadProfileValue(config, mod, wxT("affinity"), value) && !value.empty() &&
+      !ParseCpuList(value, profile.cpus)) {
+    error = wxString::Format(wxT("Invalid CPU affinity list in launch profile: %s"), value);
+    return false;
+  }
+
+  if (ReadProfileValue(config, mod, wxT("nice"), value) && !value.empty()) {
+    long nice = 0;
+    if (!value.ToLong(&nice) || nice < -20 || nice > 19) {
+      error = wxString::Format(wxT("Invalid nice level in launch profile: %s"), value);
+      return false;
+    }
+    profile.set_nice = true;
+    profile.nice = static_cast<int>(nice);
+  }
+
+  if (ReadProfileValue(config, mod, wxT("ioClass"), value) && !value.empty()) {
+    const wxString name = value.Lower();
+    if (name == wxT("realtime")) {
+      profile.io_class = IoPriorityClass::Realtime;
+    } else if (name == wxT("best-effort")) {
+      profile.io_class = IoPriorityClass::BestEffort;
+    } else if (name == wxT("idle")) {
+      profile.io_class = IoPriorityClass::Idle;
+    } else if (name != wxT("none")) {
+      error = wxString::Format(wxT("Invalid I/O class in launch profile: %s"), value);
+      return false;
+    }
+  }
+
+  if (ReadProfileValue(config, mod, wxT("ioLevel"), value) && !value.empty()) {
+    long level = 0;
+    if (!value.ToLong(&level) || level < 0 || level > 7) {
+      error = wxString::Format(wxT("Invalid I/O priority level in launch profile: %s"),
+                               value);
+      return false;
+    }
+    profile.io_level = static_cast<int>(level);
+  }
+
+  if (ReadProfileValue(config, mod, wxT("cgroup"), value)) {
+    profile.cgroup = value.Strip(wxString::both);
+    // Empty means no cgroup, so a mod can opt out of the shared one.
+    if (!profile.cgroup.empty() && !IsValidCgroupName(profile.cgroup)) {
+      error = wxString::Format(wxT("Invalid cgroup name in launch profile: %s"), value);
+      return false;
+    }
+  }
+
+  if (ReadProfileValue(config, mod, wxT("cpuQuota"), value) && !value.empty() &&
+      (!value.ToLong(&profile.cpu_quota_percent) || profile.cpu_quota_percent <= 0)) {
+    error = wxString::Format(wxT("Invalid CPU quota in launch profile: %s"), value);
+    return false;
+  }
+
+  if (ReadProfileValue(config, mod, wxT("memoryMax"), value) && !value.empty() &&
+      !ParseByteSize(value, profile.memory_max)) {
+    error = wxString::Format(wxT("Invalid memory limit in launch profile: %s"), value);
+    return false;
+  }
+
+  if (profile.cgroup.empty() &&
+      (profile.cpu_quota_percent > 0 || profile.memory_max > 0)) {
+    error = wxT("Launch profile CPU and memory limits require a cgroup name.");
+    return false;
+  }
+  return true;
+}
+
+#if defined(__linux__)
+
+void ApplyThreadLimits(const LaunchProfile &profile, wxArrayString &warnings) {
+  if (!profile.cpus.empty()) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int cpu : profile.cpus) {
+      CPU_SET(static_cast<size_t>(cpu), &set);
+    }
+    if (sched_setaffinity(0, sizeof(set), &set) != 0) {
+      warnings.Add(wxString::Format(wxT("Failed to set CPU affinity %s: %s"),
+                                    FormatCpuList(profile.cpus), LastErrorText()));
+    }
+  }
+
+  // On Linux both calls act on the calling thread when `who` is 0.
+  if (profile.set_nice && setpriority(PRIO_PROCESS, 0, profile.nice) != 0) {
+    warnings.Add(wxString::Format(wxT("Failed to set nice level %d: %s"), profile.nice,
+                                  LastErrorText()));
+  }
+
+  if (profile.io_class != IoPriorityClass::Inherit) {
+    const int ioClass = static_cast<int>(profile.io_class);
+    const int level = profile.io_class == IoPriorityClass::Idle ? 0 : profile.io_level;
+    if (syscall(SYS_ioprio_set, kIoPriorityWhoProcess, 0,
+                (ioClass << kIoPriorityClassShift) | level) != 0) {
+      warnings.Add(wxString::Format(wxT("Failed to set I/O class %s: %s"),
+                                    IoClassName(profile.io_class), LastErrorText()));
+    }
+  }
+}
+
+void PlaceInCgroup(long pid, const LaunchProfile &profile, wxArrayString &warnings) {
+  if (profile.cgroup.empty()) {
+    return;
+  }
+
+  const std::string root = "/sys/fs/cgroup";
+  struct stat info {};
+  std::string ownCgroup;
+  if (stat((root + "/cgroup.controllers").c_str(), &info) != 0 ||
+      !ReadProcessCgroup("self", ownCgroup)) {
+    warnings.Add(wxT("cgroup v2 is not available; skipping the cgroup limits."));
+    return;
+  }
+
+  // A sibling of the launcher's cgroup: processes may not live in a cgroup
+  // that distributes resources to children, and the parent is usually
+  // delegated to the user session.
+  const size_t slash = ownCgroup.rfind('/');
+  const std::string parent = slash == std::string::npos || slash == 0
+                                 ? std::string()
+                                 : ownCgroup.substr(0, slash);
+  const std::string target = root + parent + "/" + ToUtf8(profile.cgroup);
+  // Checked before anything is created, so a missing controller reads as
+  // such instead of as a failed write.
+  const bool cpuLimit =
+      profile.cpu_quota_percent > 0 && EnableController(root + parent, "cpu", warnings);
+  const bool memoryLimit =
+      profile.memory_max > 0 && EnableController(root + parent, "memory", warnings);
+  if (mkdir(target.c_str(), 0755) != 0 && errno != EEXIST) {
+    warnings.Add(wxString::Format(wxT("Failed to create cgroup %s: %s"),
+                                  wxString::FromUTF8(target), LastErrorText()));
+    return;
+  }
+
+  if (cpuLimit) {
+    constexpr long kPeriodUs = 100000;
+    const std::string cpuMax =
+        std::to_string(profile.cpu_quota_percent * kPeriodUs / 100) + " " +
+        std::to_string(kPeriodUs);
+    if (!WriteSmallFile(target + "/cpu.max", cpuMax)) {
+      warnings.Add(wxString::Format(wxT("Failed to set cpu.max in %s: %s"),
+                                    wxString::FromUTF8(target), LastErrorText()));
+    }
+  }
+  if (memoryLimit &&
+      !WriteSmallFile(target + "/memory.max", std::to_string(profile.memory_max))) {
+    warnings.Add(wxString::Format(wxT("Failed to set memory.max in %s: %s"),
+                                  wxString::FromUTF8(target), LastErrorText()));
+  }
+  if (!WriteSmallFile(target + "/cgroup.procs", std::to_string(pid))) {
+    warnings.Add(wxString::Format(wxT("Failed to move pid %ld into %s: %s"), pid,
+                                  wxString::FromUTF8(target), LastErrorText()));
+  }
+}
+
+wxString VerifyProcessLimits(long pid, const LaunchProfile &profile,
+                             wxArrayString &warnings) {
+  wxString applied;
+
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  if (sched_getaffinity(static_cast<pid_t>(pid), sizeof(set), &set) == 0) {
+    std::vector<int> cpus;
+    for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+      if (CPU_ISSET(static_cast<size_t>(cpu), &set)) {
+        cpus.push_back(cpu);
+      }
+    }
+    applied += wxT("affinity=") + FormatCpuList(cpus);
+    if (!profile.cpus.empty() && cpus != profile.cpus) {
+      warnings.Add(wxString::Format(wxT("CPU affinity is %s instead of %s."),
+                                    FormatCpuList(cpus), FormatCpuList(profile.cpus)));
+    }
+  }
+
+  errno = 0;
+  const int nice = getpriority(PRIO_PROCESS, static_cast<id_t>(pid));
+  if (errno == 0) {
+    applied += wxString::Format(wxT(" nice=%d"), nice);
+    if (profile.set_nice && nice != profile.nice) {
+      warnings.Add(wxString::Format(wxT("Nice level is %d instead of %d."), nice,
+                                    profile.nice));
+    }
+  }
+
+  const long ioPriority = syscall(SYS_ioprio_get, kIoPriorityWhoProcess, pid);
+  if (ioPriority >= 0) {
+    const auto ioClass = static_cast<IoPriorityClass>(ioPriority >> kIoPriorityClassShift);
+    applied += wxString::Format(wxT(" io=%s/%ld"), IoClassName(ioClass),
+                                ioPriority & ((1 << kIoPriorityClassShift) - 1));
+    if (profile.io_class != IoPriorityClass::Inherit && ioClass != profile.io_class) {
+      warnings.Add(wxString::Format(wxT("I/O class is %s instead of %s."),
+                                    IoClassName(ioClass), IoClassName(profile.io_class)));
+    }
+  }
+
+  std::string cgroup;
+  if (ReadProcessCgroup(std::to_string(pid), cgroup)) {
+    applied += wxT(" cgroup=") + wxString::FromUTF8(cgroup);
+    std::string limit;
+    if (profile.cpu_quota_percent > 0 &&
+        ReadSmallFile("/sys/fs/cgroup" + cgroup + "/cpu.max", limit)) {
+      applied += wxT(" cpu.max=\"") + wxString::FromUTF8(limit) + wxT("\"");
+    }
+    if (profile.memory_max > 0 &&
+        ReadSmallFile("/sys/fs/cgroup" + cgroup + "/memory.max", limit)) {
+      applied += wxT(" memory.max=") + wxString::FromUTF8(limit);
+    }
+    const std::string leaf = "/" + ToUtf8(profile.cgroup);
+    if (!profile.cgroup.empty() &&
+        (cgroup.size() < leaf.size() ||
+         cgroup.compare(cgroup.size() - leaf.size(), leaf.size(), leaf) != 0)) {
+      warnings.Add(wxString::Format(wxT("Process runs in cgroup %s instead of %s."),
+                                    wxString::FromUTF8(cgroup), profile.cgroup));
+    }
+  }
+  return applied;
+}
+
+#else
+
+void ApplyThreadLimits(const LaunchProfile &profile, wxArrayString &warnings) {
+  if (profile.HasThreadLimits()) {
+    warnings.Add(wxT("CPU affinity, nice and I/O class profiles are only supported on "
+                     "Linux."));
+  }
+}
+
+void PlaceInCgroup(long, const LaunchProfile &profile, wxArrayString &warnings) {
+  if (!profile.cgroup.empty()) {
+    warnings.Add(wxT("cgroup limits are only supported on Linux."));
+  }
+}
+
+wxString VerifyProcessLimits(long, const LaunchProfile &, wxArrayString &) {
+  return wxString();
+}
+
+#endif
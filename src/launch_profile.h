@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <wx/arrstr.h>
+#include <wx/string.h>
+
+class wxConfigBase;
+
+enum class IoPriorityClass { Inherit, Realtime, BestEffort, Idle };
+
+// Resource limits for the spawned game, read from the launcher config: the
+// [PROFILE] group applies to every launch and [PROFILE/<ModName.ini>]
+// overrides it key by key. Unset fields inherit from the launcher.
+struct LaunchProfile {
+  std::vector<int> cpus;
+  bool set_nice = false;
+  int nice = 0;
+  IoPriorityClass io_class = IoPriorityClass::Inherit;
+  int io_level = 4;
+  // cgroup v2 leaf created next to the launcher's own cgroup.
+  wxString cgroup;
+  // Percent of one CPU (cpu.max quota) and memory.max in bytes; 0 = no limit.
+  long cpu_quota_percent = 0;
+  int64_t memory_max = 0;
+
+  bool HasThreadLimits() const;
+  bool IsEmpty() const;
+};
+
+bool ReadLaunchProfile(const wxConfigBase &config, const wxString &mod,
+                       LaunchProfile &profile, wxString &error);
+bool ParseCpuList(const wxString &text, std::vector<int> &cpus);
+bool ParseByteSize(const wxString &text, int64_t &bytes);
+wxString FormatCpuList(const std::vector<int> &cpus);
+
+// Applies affinity, nice and I/O priority to the calling thread, so a
+// process spawned from it inherits them. Linux only.
+void ApplyThreadLimits(const LaunchProfile &profile, wxArrayString &warnings);
+// Moves `pid` into the profile's cgroup after writing its limits. The move
+// follows the spawn, so the game's first moments run outside the limits.
+void PlaceInCgroup(long pid, const LaunchProfile &profile, wxArrayString &warnings);
+// Reads back what `pid` actually runs with, and warns where it differs from
+// the profile.
+wxString VerifyProcessLimits(long pid, const LaunchProfile &profile,
+                             wxArrayString &warnings);
@@ -1,5 +1,6 @@
 #include "localization.h"
 #include "embedded_locales.h"
+#include "trace.h"
 
 #include <wx/dir.h>
 #include <wx/filename.h>
@@ -11,7 +12,15 @@
 namespace {
 
 const wxString kI18nDomain = wxT("opengothicstarter");
-bool gLocalizationLookupPathsRegistered = false;
+
+// Languages that ship a catalog in one of the lookup paths. Built once on the
+// first initialization; the directories are not rescanned afterwards.
+struct CatalogRegistry {
+  bool built = false;
+  wxArrayString languages;
+};
+
+CatalogRegistry gCatalogRegistry;
 
 bool InitLocale(wxLocale &locale, int language) {
   if (language == wxLANGUAGE_UNKNOWN) {
@@ -20,47 +29,87 @@ bool InitLocale(wxLocale &locale, int language) {
   return locale.Init(language, wxLOCALE_DONT_LOAD_DEFAULT);
 }
 
-} // namespace
+wxArrayString CollectLookupPaths() {
+  wxArrayString lookupPaths;
 
-void InitializeLocalization(std::unique_ptr<wxLocale> &app_locale,
-                            const wxString &languageOverride) {
-  if (!gLocalizationLookupPathsRegistered) {
-    wxArrayString lookupPaths;
-
-    wxFileName exeFile(wxStandardPaths::Get().GetExecutablePath());
-    exeFile.Normalize(wxPATH_NORM_DOTS | wxPATH_NORM_ABSOLUTE);
-    const wxString exeDir = exeFile.GetPath();
-
-    lookupPaths.Add(wxFileName(exeDir, wxT("locale")).GetFullPath());
-
-    wxFileName installPrefix(exeDir, wxEmptyString);
-    installPrefix.Normalize(wxPATH_NORM_DOTS | wxPATH_NORM_ABSOLUTE);
-    if (!installPrefix.GetDirs().empty()) {
-      installPrefix.RemoveLastDir(); // bin -> install prefix
-      const wxString shareDir =
-          wxFileName(installPrefix.GetPath(), wxT("share")).GetFullPath();
-      lookupPaths.Add(wxFileName(shareDir, wxT("locale")).GetFullPath());
-    }
+  wxFileName exeFile(wxStandardPaths::Get().GetExecutablePath());
+  exeFile.Normalize(wxPATH_NORM_DOTS | wxPATH_NORM_ABSOLUTE);
+  const wxString exeDir = exeFile.GetPath();
+
+  lookupPaths.Add(wxFileName(exeDir, wxT("locale")).GetFullPath());
+
+  wxFileName installPrefix(exeDir, wxEmptyString);
+  installPrefix.Normalize(wxPATH_NORM_DOTS | wxPATH_NORM_ABSOLUTE);
+  if (!installPrefix.GetDirs().empty()) {
+    installPrefix.RemoveLastDir(); // bin -> install prefix
+    const wxString shareDir =
+        wxFileName(installPrefix.GetPath(), wxT("share")).GetFullPath();
+    lookupPaths.Add(wxFileName(shareDir, wxT("locale")).GetFullPath());
+  }
+
+  wxString bundledLocaleError;
+  const wxString bundledLocaleRoot = GetBundledLocaleRoot(bundledLocaleError);
+  if (!bundledLocaleRoot.empty()) {
+    lookupPaths.Add(bundledLocaleRoot);
+  } else if (!bundledLocaleError.empty()) {
+    wxLogWarning(wxT("Bundled locale extraction failed: %s"), bundledLocaleError);
+  }
+
+  return lookupPaths;
+}
+
+void ScanCatalogLanguages(const wxString &path, wxArrayString &languages) {
+  wxDir localeDir(path);
+  if (!localeDir.IsOpened()) {
+    return;
+  }
 
-    wxString bundledLocaleError;
-    const wxString bundledLocaleRoot = GetBundledLocaleRoot(bundledLocaleError);
-    if (!bundledLocaleRoot.empty()) {
-      lookupPaths.Add(bundledLocaleRoot);
-    } else if (!bundledLocaleError.empty()) {
-      wxLogWarning(wxT("Bundled locale extraction failed: %s"), bundledLocaleError);
+  wxString languageCode;
+  bool hasDir = localeDir.GetFirst(&languageCode, wxEmptyString, wxDIR_DIRS);
+  while (hasDir) {
+    const wxString languageDir = wxFileName(path, languageCode).GetFullPath();
+    const wxString lcMessagesDir =
+        wxFileName(languageDir, wxT("LC_MESSAGES")).GetFullPath();
+    const wxString catalogPath =
+        wxFileName(lcMessagesDir, kI18nDomain + wxT(".mo")).GetFullPath();
+    if (wxFileName::FileExists(catalogPath) &&
+        languages.Index(languageCode, false) == wxNOT_FOUND) {
+      languages.Add(languageCode);
     }
+    hasDir = localeDir.GetNext(&languageCode);
+  }
+}
 
-    for (const wxString &path : lookupPaths) {
-      if (!wxDir::Exists(path)) {
-        continue;
-      }
+const CatalogRegistry &EnsureCatalogRegistry() {
+  if (gCatalogRegistry.built) {
+    return gCatalogRegistry;
+  }
 
-      wxLocale::AddCatalogLookupPathPrefix(path);
-      wxLogMessage(wxT("Localization lookup path: %s"), path);
+  TraceScope trace("BuildCatalogRegistry");
+  for (const wxString &path : CollectLookupPaths()) {
+    if (!wxDir::Exists(path)) {
+      continue;
     }
 
-    gLocalizationLookupPathsRegistered = true;
+    wxLocale::AddCatalogLookupPathPrefix(path);
+    wxLogMessage(wxT("Localization lookup path: %s"), path);
+    ScanCatalogLanguages(path, gCatalogRegistry.languages);
   }
+  gCatalogRegistry.languages.Sort();
+  gCatalogRegistry.built = true;
+  return gCatalogRegistry;
+}
+
+} // namespace
+
+const wxArrayString &GetAvailableCatalogLanguages() {
+  return EnsureCatalogRegistry().languages;
+}
+
+void InitializeLocalization(std::unique_ptr<wxLocale> &app_locale,
+                            const wxString &languageOverride) {
+  TraceScope trace("InitializeLocalization", "startup", languageOverride);
+  EnsureCatalogRegistry();
 
   bool hasOverride = false;
   wxString overrideCanonicalLanguage;
@@ -75,20 +124,23 @@ void InitializeLocalization(std::unique_ptr<wxLocale> &app_locale,
     }
   }
 
-  const int systemLanguage = wxLocale::GetSystemLanguage();
-  app_locale = std::make_unique<wxLocale>();
-
-  if (InitLocale(*app_locale, systemLanguage)) {
-    wxLogMessage(wxT("Initialized system locale: %s"),
-                 wxLocale::GetLanguageName(systemLanguage));
-  } else {
-    wxLogWarning(wxT("Failed to initialize system locale; falling back to English."));
+  // The process locale only follows the system language, so a language
+  // switch keeps the existing wxLocale and swaps the translation catalog.
+  if (!app_locale || !app_locale->IsOk()) {
+    const int systemLanguage = wxLocale::GetSystemLanguage();
     app_locale = std::make_unique<wxLocale>();
-    if (!InitLocale(*app_locale, wxLANGUAGE_ENGLISH)) {
-      wxLogWarning(
-          wxT("Failed to initialize English locale. Continuing without catalog localization."));
-      app_locale.reset();
-      return;
+    if (InitLocale(*app_locale, systemLanguage)) {
+      wxLogMessage(wxT("Initialized system locale: %s"),
+                   wxLocale::GetLanguageName(systemLanguage));
+    } else {
+      wxLogWarning(wxT("Failed to initialize system locale; falling back to English."));
+      app_locale = std::make_unique<wxLocale>();
+      if (!InitLocale(*app_locale, wxLANGUAGE_ENGLISH)) {
+        wxLogWarning(wxT("Failed to initialize English locale. Continuing without "
+                         "catalog localization."));
+        app_locale.reset();
+        return;
+      }
     }
   }
 
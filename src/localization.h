@@ -1,9 +1,14 @@
 #pragma once
 
 #include <memory>
+#include <wx/arrstr.h>
 #include <wx/string.h>
 
 class wxLocale;
 
 void InitializeLocalization(std::unique_ptr<wxLocale> &app_locale,
                             const wxString &languageOverride = wxString());
+
+// Language codes with an installed opengothicstarter catalog, sorted. Served
+// from a registry that scans the lookup paths once per process.
+const wxArrayString &GetAvailableCatalogLanguages();
@@ -0,0 +1,148 @@
+#include "mod_discovery.h"
+#include "mod_table.h"
+#include "path_index.h"
+#include "text_hash.h"
+#include "trace.h"
+
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <unordered_set>
+#include <wx/arrstr.h>
+#include <wx/dir.h>
+#include <wx/fileconf.h>
+#include <wx/filename.h>
+#include <wx/log.h>
+
+namespace {
+
+std::mutex gReportedVolumesMutex;
+// "<ini>/<volume>" pairs already warned about; every rescan sees them again.
+std::unordered_set<std::string> gReportedVolumes;
+
+// Logs volumes listed under [FILES] that are missing from Data/modvdf, once
+// per mod and volume. The mod stays listed; the engine reports the details
+// when it starts.
+void ValidateModVolumes(const RuntimePaths &paths, const wxString &iniName,
+                        const wxFileConfig &cfg) {
+  wxString volumes;
+  if (!cfg.Read(wxT("/FILES/VDF"), &volumes)) {
+    return;
+  }
+  for (const wxString &volume : wxSplit(volumes, ' ', '\0')) {
+    if (volume.empty()) {
+      continue;
+    }
+    wxString path;
+    if (ResolvePathCaseInsensitive(paths.gothic_root, wxT("Data/modvdf/") + volume, path)) {
+      continue;
+    }
+    const std::string key = (iniName + wxT("/") + volume).Lower().ToStdString(wxConvUTF8);
+    {
+      std::lock_guard<std::mutex> lock(gReportedVolumesMutex);
+      if (!gReportedVolumes.insert(key).second) {
+        continue;
+      }
+    }
+    wxLogWarning(wxT("Mod %s lists a missing volume: %s"), iniName, volume);
+  }
+}
+
+// Calls `visit` for every mod INI in the system directory that has a title.
+void ScanModInis(const RuntimePaths &paths, const std::function<void(GameEntry &)> &visit) {
+  if (!wxDir::Exists(paths.gothic_root) || !wxDir::Exists(paths.system_dir)) {
+    wxLogWarning(wxT("Skipping mod discovery due to invalid runtime directories."));
+    return;
+  }
+
+  wxString systemDir = paths.system_dir;
+  wxDir dir(systemDir);
+  wxString iniName;
+  bool hasFile = dir.GetFirst(&iniName, wxEmptyString, wxDIR_FILES);
+
+  while (hasFile) {
+    if (wxFileName(iniName).GetExt().Lower() != wxT("ini")) {
+      hasFile = dir.GetNext(&iniName);
+      continue;
+    }
+
+    TraceScope iniTrace("ParseModIni", "mods", iniName);
+    wxString iniPath = wxFileName(systemDir, iniName).GetFullPath();
+
+    wxFileConfig cfg(wxEmptyString, wxEmptyString, iniPath, wxEmptyString,
+                     wxCONFIG_USE_LOCAL_FILE);
+
+    if (!cfg.HasGroup("/INFO") || !cfg.HasGroup("/FILES")) {
+      hasFile = dir.GetNext(&iniName);
+      continue;
+    }
+
+    cfg.SetPath("/INFO");
+    wxString title, authors, webpage, iconKey;
+    bool okTitle = cfg.Read("Title", &title);
+    bool okIcon = cfg.Read("Icon", &iconKey);
+    cfg.Read("Authors", &authors);
+    cfg.Read("Webpage", &webpage);
+
+    if (okTitle) {
+      GameEntry entry;
+      entry.file = iniName;
+      entry.title = title;
+      entry.authors = authors;
+      entry.webpage = webpage;
+
+      if (okIcon && !iconKey.IsEmpty()) {
+        if (!ResolvePathCaseInsensitive(systemDir, iconKey, entry.icon)) {
+          entry.icon = wxFileName(systemDir, iconKey).GetFullPath();
+        }
+      } else {
+        entry.icon.Clear();
+      }
+      ValidateModVolumes(paths, iniName, cfg);
+
+      wxString modName = wxFileName(iniName).GetName();
+      entry.datadir = GetModWorkingDirectory(paths, modName);
+
+      if (!wxDir::Exists(entry.datadir) &&
+          !wxFileName::Mkdir(entry.datadir, wxS_DIR_DEFAULT, wxPATH_MKDIR_FULL)) {
+        wxLogError(wxT("Failed to create mod data directory: %s"), entry.datadir);
+        hasFile = dir.GetNext(&iniName);
+        continue;
+      }
+
+      visit(entry);
+    }
+
+    hasFile = dir.GetNext(&iniName);
+  }
+}
+
+} // namespace
+
+std::vector<GameEntry> DiscoverGames(const RuntimePaths &paths) {
+  TraceScope trace("InitGames");
+  std::vector<GameEntry> gamesList;
+  ScanModInis(paths, [&gamesList](GameEntry &entry) { gamesList.push_back(std::move(entry)); });
+  return gamesList;
+}
+
+void DiscoverMods(const RuntimePaths &paths, ModTable &table) {
+  TraceScope trace("InitGames");
+  table.Clear(paths);
+  ScanModInis(paths, [&table](GameEntry &entry) { table.Add(entry); });
+}
+
+wxString GetModStorageName(const wxString &mod_file) {
+  const wxString lowered = mod_file.Lower();
+  wxString name;
+  for (const wxUniChar ch :
+       mod_file.empty() ? wxString(wxT("gothic")) : wxFileName(lowered).GetName()) {
+    const bool portable = (ch >= 'a' && ch <= 'z') || (ch >= '0' && ch <= '9') ||
+                          ch == '-' || ch == '_';
+    name += portable ? ch : wxUniChar('_');
+  }
+
+  // The hash keeps names apart that only differ in replaced characters.
+  return name + wxString::Format(wxT("-%08x"), HashUtf8Fnv32(lowered));
+}
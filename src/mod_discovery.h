@@ -0,0 +1,25 @@
+#pragma once
+
+#include "runtime_paths.h"
+
+#include <vector>
+#include <wx/string.h>
+
+struct GameEntry {
+  wxString file;
+  wxString title;
+  wxString authors;
+  wxString webpage;
+  wxString icon;
+  wxString datadir;
+};
+
+class ModTable;
+
+std::vector<GameEntry> DiscoverGames(const RuntimePaths &paths);
+// Same scan as DiscoverGames(), filled into `table` in place and in the same
+// order. Reusing one table across scans keeps its storage.
+void DiscoverMods(const RuntimePaths &paths, ModTable &table);
+// Portable, collision-free file name for per-mod launcher data, derived from
+// the mod INI name ("gothic-..." for the base game).
+wxString GetModStorageName(const wxString &mod_file);
@@ -0,0 +1,166 @@
+#include "mod_table.h"
+
+#include <algorithm>
+#include <cstring>
+#include <wx/filename.h>
+
+namespace {
+
+constexpr size_t kPoolChunkSize = 16 * 1024;
+
+template <typename T> size_t CapacityBytes(const std::vector<T> &column) {
+  return column.capacity() * sizeof(T);
+}
+
+} // namespace
+
+FileIdentity ReadFileIdentity(const wxString &path) {
+  FileIdentity identity;
+  const wxFileName file(path);
+  if (path.empty() || !file.FileExists()) {
+    return identity;
+  }
+  identity.size = static_cast<uint64_t>(file.GetSize().GetValue());
+  identity.mtime_ms = static_cast<int64_t>(file.GetModificationTime().GetValue().GetValue());
+  return identity;
+}
+
+StringPool::StringPool() { strings.emplace_back(); }
+
+StringPool::Id StringPool::Intern(const wxString &value) {
+  if (value.empty()) {
+    return kEmptyId;
+  }
+  const wxScopedCharBuffer utf8 = value.utf8_str();
+  return Intern(std::string_view(utf8.data(), utf8.length()));
+}
+
+StringPool::Id StringPool::Intern(std::string_view utf8) {
+  if (utf8.empty()) {
+    return kEmptyId;
+  }
+  const auto found = ids.find(utf8);
+  if (found != ids.end()) {
+    return found->second;
+  }
+
+  const std::string_view stored = Store(utf8);
+  const Id id = static_cast<Id>(strings.size());
+  strings.push_back(stored);
+  ids.emplace(stored, id);
+  return id;
+}
+
+wxString StringPool::Get(Id id) const {
+  const std::string_view utf8 = strings[id];
+  return utf8.empty() ? wxString() : wxString::FromUTF8(utf8.data(), utf8.size());
+}
+
+size_t StringPool::MemoryBytes() const {
+  size_t bytes = chunks.capacity() * sizeof(Chunk) + CapacityBytes(strings);
+  for (const Chunk &chunk : chunks) {
+    bytes += chunk.size;
+  }
+  // Buckets plus one node (key, id and next pointer) per entry.
+  bytes += ids.bucket_count() * sizeof(void *) +
+           ids.size() * (sizeof(std::pair<const std::string_view, Id>) + sizeof(void *));
+  return bytes;
+}
+
+void StringPool::Clear() {
+  strings.resize(1);
+  ids.clear();
+  chunk_index = 0;
+  chunk_used = 0;
+}
+
+std::string_view StringPool::Store(std::string_view utf8) {
+  while (chunk_index < chunks.size() &&
+         chunks[chunk_index].size - chunk_used < utf8.size()) {
+    ++chunk_index;
+    chunk_used = 0;
+  }
+  if (chunk_index == chunks.size()) {
+    const size_t size = std::max(kPoolChunkSize, utf8.size());
+    chunks.push_back(Chunk{std::make_unique<char[]>(size), size});
+    chunk_used = 0;
+  }
+
+  char *destination = chunks[chunk_index].data.get() + chunk_used;
+  std::memcpy(destination, utf8.data(), utf8.size());
+  chunk_used += utf8.size();
+  return std::string_view(destination, utf8.size());
+}
+
+void ModTable::Clear(const RuntimePaths &paths) {
+  roots = paths;
+  pool.Clear();
+  titles.clear();
+  icons.clear();
+  icon_absolute.clear();
+  icon_identities.clear();
+  cold.clear();
+}
+
+void ModTable::Reserve(size_t rows) {
+  titles.reserve(rows);
+  icons.reserve(rows);
+  icon_absolute.reserve(rows);
+  icon_identities.reserve(rows);
+  cold.reserve(rows);
+}
+
+void ModTable::Add(const GameEntry &entry) {
+  titles.push_back(pool.Intern(entry.title));
+
+  const wxString systemPrefix = roots.system_dir + wxFileName::GetPathSeparator();
+  wxString relativeIcon;
+  if (entry.icon.StartsWith(systemPrefix, &relativeIcon)) {
+    icons.push_back(pool.Intern(relativeIcon));
+    icon_absolute.push_back(false);
+  } else {
+    icons.push_back(pool.Intern(entry.icon));
+    icon_absolute.push_back(true);
+  }
+  icon_identities.push_back(ReadFileIdentity(entry.icon));
+
+  cold.push_back(ColdFields{pool.Intern(entry.file), pool.Intern(entry.authors),
+                            pool.Intern(entry.webpage)});
+}
+
+wxString ModTable::IconPath(size_t row) const {
+  if (icons[row] == StringPool::kEmptyId) {
+    return wxString();
+  }
+  const wxString icon = pool.Get(icons[row]);
+  if (icon_absolute[row]) {
+    return icon;
+  }
+  return roots.system_dir + wxFileName::GetPathSeparator() + icon;
+}
+
+size_t ModTable::Find(const wxString &file) const {
+  for (size_t row = 0; row < size(); ++row) {
+    if (File(row).IsSameAs(file, false)) {
+      return row;
+    }
+  }
+  return npos;
+}
+
+GameEntry ModTable::Entry(size_t row) const {
+  GameEntry entry;
+  entry.file = File(row);
+  entry.title = Title(row);
+  entry.authors = pool.Get(cold[row].authors);
+  entry.webpage = pool.Get(cold[row].webpage);
+  entry.icon = IconPath(row);
+  entry.datadir = GetModWorkingDirectory(roots, wxFileName(entry.file).GetName());
+  return entry;
+}
+
+size_t ModTable::MemoryBytes() const {
+  return pool.MemoryBytes() + CapacityBytes(titles) +
+         CapacityBytes(icons) + icon_absolute.capacity() / 8 +
+         CapacityBytes(icon_identities) + CapacityBytes(cold);
+}
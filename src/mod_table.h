@@ -0,0 +1,113 @@
+#pragma once
+
+#include "mod_discovery.h"
+#include "runtime_paths.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include <wx/string.h>
+
+// Size and modification time of a file; all zero when it does not exist.
+struct FileIdentity {
+  uint64_t size = 0;
+  int64_t mtime_ms = 0;
+
+  bool operator==(const FileIdentity &other) const {
+    return size == other.size && mtime_ms == other.mtime_ms;
+  }
+  bool operator!=(const FileIdentity &other) const { return !(*this == other); }
+};
+
+FileIdentity ReadFileIdentity(const wxString &path);
+
+// Interned UTF-8 strings stored back to back in arena chunks. Equal strings
+// share one id, so values repeated across mods (authors, web pages) are kept
+// once.
+class StringPool {
+public:
+  using Id = uint32_t;
+  // The empty string; valid in every pool.
+  static constexpr Id kEmptyId = 0;
+
+  StringPool();
+
+  Id Intern(const wxString &value);
+  Id Intern(std::string_view utf8);
+  std::string_view View(Id id) const { return strings[id]; }
+  wxString Get(Id id) const;
+
+  size_t size() const { return strings.size(); }
+  // Arena chunks plus the id and lookup tables.
+  size_t MemoryBytes() const;
+  // Forgets every string but keeps the chunks and tables for reuse.
+  void Clear();
+
+private:
+  struct Chunk {
+    std::unique_ptr<char[]> data;
+    size_t size;
+  };
+
+  std::string_view Store(std::string_view utf8);
+
+  std::vector<Chunk> chunks;
+  size_t chunk_index = 0;
+  size_t chunk_used = 0;
+  std::vector<std::string_view> strings;
+  std::unordered_map<std::string_view, Id> ids;
+};
+
+// Discovered mods in struct-of-arrays form, in discovery order. The list only
+// touches the hot columns (title, icon and its identity); the rest is
+// expanded into a GameEntry by Entry() when a mod is launched. Icons are
+// stored relative to the system directory and the data directory is derived
+// from the INI name, so no full path is kept per mod. Clear() keeps the
+// columns and the string arena, so rediscovery into the same table reuses
+// their storage.
+class ModTable {
+public:
+  static constexpr size_t npos = static_cast<size_t>(-1);
+
+  size_t size() const { return titles.size(); }
+  bool empty() const { return titles.empty(); }
+
+  // Drops all rows; paths expanded by later calls are relative to `paths`.
+  void Clear(const RuntimePaths &paths);
+  void Reserve(size_t rows);
+  void Add(const GameEntry &entry);
+
+  wxString Title(size_t row) const { return pool.Get(titles[row]); }
+  // Full icon path, or empty when the mod has none.
+  wxString IconPath(size_t row) const;
+  // Taken when the row was added, so icon caches can be checked without
+  // touching the disk.
+  const FileIdentity &IconIdentity(size_t row) const { return icon_identities[row]; }
+  wxString File(size_t row) const { return pool.Get(cold[row].file); }
+  // Row of the given INI name (case-insensitive), or npos.
+  size_t Find(const wxString &file) const;
+  GameEntry Entry(size_t row) const;
+
+  // Heap bytes held by the table, including spare capacity.
+  size_t MemoryBytes() const;
+
+private:
+  // Fields read only when a mod is launched or inspected.
+  struct ColdFields {
+    StringPool::Id file;
+    StringPool::Id authors;
+    StringPool::Id webpage;
+  };
+
+  RuntimePaths roots;
+  StringPool pool;
+  std::vector<StringPool::Id> titles;
+  std::vector<StringPool::Id> icons;
+  // Set when the icon is outside the system directory and kept absolute.
+  std::vector<bool> icon_absolute;
+  std::vector<FileIdentity> icon_identities;
+  std::vector<ColdFields> cold;
+};
@@ -0,0 +1,139 @@
+#include "path_index.h"
+
+#if defined(_WIN32)
+#include <wx/filename.h>
+#else
+#include <dirent.h>
+#include <mutex>
+#include <string>
+#include <sys/stat.h>
+#include <unordered_map>
+
+namespace {
+
+struct DirectoryListing {
+  dev_t device = 0;
+  ino_t inode = 0;
+  timespec mtime{};
+  // Folded name -> on-disk name; empty when several names fold together.
+  std::unordered_map<std::string, std::string> names;
+};
+
+std::mutex gPathIndexMutex;
+std::unordered_map<std::string, DirectoryListing> gPathIndex;
+
+timespec ModificationTime(const struct stat &info) {
+#if defined(__APPLE__)
+  return info.st_mtimespec;
+#else
+  return info.st_mtim;
+#endif
+}
+
+// Gothic file names are ASCII; other bytes have to match exactly.
+std::string FoldCase(const std::string &name) {
+  std::string folded = name;
+  for (char &ch : folded) {
+    if (ch >= 'A' && ch <= 'Z') {
+      ch = static_cast<char>(ch - 'A' + 'a');
+    }
+  }
+  return folded;
+}
+
+void ReadListing(const std::string &dir, DirectoryListing &listing) {
+  listing.names.clear();
+  DIR *handle = opendir(dir.c_str());
+  if (handle == nullptr) {
+    return;
+  }
+  while (const dirent *entry = readdir(handle)) {
+    const std::string name = entry->d_name;
+    if (name == "." || name == "..") {
+      continue;
+    }
+    const auto inserted = listing.names.emplace(FoldCase(name), name);
+    if (!inserted.second) {
+      inserted.first->second.clear();
+    }
+  }
+  closedir(handle);
+}
+
+bool FindEntry(const std::string &dir, const std::string &name, std::string &actual) {
+  struct stat info {};
+  if (stat(dir.c_str(), &info) != 0 || !S_ISDIR(info.st_mode)) {
+    return false;
+  }
+
+  std::lock_guard<std::mutex> lock(gPathIndexMutex);
+  auto it = gPathIndex.find(dir);
+  const timespec mtime = ModificationTime(info);
+  if (it == gPathIndex.end() || it->second.device != info.st_dev ||
+      it->second.inode != info.st_ino || it->second.mtime.tv_sec != mtime.tv_sec ||
+      it->second.mtime.tv_nsec != mtime.tv_nsec) {
+    // The mtime is taken before listing, so a change made while reading
+    // invalidates the listing on the next lookup.
+    DirectoryListing &listing = gPathIndex[dir];
+    listing.device = info.st_dev;
+    listing.inode = info.st_ino;
+    listing.mtime = mtime;
+    ReadListing(dir, listing);
+    it = gPathIndex.find(dir);
+  }
+
+  const auto found = it->second.names.find(FoldCase(name));
+  if (found == it->second.names.end()) {
+    return false;
+  }
+  if (!found->second.empty()) {
+    actual = found->second;
+    return true;
+  }
+  // Ambiguous on a case-sensitive filesystem: only the exact spelling counts.
+  struct stat exact {};
+  if (lstat((dir + "/" + name).c_str(), &exact) != 0) {
+    return false;
+  }
+  actual = name;
+  return true;
+}
+
+} // namespace
+#endif
+
+bool ResolvePathCaseInsensitive(const wxString &base, const wxString &relative,
+                                wxString &path) {
+#if defined(_WIN32)
+  path = wxFileName(base, relative).GetFullPath();
+  return wxFileName::Exists(path);
+#else
+  std::string current = base.ToStdString(wxConvUTF8);
+  while (current.size() > 1 && current.back() == '/') {
+    current.pop_back();
+  }
+
+  const std::string rest = relative.ToStdString(wxConvUTF8);
+  size_t begin = 0;
+  while (begin <= rest.size()) {
+    size_t end = rest.find_first_of("/\\", begin);
+    if (end == std::string::npos) {
+      end = rest.size();
+    }
+    const std::string component = rest.substr(begin, end - begin);
+    begin = end + 1;
+    if (component.empty() || component == ".") {
+      continue;
+    }
+
+    std::string actual = component;
+    if (component != ".." && !FindEntry(current, component, actual)) {
+      return false;
+    }
+    current += (current == "/" ? "" : "/") + actual;
+  }
+
+  path = wxString::FromUTF8(current);
+  return true;
+#endif
+}
@@ -0,0 +1,12 @@
+#pragma once
+
+#include <wx/string.h>
+
+// Looks `relative` up below `base` one component at a time and ignores case,
+// as Gothic content expects. Both '/' and '\' separate components. Each
+// directory is listed once and the listing is reused until the directory's
+// mtime changes, so a lookup costs one stat per component instead of a scan.
+// On success `path` holds the on-disk spelling. On Windows the filesystem
+// already ignores case and this only checks that the path exists.
+bool ResolvePathCaseInsensitive(const wxString &base, const wxString &relative,
+                                wxString &path);
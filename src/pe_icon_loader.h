@@ -2,6 +2,6 @@
 
 #include <wx/string.h>
 
-class wxIcon;
+class wxImage;
 
-bool LoadIconFromPeExecutable(const wxString &path, wxIcon &icon);
+bool LoadImageFromPeExecutable(const wxString &path, wxImage &image);
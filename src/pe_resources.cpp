@@ -0,0 +1,364 @@
+#include "pe_resources.h"
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+#include <wx/strconv.h>
+
+#if defined(OGS_HAVE_PE_PARSE) && !defined(_WIN32)
+#include <pe-parse/parse.h>
+
+namespace {
+
+bool ReadLe16(const std::vector<uint8_t> &data, size_t offset, uint16_t &value) {
+  if (offset + 2 > data.size()) {
+    return false;
+  }
+
+  const uint16_t lo = static_cast<uint16_t>(data[offset]);
+  const uint16_t hi =
+      static_cast<uint16_t>(static_cast<uint16_t>(data[offset + 1]) << 8);
+  value = static_cast<uint16_t>(lo | hi);
+  return true;
+}
+
+void AppendLe16(std::vector<uint8_t> &data, uint16_t value) {
+  data.push_back(static_cast<uint8_t>(value & 0xFFu));
+  data.push_back(static_cast<uint8_t>((value >> 8) & 0xFFu));
+}
+
+void AppendLe32(std::vector<uint8_t> &data, uint32_t value) {
+  data.push_back(static_cast<uint8_t>(value & 0xFFu));
+  data.push_back(static_cast<uint8_t>((value >> 8) & 0xFFu));
+  data.push_back(static_cast<uint8_t>((value >> 16) & 0xFFu));
+  data.push_back(static_cast<uint8_t>((value >> 24) & 0xFFu));
+}
+
+uint32_t ReadLe32(const std::vector<uint8_t> &data, size_t offset) {
+  return static_cast<uint32_t>(data[offset]) |
+         static_cast<uint32_t>(data[offset + 1]) << 8 |
+         static_cast<uint32_t>(data[offset + 2]) << 16 |
+         static_cast<uint32_t>(data[offset + 3]) << 24;
+}
+
+constexpr uint32_t kFixedFileInfoSignature = 0xFEEF04BDu;
+constexpr size_t kFixedFileInfoSize = 52;
+
+size_t AlignVersionOffset(size_t offset) { return (offset + 3) & ~static_cast<size_t>(3); }
+
+// One node of the VS_VERSIONINFO tree: header, UTF-16 key, value, children.
+struct VersionBlock {
+  size_t end = 0;
+  uint16_t type = 0;
+  std::string key;
+  size_t value_offset = 0;
+  size_t value_bytes = 0;
+  size_t children_offset = 0;
+};
+
+bool ReadVersionBlock(const std::vector<uint8_t> &data, size_t offset, size_t limit,
+                      VersionBlock &block) {
+  uint16_t length = 0;
+  uint16_t valueLength = 0;
+  if (!ReadLe16(data, offset, length) || !ReadLe16(data, offset + 2, valueLength) ||
+      !ReadLe16(data, offset + 4, block.type) || length < 6 || offset + length > limit) {
+    return false;
+  }
+  block.end = offset + length;
+
+  // Keys are plain ASCII identifiers ("StringFileInfo", "FileVersion").
+  block.key.clear();
+  size_t cursor = offset + 6;
+  for (;;) {
+    uint16_t ch = 0;
+    if (cursor + 2 > block.end || !ReadLe16(data, cursor, ch)) {
+      return false;
+    }
+    cursor += 2;
+    if (ch == 0) {
+      break;
+    }
+    block.key.push_back(ch < 0x80 ? static_cast<char>(ch) : '?');
+  }
+
+  block.value_offset = AlignVersionOffset(cursor);
+  // Text values count UTF-16 units, binary ones bytes; some linkers get this
+  // wrong, so clamp to the block instead of rejecting it.
+  const size_t declared = block.type == 1 ? static_cast<size_t>(valueLength) * 2
+                                          : static_cast<size_t>(valueLength);
+  const size_t available =
+      block.value_offset < block.end ? block.end - block.value_offset : 0;
+  block.value_bytes = declared < available ? declared : available;
+  block.children_offset = AlignVersionOffset(block.value_offset + block.value_bytes);
+  return true;
+}
+
+wxString ReadVersionText(const std::vector<uint8_t> &data, const VersionBlock &block) {
+  size_t bytes = block.value_bytes & ~static_cast<size_t>(1);
+  while (bytes >= 2 && data[block.value_offset + bytes - 2] == 0 &&
+         data[block.value_offset + bytes - 1] == 0) {
+    bytes -= 2;
+  }
+  if (bytes == 0) {
+    return wxString();
+  }
+  wxString text(reinterpret_cast<const char *>(data.data() + block.value_offset),
+                wxMBConvUTF16LE(), bytes);
+  return text.Trim(true).Trim(false);
+}
+
+void ReadStringFileInfo(const std::vector<uint8_t> &data, const VersionBlock &stringFileInfo,
+                        PeVersionInfo &info) {
+  // Only the first language table; Gothic executables ship exactly one.
+  VersionBlock table;
+  if (!ReadVersionBlock(data, stringFileInfo.children_offset, stringFileInfo.end, table)) {
+    return;
+  }
+  size_t offset = table.children_offset;
+  VersionBlock entry;
+  while (offset < table.end && ReadVersionBlock(data, offset, table.end, entry)) {
+    if (entry.key == "FileVersion") {
+      info.file_version_text = ReadVersionText(data, entry);
+    } else if (entry.key == "ProductName") {
+      info.product_name = ReadVersionText(data, entry);
+    }
+    offset = AlignVersionOffset(entry.end);
+  }
+}
+
+bool ParseVersionResource(const std::vector<uint8_t> &data, PeVersionInfo &info) {
+  VersionBlock root;
+  if (!ReadVersionBlock(data, 0, data.size(), root) || root.key != "VS_VERSION_INFO" ||
+      root.value_bytes < kFixedFileInfoSize ||
+      ReadLe32(data, root.value_offset) != kFixedFileInfoSignature) {
+    return false;
+  }
+
+  const uint32_t parts[] = {
+      ReadLe32(data, root.value_offset + 8), ReadLe32(data, root.value_offset + 12),
+      ReadLe32(data, root.value_offset + 16), ReadLe32(data, root.value_offset + 20)};
+  for (size_t i = 0; i < 2; ++i) {
+    info.file_version[i * 2] = static_cast<uint16_t>(parts[i] >> 16);
+    info.file_version[i * 2 + 1] = static_cast<uint16_t>(parts[i] & 0xFFFFu);
+    info.product_version[i * 2] = static_cast<uint16_t>(parts[i + 2] >> 16);
+    info.product_version[i * 2 + 1] = static_cast<uint16_t>(parts[i + 2] & 0xFFFFu);
+  }
+
+  size_t offset = root.children_offset;
+  VersionBlock child;
+  while (offset < root.end && ReadVersionBlock(data, offset, root.end, child)) {
+    if (child.key == "StringFileInfo") {
+      ReadStringFileInfo(data, child, info);
+    }
+    offset = AlignVersionOffset(child.end);
+  }
+  return true;
+}
+
+struct GroupIconEntry {
+  uint8_t width;
+  uint8_t height;
+  uint8_t colorCount;
+  uint8_t reserved;
+  uint16_t planes;
+  uint16_t bitCount;
+  uint16_t resourceId;
+  std::vector<uint8_t> imageData;
+};
+
+} // namespace
+#endif
+
+bool ExtractIcoFromPeExecutable(const wxString &path, std::vector<uint8_t> &ico) {
+  ico.clear();
+#if defined(OGS_HAVE_PE_PARSE) && !defined(_WIN32)
+  const wxScopedCharBuffer utf8Path = path.utf8_str();
+  if (!utf8Path) {
+    return false;
+  }
+
+  peparse::parsed_pe *parsed = peparse::ParsePEFromFile(utf8Path.data());
+  if (parsed == nullptr) {
+    return false;
+  }
+
+  struct ExtractionState {
+    std::map<uint16_t, std::vector<uint8_t>> icons;
+    std::vector<uint8_t> groupIconData;
+  } extractionState;
+
+  peparse::IterRsrc(
+      parsed,
+      [](void *N, const peparse::resource &r) -> int {
+        auto *extraction = static_cast<ExtractionState *>(N);
+
+        if (r.type != peparse::RT_ICON && r.type != peparse::RT_GROUP_ICON) {
+          return 0;
+        }
+
+        std::vector<uint8_t> bytes;
+        if (r.buf == nullptr) {
+          return 0;
+        }
+        bytes.reserve(r.size);
+        for (uint32_t i = 0; i < r.size; ++i) {
+          uint8_t byte = 0;
+          if (!peparse::readByte(r.buf, i, byte)) {
+            return 0;
+          }
+          bytes.push_back(byte);
+        }
+
+        if (bytes.empty()) {
+          return 0;
+        }
+
+        if (r.type == peparse::RT_ICON) {
+          if (r.name <= UINT16_MAX && extraction->icons.find(static_cast<uint16_t>(r.name)) ==
+                                          extraction->icons.end()) {
+            extraction->icons.emplace(static_cast<uint16_t>(r.name), std::move(bytes));
+          }
+          return 0;
+        }
+
+        if (extraction->groupIconData.empty()) {
+          extraction->groupIconData = std::move(bytes);
+        }
+        return 0;
+      },
+      &extractionState);
+
+  peparse::DestructParsedPE(parsed);
+
+  if (extractionState.groupIconData.empty() || extractionState.icons.empty()) {
+    return false;
+  }
+
+  uint16_t reserved = 0;
+  uint16_t type = 0;
+  uint16_t count = 0;
+  if (!ReadLe16(extractionState.groupIconData, 0, reserved) ||
+      !ReadLe16(extractionState.groupIconData, 2, type) ||
+      !ReadLe16(extractionState.groupIconData, 4, count)) {
+    return false;
+  }
+  if (reserved != 0 || type != 1) {
+    return false;
+  }
+  if (extractionState.groupIconData.size() < 6 + static_cast<size_t>(count) * 14) {
+    return false;
+  }
+
+  std::vector<GroupIconEntry> entries;
+  entries.reserve(count);
+  for (uint16_t i = 0; i < count; ++i) {
+    const size_t offset = 6 + static_cast<size_t>(i) * 14;
+
+    uint16_t planes = 0;
+    uint16_t bitCount = 0;
+    uint16_t resourceId = 0;
+    if (!ReadLe16(extractionState.groupIconData, offset + 4, planes) ||
+        !ReadLe16(extractionState.groupIconData, offset + 6, bitCount) ||
+        !ReadLe16(extractionState.groupIconData, offset + 12, resourceId)) {
+      continue;
+    }
+
+    const auto it = extractionState.icons.find(resourceId);
+    if (it == extractionState.icons.end()) {
+      continue;
+    }
+
+    GroupIconEntry entry{};
+    entry.width = extractionState.groupIconData[offset];
+    entry.height = extractionState.groupIconData[offset + 1];
+    entry.colorCount = extractionState.groupIconData[offset + 2];
+    entry.reserved = extractionState.groupIconData[offset + 3];
+    entry.planes = planes;
+    entry.bitCount = bitCount;
+    entry.resourceId = resourceId;
+    entry.imageData = it->second;
+    entries.push_back(std::move(entry));
+  }
+  if (entries.empty()) {
+    return false;
+  }
+
+  AppendLe16(ico, 0);
+  AppendLe16(ico, 1);
+  AppendLe16(ico, static_cast<uint16_t>(entries.size()));
+
+  uint32_t imageOffset = 6 + static_cast<uint32_t>(entries.size()) * 16;
+  for (const GroupIconEntry &entry : entries) {
+    ico.push_back(entry.width);
+    ico.push_back(entry.height);
+    ico.push_back(entry.colorCount);
+    ico.push_back(entry.reserved);
+    AppendLe16(ico, entry.planes);
+    AppendLe16(ico, entry.bitCount);
+    AppendLe32(ico, static_cast<uint32_t>(entry.imageData.size()));
+    AppendLe32(ico, imageOffset);
+    imageOffset += static_cast<uint32_t>(entry.imageData.size());
+  }
+
+  for (const GroupIconEntry &entry : entries) {
+    ico.insert(ico.end(), entry.imageData.begin(), entry.imageData.end());
+  }
+
+  return true;
+#else
+  (void)path;
+  return false;
+#endif
+}
+
+bool ReadPeVersionInfo(const wxString &path, PeVersionInfo &info) {
+  info = PeVersionInfo();
+#if defined(OGS_HAVE_PE_PARSE) && !defined(_WIN32)
+  const wxScopedCharBuffer utf8Path = path.utf8_str();
+  if (!utf8Path) {
+    return false;
+  }
+
+  peparse::parsed_pe *parsed = peparse::ParsePEFromFile(utf8Path.data());
+  if (parsed == nullptr) {
+    return false;
+  }
+
+  // Stop at the first RT_VERSION entry; icons, dialogs and the rest are
+  // never copied out of the image.
+  std::vector<uint8_t> versionData;
+  peparse::IterRsrc(
+      parsed,
+      [](void *N, const peparse::resource &r) -> int {
+        if (r.type != peparse::RT_VERSION || r.buf == nullptr) {
+          return 0;
+        }
+        auto *bytes = static_cast<std::vector<uint8_t> *>(N);
+        bytes->reserve(r.size);
+        for (uint32_t i = 0; i < r.size; ++i) {
+          uint8_t byte = 0;
+          if (!peparse::readByte(r.buf, i, byte)) {
+            bytes->clear();
+            return 0;
+          }
+          bytes->push_back(byte);
+        }
+        return 1;
+      },
+      &versionData);
+
+  peparse::DestructParsedPE(parsed);
+  return !versionData.empty() && ParseVersionResource(versionData, info);
+#else
+  (void)path;
+  return false;
+#endif
+}
+
+wxString FormatPeVersion(const uint16_t (&version)[4]) {
+  return wxString::Format(wxT("%u.%u.%u.%u"), static_cast<unsigned>(version[0]),
+                          static_cast<unsigned>(version[1]),
+                          static_cast<unsigned>(version[2]),
+                          static_cast<unsigned>(version[3]));
+}
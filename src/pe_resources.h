@@ -0,0 +1,22 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <wx/string.h>
+
+bool ExtractIcoFromPeExecutable(const wxString &path, std::vector<uint8_t> &ico);
+
+struct PeVersionInfo {
+  // VS_FIXEDFILEINFO, most significant part first: {2, 6, 0, 0}.
+  uint16_t file_version[4] = {};
+  uint16_t product_version[4] = {};
+  // StringFileInfo values of the first string table, which may carry a
+  // patch letter the fixed numbers lack ("1.08k").
+  wxString file_version_text;
+  wxString product_name;
+};
+
+// Reads the RT_VERSION resource of a PE executable without touching its other
+// resources. Returns false when the file has no usable version resource.
+bool ReadPeVersionInfo(const wxString &path, PeVersionInfo &info);
+wxString FormatPeVersion(const uint16_t (&version)[4]);
@@ -0,0 +1,465 @@
+#include "prefetch_profile.h"
+#include "launch_profile.h"
+#include "mod_discovery.h"
+#include "runtime_paths.h"
+#include "trace.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <ctime>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <wx/arrstr.h>
+#include <wx/ffile.h>
+#include <wx/filename.h>
+#include <wx/log.h>
+
+#if defined(__linux__)
+#include <dirent.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+const char kProfileVersion[] = "1";
+constexpr size_t kMaxProfileFiles = 4096;
+constexpr std::chrono::milliseconds kSampleInterval{250};
+
+// Serializes profile writes from report tasks with reads in DoStart.
+std::mutex gPrefetchMutex;
+
+wxString ProfilePath(const wxString &dir, const wxString &mod) {
+  return wxFileName(dir, GetModStorageName(mod) + wxT(".prefetch")).GetFullPath();
+}
+
+double Megabytes(int64_t bytes) { return static_cast<double>(bytes) / (1024.0 * 1024.0); }
+
+#if defined(__linux__)
+
+bool IsProfilablePath(const std::string &path) {
+  return !path.empty() && path[0] == '/' && path.compare(0, 6, "/proc/") != 0 &&
+         path.compare(0, 5, "/sys/") != 0 && path.compare(0, 5, "/dev/") != 0 &&
+         path.find_first_of("\t\n") == std::string::npos;
+}
+
+struct AccessRecording {
+  std::vector<PrefetchEntry> files;
+  int64_t ready_ms = -1;
+};
+
+class AccessSampler {
+public:
+  AccessSampler(long pid, int64_t spawn_us) : pid_text(std::to_string(pid)), begin_us(spawn_us) {}
+
+  // Returns false once the process is gone.
+  bool Sample(AccessRecording &recording) {
+    const std::string fdDir = "/proc/" + pid_text + "/fd";
+    DIR *dir = opendir(fdDir.c_str());
+    if (dir == nullptr) {
+      return false;
+    }
+    char target[4096];
+    while (dirent *entry = readdir(dir)) {
+      if (entry->d_name[0] == '.') {
+        continue;
+      }
+      const ssize_t length =
+          readlinkat(dirfd(dir), entry->d_name, target, sizeof(target) - 1);
+      if (length > 0) {
+        Consider(std::string(target, static_cast<size_t>(length)), recording);
+      }
+    }
+    closedir(dir);
+
+    // Shared libraries and mapped data never show up as descriptors.
+    const std::string mapsPath = "/proc/" + pid_text + "/maps";
+    const int fd = open(mapsPath.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+      return false;
+    }
+    maps.clear();
+    char buffer[16384];
+    ssize_t read = 0;
+    while ((read = ::read(fd, buffer, sizeof(buffer))) > 0) {
+      maps.append(buffer, static_cast<size_t>(read));
+    }
+    close(fd);
+    for (size_t begin = 0; begin < maps.size();) {
+      size_t end = maps.find('\n', begin);
+      if (end == std::string::npos) {
+        end = maps.size();
+      }
+      const size_t slash = maps.find('/', begin);
+      if (slash < end) {
+        Consider(maps.substr(slash, end - slash), recording);
+      }
+      begin = end + 1;
+    }
+    return true;
+  }
+
+private:
+  void Consider(const std::string &path, AccessRecording &recording) {
+    if (recording.files.size() >= kMaxProfileFiles || !IsProfilablePath(path) ||
+        !seen.insert(path).second) {
+      return;
+    }
+    struct stat info {};
+    if (stat(path.c_str(), &info) != 0 || !S_ISREG(info.st_mode) || info.st_size == 0) {
+      return;
+    }
+    PrefetchEntry entry;
+    entry.path = wxString::FromUTF8(path);
+    entry.size = static_cast<int64_t>(info.st_size);
+    recording.files.push_back(entry);
+    recording.ready_ms = (TraceNowMicros() - begin_us) / 1000;
+  }
+
+  std::string pid_text;
+  int64_t begin_us;
+  std::unordered_set<std::string> seen;
+  std::string maps;
+};
+
+// Counts the pages of `fd` already in the page cache.
+int64_t ResidentBytes(int fd, int64_t size) {
+  void *mapping = mmap(nullptr, static_cast<size_t>(size), PROT_READ, MAP_SHARED, fd, 0);
+  if (mapping == MAP_FAILED) {
+    return 0;
+  }
+  const long pageSize = sysconf(_SC_PAGESIZE);
+  const size_t pages = static_cast<size_t>((size + pageSize - 1) / pageSize);
+  std::vector<unsigned char> residency(pages);
+  int64_t resident = 0;
+  if (mincore(mapping, static_cast<size_t>(size), residency.data()) == 0) {
+    for (unsigned char page : residency) {
+      resident += (page & 1u) != 0 ? pageSize : 0;
+    }
+  }
+  munmap(mapping, static_cast<size_t>(size));
+  return std::min(resident, size);
+}
+
+PrefetchStats ReplayProfile(const std::vector<PrefetchEntry> &files, int64_t budget_bytes) {
+  PrefetchStats stats;
+  const int64_t beginUs = TraceNowMicros();
+  for (const PrefetchEntry &entry : files) {
+    if (stats.requested_bytes >= budget_bytes) {
+      break;
+    }
+    const std::string path = entry.path.ToStdString(wxConvUTF8);
+    // O_NOATIME is refused for files the user does not own.
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC | O_NOATIME);
+    if (fd < 0) {
+      fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    }
+    if (fd < 0) {
+      continue;
+    }
+    struct stat info {};
+    if (fstat(fd, &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0) {
+      const int64_t size = static_cast<int64_t>(info.st_size);
+      stats.warmed_bytes += size - ResidentBytes(fd, size);
+      // WILLNEED queues readahead and returns without waiting for the I/O.
+      posix_fadvise(fd, 0, 0, POSIX_FADV_WILLNEED);
+      stats.requested_bytes += size;
+      ++stats.files;
+    }
+    close(fd);
+  }
+  stats.elapsed_us = TraceNowMicros() - beginUs;
+  return stats;
+}
+
+struct TrackedLaunch {
+  TrackedLaunch(PrefetchPlan launch_plan, long pid, const CancellationToken &launch_token)
+      : plan(std::move(launch_plan)), token(launch_token), sampler(pid, TraceNowMicros()),
+        end_us(TraceNowMicros() + std::chrono::duration_cast<std::chrono::microseconds>(
+                                      plan.settings.record_window)
+                                      .count()) {}
+
+  PrefetchPlan plan;
+  CancellationToken token;
+  AccessSampler sampler;
+  AccessRecording recording;
+  int64_t end_us;
+  bool alive = true;
+};
+
+// Runs on a scheduler worker once the record window is over.
+void ReportLaunch(const TrackedLaunch &launch) {
+  const PrefetchPlan &plan = launch.plan;
+  const AccessRecording &recording = launch.recording;
+  const wxString label = plan.mod.empty() ? wxString(wxT("Gothic")) : plan.mod;
+  if (plan.replay) {
+    if (!plan.replay->done.load(std::memory_order_acquire)) {
+      wxLogVerbose(wxT("Prefetch for %s did not finish within the record window"), label);
+      return;
+    }
+    const PrefetchStats &stats = plan.replay->stats;
+    RecordTraceCounter("prefetch_warmed_bytes", "prefetch", stats.warmed_bytes);
+    RecordTraceCounter("time_to_ready_ms", "prefetch", recording.ready_ms);
+    wxLogMessage(wxT("Prefetch for %s warmed %.1f of %.1f MB in %lu files (%.0f ms); "
+                     "time to ready %.1f s, %.1f s without prefetch"),
+                 label, Megabytes(stats.warmed_bytes), Megabytes(stats.requested_bytes),
+                 static_cast<unsigned long>(stats.files),
+                 static_cast<double>(stats.elapsed_us) / 1000.0,
+                 static_cast<double>(recording.ready_ms) / 1000.0,
+                 static_cast<double>(plan.profile.ready_ms) / 1000.0);
+    return;
+  }
+
+  // A session that ended inside the window is no representative startup.
+  if (!launch.alive || recording.files.empty()) {
+    return;
+  }
+  PrefetchProfile profile;
+  profile.recorded_unix = static_cast<int64_t>(std::time(nullptr));
+  profile.ready_ms = recording.ready_ms;
+  profile.files = recording.files;
+  int64_t totalBytes = 0;
+  for (const PrefetchEntry &entry : profile.files) {
+    totalBytes += entry.size;
+  }
+  wxString error;
+  if (!SavePrefetchProfile(plan.dir, plan.mod, profile, error)) {
+    wxLogWarning(wxT("%s"), error);
+    return;
+  }
+  wxLogMessage(wxT("Recorded prefetch profile for %s: %lu files, %.1f MB, ready after "
+                   "%.1f s"),
+               label, static_cast<unsigned long>(profile.files.size()),
+               Megabytes(totalBytes), static_cast<double>(profile.ready_ms) / 1000.0);
+}
+
+// One thread samples every launch inside its record window. It only has
+// work while a game runs, so it keeps SCHED_IDLE and the idle I/O class like
+// the scheduler's idle helper.
+class PrefetchRecorder {
+public:
+  ~PrefetchRecorder() { Stop(); }
+
+  void Track(std::unique_ptr<TrackedLaunch> launch) {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      if (stopping) {
+        return;
+      }
+      if (!thread.joinable()) {
+        thread = std::thread([this]() { Run(); });
+      }
+      added.push_back(std::move(launch));
+    }
+    wake.notify_one();
+  }
+
+  void Stop() {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      stopping = true;
+    }
+    wake.notify_one();
+    if (thread.joinable()) {
+      thread.join();
+    }
+  }
+
+private:
+  void Run() {
+    sched_param param{};
+    pthread_setschedparam(pthread_self(), SCHED_IDLE, &param);
+    LaunchProfile idle;
+    idle.io_class = IoPriorityClass::Idle;
+    wxArrayString warnings;
+    ApplyThreadLimits(idle, warnings);
+
+    std::vector<std::unique_ptr<TrackedLaunch>> active;
+    std::unique_lock<std::mutex> lock(mutex);
+    for (;;) {
+      wake.wait(lock, [&]() { return stopping || !added.empty() || !active.empty(); });
+      if (stopping) {
+        return;
+      }
+      for (std::unique_ptr<TrackedLaunch> &launch : added) {
+        active.push_back(std::move(launch));
+      }
+      added.clear();
+      lock.unlock();
+
+      const int64_t nowUs = TraceNowMicros();
+      for (auto it = active.begin(); it != active.end();) {
+        TrackedLaunch &launch = **it;
+        if (!launch.token.IsCancelled()) {
+          launch.alive = launch.sampler.Sample(launch.recording);
+          if (launch.alive && nowUs < launch.end_us) {
+            ++it;
+            continue;
+          }
+          std::shared_ptr<const TrackedLaunch> finished = std::move(*it);
+          GetTaskScheduler().Submit(
+              "PrefetchReport", TaskPriority::Normal, finished->token,
+              [finished](const CancellationToken &) { ReportLaunch(*finished); });
+        }
+        it = active.erase(it);
+      }
+
+      lock.lock();
+      if (!active.empty()) {
+        wake.wait_for(lock, kSampleInterval, [this]() { return stopping; });
+      }
+    }
+  }
+
+  std::mutex mutex;
+  std::condition_variable wake;
+  std::thread thread;
+  bool stopping = false;
+  std::vector<std::unique_ptr<TrackedLaunch>> added;
+};
+
+PrefetchRecorder gPrefetchRecorder;
+
+#endif
+
+} // namespace
+
+wxString GetPrefetchProfileDir() {
+  return wxFileName(GetUserStateDir(), wxT("prefetch")).GetFullPath();
+}
+
+bool LoadPrefetchProfile(const wxString &dir, const wxString &mod, int max_age_days,
+                         PrefetchProfile &profile, bool &found, wxString &error) {
+  error.clear();
+  profile = PrefetchProfile();
+  found = false;
+  std::lock_guard<std::mutex> lock(gPrefetchMutex);
+  const wxString path = ProfilePath(dir, mod);
+  if (!wxFileName::FileExists(path)) {
+    return true;
+  }
+
+  wxFFile file(path, wxT("rb"));
+  wxString text;
+  if (!file.IsOpened() || !file.ReadAll(&text, wxConvUTF8)) {
+    error = wxString::Format(wxT("Failed to read prefetch profile: %s"), path);
+    return false;
+  }
+  file.Close();
+
+  const wxArrayString lines = wxSplit(text, '\n', '\0');
+  const wxArrayString header =
+      lines.IsEmpty() ? wxArrayString() : wxSplit(lines[0], '\t', '\0');
+  long long recorded = 0;
+  long long ready = 0;
+  if (header.GetCount() != 3 || header[0] != wxString::FromUTF8(kProfileVersion) ||
+      !header[1].ToLongLong(&recorded) || !header[2].ToLongLong(&ready)) {
+    // Unknown or damaged profiles are re-recorded.
+    wxRemoveFile(path);
+    return true;
+  }
+
+  const int64_t ageSeconds = static_cast<int64_t>(std::time(nullptr)) - recorded;
+  if (ageSeconds > static_cast<int64_t>(max_age_days) * 24 * 60 * 60) {
+    wxRemoveFile(path);
+    wxLogMessage(wxT("Prefetch profile for %s aged out; recording a new one."),
+                 mod.empty() ? wxString(wxT("Gothic")) : mod);
+    return true;
+  }
+
+  profile.recorded_unix = static_cast<int64_t>(recorded);
+  profile.ready_ms = static_cast<int64_t>(ready);
+  for (size_t i = 1; i < lines.GetCount(); ++i) {
+    long long size = 0;
+    if (lines[i].BeforeFirst('\t').ToLongLong(&size) && lines[i].Contains(wxT("\t"))) {
+      PrefetchEntry entry;
+      entry.size = static_cast<int64_t>(size);
+      entry.path = lines[i].AfterFirst('\t');
+      profile.files.push_back(entry);
+    }
+  }
+  found = true;
+  return true;
+}
+
+bool SavePrefetchProfile(const wxString &dir, const wxString &mod,
+                         const PrefetchProfile &profile, wxString &error) {
+  error.clear();
+  std::lock_guard<std::mutex> lock(gPrefetchMutex);
+  if (!wxFileName::DirExists(dir) &&
+      !wxFileName::Mkdir(dir, wxS_DIR_DEFAULT, wxPATH_MKDIR_FULL)) {
+    error = wxString::Format(wxT("Failed to create prefetch directory: %s"), dir);
+    return false;
+  }
+
+  std::string text = std::string(kProfileVersion) + "\t" +
+                     std::to_string(profile.recorded_unix) + "\t" +
+                     std::to_string(profile.ready_ms) + "\n";
+  for (const PrefetchEntry &entry : profile.files) {
+    text += std::to_string(entry.size) + "\t" + entry.path.ToStdString(wxConvUTF8) + "\n";
+  }
+
+  // Write-then-rename so a concurrent reader never sees a partial profile.
+  const wxString path = ProfilePath(dir, mod);
+  const wxString temporary = path + wxT(".tmp");
+  wxFFile file(temporary, wxT("wb"));
+  if (!file.IsOpened() || file.Write(text.data(), text.size()) != text.size() ||
+      !file.Close() || !wxRenameFile(temporary, path, true)) {
+    error = wxString::Format(wxT("Failed to write prefetch profile: %s"), path);
+    return false;
+  }
+  return true;
+}
+
+PrefetchPlan BeginPrefetch(const wxString &dir, const wxString &mod,
+                           const PrefetchSettings &settings, const CancellationToken &token) {
+  PrefetchPlan plan;
+  plan.dir = dir;
+  plan.mod = mod;
+  plan.settings = settings;
+#if defined(__linux__)
+  bool found = false;
+  wxString error;
+  if (!LoadPrefetchProfile(dir, mod, settings.max_age_days, plan.profile, found, error)) {
+    wxLogWarning(wxT("%s"), error);
+  }
+  if (found && !plan.profile.files.empty()) {
+    // The game is about to read these files, so this is launch work rather
+    // than maintenance and is not throttled.
+    plan.replay = std::make_shared<PrefetchReplay>();
+    GetTaskScheduler().Submit(
+        "PrefetchReplay", TaskPriority::High, token,
+        [files = plan.profile.files, budget = settings.budget_bytes,
+         replay = plan.replay](const CancellationToken &) {
+          replay->stats = ReplayProfile(files, budget);
+          replay->done.store(true, std::memory_order_release);
+        });
+  }
+#else
+  (void)token;
+#endif
+  return plan;
+}
+
+void TrackPrefetchLaunch(PrefetchPlan plan, long pid, const CancellationToken &token) {
+#if defined(__linux__)
+  auto launch = std::make_unique<TrackedLaunch>(std::move(plan), pid, token);
+  gPrefetchRecorder.Track(std::move(launch));
+#else
+  (void)plan;
+  (void)pid;
+  (void)token;
+#endif
+}
+
+void StopPrefetchTracking() {
+#if defined(__linux__)
+  gPrefetchRecorder.Stop();
+#endif
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include "task_scheduler.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include <wx/string.h>
+
+// Learned per-mod file-access profiles. The first launch of a mod records
+// the files OpenGothic opens or maps during its first seconds; later
+// launches replay them as asynchronous readahead while the game spawns.
+// Linux only; elsewhere nothing is recorded or replayed.
+
+struct PrefetchEntry {
+  wxString path;
+  int64_t size = 0;
+};
+
+struct PrefetchProfile {
+  int64_t recorded_unix = 0;
+  // Time from spawn until the last new file was first seen; -1 if unknown.
+  int64_t ready_ms = -1;
+  std::vector<PrefetchEntry> files;
+};
+
+struct PrefetchStats {
+  size_t files = 0;
+  int64_t requested_bytes = 0;
+  // Bytes that were not in the page cache before readahead was issued.
+  int64_t warmed_bytes = 0;
+  int64_t elapsed_us = 0;
+};
+
+struct PrefetchSettings {
+  std::chrono::seconds record_window{30};
+  int max_age_days = 14;
+  int64_t budget_bytes = int64_t{1024} * 1024 * 1024;
+};
+
+// Filled in by the replay task; `stats` is valid once `done` is set.
+struct PrefetchReplay {
+  std::atomic<bool> done{false};
+  PrefetchStats stats;
+};
+
+struct PrefetchPlan {
+  wxString dir;
+  wxString mod;
+  PrefetchSettings settings;
+  PrefetchProfile profile;
+  // Set while the mod's profile is being replayed.
+  std::shared_ptr<PrefetchReplay> replay;
+};
+
+wxString GetPrefetchProfileDir();
+
+// Profiles older than `max_age_days` are deleted and reported as not found.
+bool LoadPrefetchProfile(const wxString &dir, const wxString &mod, int max_age_days,
+                         PrefetchProfile &profile, bool &found, wxString &error);
+bool SavePrefetchProfile(const wxString &dir, const wxString &mod,
+                         const PrefetchProfile &profile, wxString &error);
+
+// Loads the mod's profile and, if there is one, replays it as a
+// high-priority scheduler task. Call before spawning.
+PrefetchPlan BeginPrefetch(const wxString &dir, const wxString &mod,
+                           const PrefetchSettings &settings,
+                           const CancellationToken &token);
+// Samples /proc/<pid>/fd and /proc/<pid>/maps for the record window on the
+// shared recorder thread, which runs at idle priority, then stores a new
+// profile or logs bytes warmed and time-to-ready against the recorded
+// baseline from a scheduler task. Nothing is stored or logged once `token`
+// is cancelled.
+void TrackPrefetchLaunch(PrefetchPlan plan, long pid, const CancellationToken &token);
+// Joins the recorder thread and drops launches still inside their window.
+// Call before the task scheduler shuts down.
+void StopPrefetchTracking();
@@ -0,0 +1,330 @@
+#include "process_launcher.h"
+#include "trace.h"
+
+#include <string>
+#include <vector>
+#include <wx/process.h>
+#include <wx/utils.h>
+
+#if defined(__GLIBC__) &&                                                      \
+    (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 29))
+#define OGS_HAVE_POSIX_SPAWN_CHDIR 1
+#endif
+
+#if defined(OGS_HAVE_POSIX_SPAWN_CHDIR)
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <dirent.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <spawn.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+#endif
+
+namespace {
+
+bool EncodeCommand(const wxArrayString &command, std::vector<std::string> &storage,
+                   std::vector<char *> &argv, wxString &error) {
+  storage.clear();
+  storage.reserve(command.GetCount());
+  for (const wxString &arg : command) {
+    std::string utf8 = arg.ToStdString(wxConvUTF8);
+    if (!arg.empty() && utf8.empty()) {
+      error = wxT("Failed to encode command argument for process launch.");
+      return false;
+    }
+    storage.push_back(std::move(utf8));
+  }
+
+  argv.clear();
+  argv.reserve(storage.size() + 1);
+  for (std::string &arg : storage) {
+    argv.push_back(&arg[0]);
+  }
+  argv.push_back(nullptr);
+  return true;
+}
+
+#if defined(OGS_HAVE_POSIX_SPAWN_CHDIR)
+
+// Copies the launcher's environment with `overrides` replacing or adding
+// variables by name.
+bool EncodeEnvironment(const std::vector<std::pair<wxString, wxString>> &overrides,
+                       std::vector<std::string> &storage, std::vector<char *> &envp,
+                       wxString &error) {
+  storage.clear();
+  std::vector<std::string> names;
+  names.reserve(overrides.size());
+  for (const auto &variable : overrides) {
+    names.push_back(variable.first.ToStdString(wxConvUTF8) + "=");
+  }
+  for (char **entry = environ; *entry != nullptr; ++entry) {
+    const std::string value = *entry;
+    bool replaced = false;
+    for (const std::string &name : names) {
+      replaced = replaced || value.compare(0, name.size(), name) == 0;
+    }
+    if (!replaced) {
+      storage.push_back(value);
+    }
+  }
+  for (size_t i = 0; i < overrides.size(); ++i) {
+    const std::string value = overrides[i].second.ToStdString(wxConvUTF8);
+    if (names[i].size() == 1 || (!overrides[i].second.empty() && value.empty())) {
+      error = wxT("Failed to encode environment variable for process launch.");
+      return false;
+    }
+    storage.push_back(names[i] + value);
+  }
+
+  envp.clear();
+  envp.reserve(storage.size() + 1);
+  for (std::string &entry : storage) {
+    envp.push_back(&entry[0]);
+  }
+  envp.push_back(nullptr);
+  return true;
+}
+
+// Queues a close for every descriptor above stderr that would survive exec.
+// GTK, the config file and the log target all hold descriptors that the game
+// has no business inheriting.
+bool AddInheritedDescriptorCloses(posix_spawn_file_actions_t &actions) {
+  DIR *dir = opendir("/proc/self/fd");
+  if (dir == nullptr) {
+    return false;
+  }
+
+  const int dirFd = dirfd(dir);
+  std::vector<int> descriptors;
+  while (dirent *entry = readdir(dir)) {
+    char *end = nullptr;
+    const long fd = std::strtol(entry->d_name, &end, 10);
+    if (end == entry->d_name || *end != '\0' || fd <= STDERR_FILENO || fd == dirFd) {
+      continue;
+    }
+    const int flags = fcntl(static_cast<int>(fd), F_GETFD);
+    if (flags >= 0 && (flags & FD_CLOEXEC) == 0) {
+      descriptors.push_back(static_cast<int>(fd));
+    }
+  }
+  closedir(dir);
+
+  for (int fd : descriptors) {
+    if (posix_spawn_file_actions_addclose(&actions, fd) != 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool SpawnWithPosixSpawn(std::vector<char *> &argv, char **envp,
+                         const std::string &cwd, pid_t &pid, wxString &error) {
+  posix_spawn_file_actions_t actions;
+  posix_spawnattr_t attr;
+  if (posix_spawn_file_actions_init(&actions) != 0) {
+    error = wxT("posix_spawn_file_actions_init failed.");
+    return false;
+  }
+  if (posix_spawnattr_init(&attr) != 0) {
+    posix_spawn_file_actions_destroy(&actions);
+    error = wxT("posix_spawnattr_init failed.");
+    return false;
+  }
+
+  sigset_t emptyMask;
+  sigemptyset(&emptyMask);
+  sigset_t defaultSignals;
+  sigemptyset(&defaultSignals);
+  sigaddset(&defaultSignals, SIGPIPE);
+  sigaddset(&defaultSignals, SIGCHLD);
+
+  const short flags = POSIX_SPAWN_SETSIGMASK | POSIX_SPAWN_SETSIGDEF;
+  int rc = posix_spawnattr_setflags(&attr, flags);
+  if (rc == 0) {
+    rc = posix_spawnattr_setsigmask(&attr, &emptyMask);
+  }
+  if (rc == 0) {
+    rc = posix_spawnattr_setsigdefault(&attr, &defaultSignals);
+  }
+  if (rc == 0) {
+    rc = posix_spawn_file_actions_addchdir_np(&actions, cwd.c_str());
+  }
+  if (rc == 0) {
+    rc = posix_spawn_file_actions_addopen(&actions, STDIN_FILENO, "/dev/null",
+                                          O_RDONLY, 0);
+  }
+  if (rc == 0 && !AddInheritedDescriptorCloses(actions)) {
+    rc = EINVAL;
+  }
+  if (rc == 0) {
+    rc = posix_spawn(&pid, argv[0], &actions, &attr, argv.data(), envp);
+  }
+
+  posix_spawnattr_destroy(&attr);
+  posix_spawn_file_actions_destroy(&actions);
+  if (rc != 0) {
+    error = wxString::Format(wxT("posix_spawn failed: %s"),
+                             wxString::FromUTF8(std::strerror(rc)));
+    return false;
+  }
+  return true;
+}
+
+int64_t TimevalMicros(const timeval &value) {
+  return static_cast<int64_t>(value.tv_sec) * 1000000 + value.tv_usec;
+}
+
+void ReapInBackground(pid_t pid, int64_t begin_us, ProcessExitCallback on_exit) {
+  std::thread([pid, begin_us, callback = std::move(on_exit)]() {
+    int status = 0;
+    rusage usage{};
+    pid_t reaped = -1;
+    do {
+      reaped = wait4(pid, &status, 0, &usage);
+    } while (reaped < 0 && errno == EINTR);
+    if (reaped != pid || !callback) {
+      return;
+    }
+
+    ProcessExit exit;
+    exit.pid = static_cast<long>(pid);
+    exit.wall_us = TraceNowMicros() - begin_us;
+    if (WIFEXITED(status)) {
+      exit.exit_code = WEXITSTATUS(status);
+    } else if (WIFSIGNALED(status)) {
+      exit.term_signal = WTERMSIG(status);
+    }
+    exit.user_us = TimevalMicros(usage.ru_utime);
+    exit.system_us = TimevalMicros(usage.ru_stime);
+    exit.peak_rss_kb = usage.ru_maxrss;
+    exit.block_in = usage.ru_inblock;
+    exit.block_out = usage.ru_oublock;
+    callback(exit);
+  }).detach();
+}
+
+#else
+
+class ExitNotifyingProcess : public wxProcess {
+public:
+  ExitNotifyingProcess(int64_t spawn_begin_us, ProcessExitCallback callback)
+      : begin_us(spawn_begin_us), on_exit(std::move(callback)) {}
+
+  void OnTerminate(int pid, int status) override {
+    if (on_exit) {
+      ProcessExit exit;
+      exit.pid = pid;
+      exit.exit_code = status;
+      exit.wall_us = TraceNowMicros() - begin_us;
+      on_exit(exit);
+    }
+    delete this;
+  }
+
+private:
+  int64_t begin_us;
+  ProcessExitCallback on_exit;
+};
+
+#endif
+
+} // namespace
+
+bool SpawnProcess(const wxArrayString &command, const wxString &cwd,
+                  SpawnResult &result, wxString &error, ProcessExitCallback on_exit) {
+  return SpawnProcess(command, cwd, SpawnOptions(), result, error, std::move(on_exit));
+}
+
+bool SpawnProcess(const wxArrayString &command, const wxString &cwd,
+                  const SpawnOptions &options, SpawnResult &result, wxString &error,
+                  ProcessExitCallback on_exit) {
+  const LaunchProfile &profile = options.profile;
+  error.clear();
+  result = SpawnResult();
+  if (command.IsEmpty()) {
+    error = wxT("Launch command is empty.");
+    return false;
+  }
+
+  std::vector<std::string> storage;
+  std::vector<char *> argv;
+  if (!EncodeCommand(command, storage, argv, error)) {
+    return false;
+  }
+
+#if defined(OGS_HAVE_POSIX_SPAWN_CHDIR)
+  const std::string cwdUtf8 = cwd.ToStdString(wxConvUTF8);
+  if (!cwd.empty() && cwdUtf8.empty()) {
+    error = wxT("Failed to encode working directory for process launch.");
+    return false;
+  }
+
+  char **envp = environ;
+  std::vector<std::string> envStorage;
+  std::vector<char *> envPointers;
+  if (!options.environment.empty()) {
+    if (!EncodeEnvironment(options.environment, envStorage, envPointers, error)) {
+      return false;
+    }
+    envp = envPointers.data();
+  }
+
+  const int64_t beginUs = TraceNowMicros();
+  pid_t pid = 0;
+  bool spawned = false;
+  if (profile.HasThreadLimits()) {
+    // Affinity, nice and ioprio are per-thread on Linux and inherited by the
+    // child, so a throwaway thread keeps the launcher's own settings intact.
+    std::thread([&]() {
+      ApplyThreadLimits(profile, result.profile_warnings);
+      spawned = SpawnWithPosixSpawn(argv, envp, cwdUtf8, pid, error);
+    }).join();
+  } else {
+    spawned = SpawnWithPosixSpawn(argv, envp, cwdUtf8, pid, error);
+  }
+  if (!spawned) {
+    return false;
+  }
+  result.spawn_us = TraceNowMicros() - beginUs;
+  result.pid = static_cast<long>(pid);
+  PlaceInCgroup(result.pid, profile, result.profile_warnings);
+  if (!profile.IsEmpty()) {
+    result.applied_limits =
+        VerifyProcessLimits(result.pid, profile, result.profile_warnings);
+  }
+  ReapInBackground(pid, beginUs, std::move(on_exit));
+#else
+  wxExecuteEnv env;
+  env.cwd = cwd;
+  if (!options.environment.empty()) {
+    wxGetEnvMap(&env.env);
+    for (const auto &variable : options.environment) {
+      env.env[variable.first] = variable.second;
+    }
+  }
+  const int64_t beginUs = TraceNowMicros();
+  // The process object deletes itself in OnTerminate().
+  auto *process = new ExitNotifyingProcess(beginUs, std::move(on_exit));
+  result.pid = wxExecute(argv.data(), wxEXEC_ASYNC, process, &env);
+  result.spawn_us = TraceNowMicros() - beginUs;
+  if (result.pid == 0) {
+    delete process;
+    error = wxT("wxExecute failed to start the process.");
+    return false;
+  }
+  // Thread limits would land on the GUI thread here, so they are skipped.
+  if (profile.HasThreadLimits()) {
+    result.profile_warnings.Add(
+        wxT("CPU affinity, nice and I/O class profiles need posix_spawn support."));
+  }
+  PlaceInCgroup(result.pid, profile, result.profile_warnings);
+#endif
+
+  RecordTraceCounter("spawn_us", "launch", result.spawn_us);
+  return true;
+}
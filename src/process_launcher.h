@@ -0,0 +1,60 @@
+#pragma once
+
+#include "launch_profile.h"
+
+#include <cstdint>
+#include <functional>
+#include <utility>
+#include <vector>
+#include <wx/arrstr.h>
+#include <wx/string.h>
+
+struct SpawnResult {
+  long pid = 0;
+  // Time spent inside the spawn call, including exec on Linux.
+  int64_t spawn_us = 0;
+  // Limits read back from the child, and profile settings that could not be
+  // applied or did not stick. Both stay empty without a launch profile.
+  wxString applied_limits;
+  wxArrayString profile_warnings;
+};
+
+// Resource usage of a finished child. Fields that the platform cannot report
+// stay at -1.
+struct ProcessExit {
+  long pid = 0;
+  int exit_code = -1;
+  int term_signal = 0;
+  int64_t wall_us = 0;
+  int64_t user_us = -1;
+  int64_t system_us = -1;
+  int64_t peak_rss_kb = -1;
+  int64_t block_in = -1;
+  int64_t block_out = -1;
+};
+
+using ProcessExitCallback = std::function<void(const ProcessExit &)>;
+
+struct SpawnOptions {
+  LaunchProfile profile;
+  // Variables added to (or replaced in) the launcher's environment.
+  std::vector<std::pair<wxString, wxString>> environment;
+};
+
+// Starts `command` detached in `cwd`. On Linux this uses posix_spawn with
+// vfork semantics, closes every inherited descriptor above stderr, points
+// stdin at /dev/null and resets the signal mask; the child is reaped with
+// wait4() on a background thread, which also invokes `on_exit`. Other
+// platforms go through wxExecute and call `on_exit` on the main thread with
+// only the exit code and wall time filled in.
+//
+// A non-empty `options.profile` is applied on a short-lived spawning thread, so the
+// child inherits affinity, nice level and I/O class from its first
+// instruction; the cgroup move happens right after the spawn. Profile
+// failures never fail the launch and are reported in `result`.
+bool SpawnProcess(const wxArrayString &command, const wxString &cwd,
+                  const SpawnOptions &options, SpawnResult &result, wxString &error,
+                  ProcessExitCallback on_exit = ProcessExitCallback());
+bool SpawnProcess(const wxArrayString &command, const wxString &cwd,
+                  SpawnResult &result, wxString &error,
+                  ProcessExitCallback on_exit = ProcessExitCallback());
@@ -0,0 +1,255 @@
+#include "process_monitor.h"
+#include "trace.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <wx/ffile.h>
+
+#if defined(__linux__)
+#include <unistd.h>
+#endif
+
+namespace {
+
+#if defined(__linux__)
+
+struct RawSample {
+  uint64_t cpu_ticks = 0;
+  uint64_t start_time = 0;
+  int64_t rss_kb = 0;
+  int threads = 0;
+  bool has_io = false;
+  uint64_t read_bytes = 0;
+  uint64_t write_bytes = 0;
+};
+
+// Reads a small /proc file into `buffer` without allocating.
+bool ReadProcFile(long pid, const char *name, char *buffer, size_t size) {
+  char path[64];
+  std::snprintf(path, sizeof(path), "/proc/%ld/%s", pid, name);
+  FILE *file = std::fopen(path, "re");
+  if (file == nullptr) {
+    return false;
+  }
+  const size_t read = std::fread(buffer, 1, size - 1, file);
+  std::fclose(file);
+  buffer[read] = '\0';
+  return read > 0;
+}
+
+bool ReadRawSample(long pid, RawSample &sample) {
+  char buffer[1024];
+  if (!ReadProcFile(pid, "stat", buffer, sizeof(buffer))) {
+    return false;
+  }
+
+  // The command name may contain spaces and parentheses; fields resume after
+  // the last ')'. Field 3 is the state, 14/15 utime/stime, 20 num_threads and
+  // 22 starttime.
+  const char *cursor = std::strrchr(buffer, ')');
+  if (cursor == nullptr) {
+    return false;
+  }
+  cursor += 1;
+  char state = '\0';
+  uint64_t fields[23] = {};
+  int field = 3;
+  while (*cursor != '\0' && field <= 22) {
+    while (*cursor == ' ') {
+      ++cursor;
+    }
+    if (field == 3) {
+      state = *cursor;
+      ++cursor;
+    } else {
+      char *end = nullptr;
+      fields[field] = std::strtoull(cursor, &end, 10);
+      if (end == cursor) {
+        // Negative fields (priority, nice) are irrelevant here; skip them.
+        while (*cursor != ' ' && *cursor != '\0') {
+          ++cursor;
+        }
+      } else {
+        cursor = end;
+      }
+    }
+    ++field;
+  }
+  if (field <= 22 || state == 'Z' || state == 'X') {
+    return false;
+  }
+  sample.cpu_ticks = fields[14] + fields[15];
+  sample.threads = static_cast<int>(fields[20]);
+  sample.start_time = fields[22];
+
+  if (ReadProcFile(pid, "statm", buffer, sizeof(buffer))) {
+    unsigned long long sizePages = 0;
+    unsigned long long residentPages = 0;
+    if (std::sscanf(buffer, "%llu %llu", &sizePages, &residentPages) == 2) {
+      static const long pageKb = sysconf(_SC_PAGESIZE) / 1024;
+      sample.rss_kb = static_cast<int64_t>(residentPages) * pageKb;
+    }
+  }
+
+  sample.has_io = ReadProcFile(pid, "io", buffer, sizeof(buffer));
+  if (sample.has_io) {
+    const char *read = std::strstr(buffer, "\nread_bytes:");
+    const char *write = std::strstr(buffer, "\nwrite_bytes:");
+    sample.has_io = read != nullptr && write != nullptr;
+    if (sample.has_io) {
+      sample.read_bytes = std::strtoull(read + 12, nullptr, 10);
+      sample.write_bytes = std::strtoull(write + 13, nullptr, 10);
+    }
+  }
+  return true;
+}
+
+#endif
+
+} // namespace
+
+ProcessMonitor::~ProcessMonitor() { Stop(); }
+
+bool ProcessMonitor::Start(long target_pid, std::chrono::milliseconds interval,
+                           wxString &error) {
+  error.clear();
+  Stop();
+
+#if defined(__linux__)
+  RawSample first;
+  if (!ReadRawSample(target_pid, first)) {
+    error = wxString::Format(wxT("Process %ld is not running."), target_pid);
+    return false;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    pid = target_pid;
+    samples.clear();
+    samples.reserve(kMaxSamples);
+    next_sample = 0;
+    stop_requested = false;
+    running = true;
+  }
+  worker = std::thread(&ProcessMonitor::Run, this, std::max(interval, kMinInterval),
+                       first.start_time);
+  return true;
+#else
+  (void)target_pid;
+  (void)interval;
+  error = wxT("Process monitoring is only supported on Linux.");
+  return false;
+#endif
+}
+
+void ProcessMonitor::Stop() {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stop_requested = true;
+  }
+  wake.notify_all();
+  if (worker.joinable()) {
+    worker.join();
+  }
+}
+
+bool ProcessMonitor::IsRunning() const {
+  std::lock_guard<std::mutex> lock(mutex);
+  return running;
+}
+
+std::vector<ProcessSample> ProcessMonitor::GetSamples() const {
+  std::lock_guard<std::mutex> lock(mutex);
+  if (samples.size() < kMaxSamples) {
+    return samples;
+  }
+  // Unroll the ring into chronological order.
+  std::vector<ProcessSample> ordered;
+  ordered.reserve(samples.size());
+  ordered.insert(ordered.end(), samples.begin() + static_cast<std::ptrdiff_t>(next_sample),
+                 samples.end());
+  ordered.insert(ordered.end(), samples.begin(),
+                 samples.begin() + static_cast<std::ptrdiff_t>(next_sample));
+  return ordered;
+}
+
+bool ProcessMonitor::ExportCsv(const wxString &path, wxString &error) const {
+  error.clear();
+  const std::vector<ProcessSample> snapshot = GetSamples();
+
+  std::string csv = "elapsed_s,cpu_percent,rss_kb,threads,read_bytes_per_s,"
+                    "write_bytes_per_s\n";
+  const int64_t origin = snapshot.empty() ? 0 : snapshot.front().timestamp_us;
+  char line[160];
+  for (const ProcessSample &sample : snapshot) {
+    std::snprintf(line, sizeof(line), "%.3f,%.1f,%lld,%d,%.0f,%.0f\n",
+                  static_cast<double>(sample.timestamp_us - origin) / 1e6,
+                  sample.cpu_percent, static_cast<long long>(sample.rss_kb),
+                  sample.threads, sample.read_bytes_per_s, sample.write_bytes_per_s);
+    csv += line;
+  }
+
+  wxFFile file(path, wxT("wb"));
+  if (!file.IsOpened() || file.Write(csv.data(), csv.size()) != csv.size()) {
+    error = wxString::Format(wxT("Failed to write CSV file: %s"), path);
+    return false;
+  }
+  return true;
+}
+
+void ProcessMonitor::Run(std::chrono::milliseconds interval, uint64_t start_time) {
+#if defined(__linux__)
+  static const double ticksPerSecond = static_cast<double>(sysconf(_SC_CLK_TCK));
+  RawSample previous;
+  int64_t previousUs = TraceNowMicros();
+  bool havePrevious = ReadRawSample(pid, previous);
+
+  std::unique_lock<std::mutex> lock(mutex);
+  while (havePrevious && !stop_requested) {
+    if (wake.wait_for(lock, interval, [this] { return stop_requested; })) {
+      break;
+    }
+    lock.unlock();
+
+    RawSample current;
+    const int64_t nowUs = TraceNowMicros();
+    const bool alive = ReadRawSample(pid, current) && current.start_time == start_time;
+    ProcessSample sample;
+    if (alive) {
+      const double elapsed = static_cast<double>(nowUs - previousUs) / 1e6;
+      sample.timestamp_us = nowUs;
+      sample.cpu_percent =
+          elapsed > 0.0 ? static_cast<double>(current.cpu_ticks - previous.cpu_ticks) /
+                              ticksPerSecond / elapsed * 100.0
+                        : 0.0;
+      sample.rss_kb = current.rss_kb;
+      sample.threads = current.threads;
+      if (current.has_io && previous.has_io && elapsed > 0.0) {
+        sample.read_bytes_per_s =
+            static_cast<double>(current.read_bytes - previous.read_bytes) / elapsed;
+        sample.write_bytes_per_s =
+            static_cast<double>(current.write_bytes - previous.write_bytes) / elapsed;
+      }
+      previous = current;
+      previousUs = nowUs;
+    }
+
+    lock.lock();
+    if (!alive) {
+      break;
+    }
+    if (samples.size() < kMaxSamples) {
+      samples.push_back(sample);
+    } else {
+      samples[next_sample] = sample;
+    }
+    next_sample = (next_sample + 1) % kMaxSamples;
+  }
+  running = false;
+#else
+  (void)interval;
+  (void)start_time;
+#endif
+}
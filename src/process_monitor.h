@@ -0,0 +1,56 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <wx/string.h>
+
+struct ProcessSample {
+  int64_t timestamp_us = 0;
+  double cpu_percent = 0.0;
+  int64_t rss_kb = 0;
+  int threads = 0;
+  // -1 when /proc/<pid>/io is not readable.
+  double read_bytes_per_s = -1.0;
+  double write_bytes_per_s = -1.0;
+};
+
+// Samples /proc/<pid>/{stat,statm,io} on a background thread. Each sample
+// reads three small files into fixed buffers and the history is a ring of at
+// most kMaxSamples entries, so cost is bounded regardless of session length.
+// Sampling stops on its own once the process is gone or its PID is reused.
+// Linux only; Start() fails elsewhere.
+class ProcessMonitor {
+public:
+  static constexpr size_t kMaxSamples = 3600;
+  static constexpr std::chrono::milliseconds kMinInterval{100};
+
+  ProcessMonitor() = default;
+  ~ProcessMonitor();
+
+  ProcessMonitor(const ProcessMonitor &) = delete;
+  ProcessMonitor &operator=(const ProcessMonitor &) = delete;
+
+  bool Start(long pid, std::chrono::milliseconds interval, wxString &error);
+  void Stop();
+
+  bool IsRunning() const;
+  long GetPid() const { return pid; }
+  std::vector<ProcessSample> GetSamples() const;
+  bool ExportCsv(const wxString &path, wxString &error) const;
+
+private:
+  void Run(std::chrono::milliseconds interval, uint64_t start_time);
+
+  long pid = 0;
+  std::thread worker;
+  mutable std::mutex mutex;
+  std::condition_variable wake;
+  bool stop_requested = false;
+  bool running = false;
+  std::vector<ProcessSample> samples;
+  size_t next_sample = 0;
+};
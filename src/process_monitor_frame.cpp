@@ -0,0 +1,188 @@
+#include "process_monitor_frame.h"
+
+#include <algorithm>
+#include <vector>
+#include <wx/button.h>
+#include <wx/dcbuffer.h>
+#include <wx/filedlg.h>
+#include <wx/intl.h>
+#include <wx/log.h>
+#include <wx/msgdlg.h>
+#include <wx/panel.h>
+#include <wx/sizer.h>
+#include <wx/stattext.h>
+
+namespace {
+
+constexpr int kSizerExpandAll = static_cast<int>(wxALL) | static_cast<int>(wxEXPAND);
+constexpr size_t kVisibleSamples = 120;
+
+} // namespace
+
+// Draws the most recent kVisibleSamples values of one or two series, scaled
+// to the larger of the visible maximum and `floor`.
+class SparklinePanel : public wxPanel {
+public:
+  SparklinePanel(wxWindow *parent, const wxString &label, double floor)
+      : wxPanel(parent, wxID_ANY, wxDefaultPosition, wxSize(360, 56)), title(label),
+        min_scale(floor) {
+    SetBackgroundStyle(wxBG_STYLE_PAINT);
+    Bind(wxEVT_PAINT, &SparklinePanel::OnPaint, this);
+  }
+
+  void SetValues(std::vector<double> first, std::vector<double> second,
+                 const wxString &current) {
+    primary = std::move(first);
+    secondary = std::move(second);
+    value_text = current;
+    Refresh(false);
+  }
+
+private:
+  void DrawSeries(wxDC &dc, const std::vector<double> &series, double scale,
+                  const wxSize &size, int top) {
+    if (series.size() < 2) {
+      return;
+    }
+    const size_t first = series.size() > kVisibleSamples ? series.size() - kVisibleSamples : 0;
+    const int height = std::max(size.GetHeight() - top - 2, 1);
+    const double step =
+        static_cast<double>(size.GetWidth() - 1) / static_cast<double>(kVisibleSamples - 1);
+    std::vector<wxPoint> points;
+    points.reserve(series.size() - first);
+    for (size_t i = first; i < series.size(); ++i) {
+      const double value = std::max(series[i], 0.0);
+      points.emplace_back(static_cast<int>(static_cast<double>(i - first) * step),
+                          top + height - static_cast<int>(value / scale * height));
+    }
+    dc.DrawLines(static_cast<int>(points.size()), points.data());
+  }
+
+  void OnPaint(wxPaintEvent &) {
+    wxAutoBufferedPaintDC dc(this);
+    dc.SetBackground(*wxWHITE_BRUSH);
+    dc.Clear();
+
+    double scale = min_scale;
+    for (const std::vector<double> *series : {&primary, &secondary}) {
+      const size_t first =
+          series->size() > kVisibleSamples ? series->size() - kVisibleSamples : 0;
+      for (size_t i = first; i < series->size(); ++i) {
+        scale = std::max(scale, (*series)[i]);
+      }
+    }
+
+    dc.SetTextForeground(*wxBLACK);
+    dc.DrawText(title + wxT(": ") + value_text, 4, 2);
+    const int top = dc.GetTextExtent(title).GetHeight() + 4;
+    const wxSize size = GetClientSize();
+    dc.SetPen(wxPen(wxColour(0, 102, 204), 2));
+    DrawSeries(dc, primary, scale, size, top);
+    dc.SetPen(wxPen(wxColour(204, 85, 0), 2));
+    DrawSeries(dc, secondary, scale, size, top);
+  }
+
+  wxString title;
+  wxString value_text;
+  double min_scale;
+  std::vector<double> primary;
+  std::vector<double> secondary;
+};
+
+ProcessMonitorFrame::ProcessMonitorFrame(wxWindow *parent, const wxString &gameTitle,
+                                         std::unique_ptr<ProcessMonitor> processMonitor,
+                                         int refreshIntervalMs)
+    : wxFrame(parent, wxID_ANY, wxString::Format(_("Process Monitor: %s"), gameTitle),
+              wxDefaultPosition, wxSize(420, 380)),
+      monitor(std::move(processMonitor)), refresh_timer(this) {
+  auto *panel = new wxPanel(this);
+  auto *mainSizer = new wxBoxSizer(wxVERTICAL);
+
+  status_text = new wxStaticText(
+      panel, wxID_ANY, wxString::Format(_("Monitoring PID %ld"), monitor->GetPid()));
+  cpu_line = new SparklinePanel(panel, _("CPU"), 100.0);
+  rss_line = new SparklinePanel(panel, _("Memory"), 64.0);
+  threads_line = new SparklinePanel(panel, _("Threads"), 8.0);
+  io_line = new SparklinePanel(panel, _("Disk read / write"), 1.0);
+
+  mainSizer->Add(status_text, 0, kSizerExpandAll, 5);
+  for (SparklinePanel *line : {cpu_line, rss_line, threads_line, io_line}) {
+    mainSizer->Add(line, 1, kSizerExpandAll, 5);
+  }
+
+  auto *buttonSizer = new wxBoxSizer(wxHORIZONTAL);
+  auto *exportButton = new wxButton(panel, wxID_ANY, _("Export CSV..."));
+  exportButton->Bind(wxEVT_BUTTON, [this](wxCommandEvent &) { DoExport(); });
+  auto *closeButton = new wxButton(panel, wxID_CLOSE);
+  closeButton->Bind(wxEVT_BUTTON, [this](wxCommandEvent &) { Close(); });
+  buttonSizer->Add(exportButton);
+  buttonSizer->AddStretchSpacer();
+  buttonSizer->Add(closeButton);
+  mainSizer->Add(buttonSizer, 0, kSizerExpandAll, 5);
+
+  panel->SetSizer(mainSizer);
+
+  Bind(wxEVT_TIMER, &ProcessMonitorFrame::OnRefresh, this);
+  Bind(wxEVT_CLOSE_WINDOW, &ProcessMonitorFrame::OnClose, this);
+  refresh_timer.Start(refreshIntervalMs);
+}
+
+void ProcessMonitorFrame::OnRefresh(wxTimerEvent &) {
+  const std::vector<ProcessSample> samples = monitor->GetSamples();
+  std::vector<double> cpu, rss, threads, reads, writes;
+  cpu.reserve(samples.size());
+  rss.reserve(samples.size());
+  threads.reserve(samples.size());
+  reads.reserve(samples.size());
+  writes.reserve(samples.size());
+  constexpr double kBytesToMegabytes = 1.0 / (1024.0 * 1024.0);
+  for (const ProcessSample &sample : samples) {
+    cpu.push_back(sample.cpu_percent);
+    rss.push_back(static_cast<double>(sample.rss_kb) / 1024.0);
+    threads.push_back(sample.threads);
+    reads.push_back(sample.read_bytes_per_s * kBytesToMegabytes);
+    writes.push_back(sample.write_bytes_per_s * kBytesToMegabytes);
+  }
+
+  if (!samples.empty()) {
+    const ProcessSample &last = samples.back();
+    cpu_line->SetValues(std::move(cpu), {}, wxString::Format(wxT("%.0f%%"), last.cpu_percent));
+    rss_line->SetValues(std::move(rss), {},
+                        wxString::Format(wxT("%.1f MB"),
+                                         static_cast<double>(last.rss_kb) / 1024.0));
+    threads_line->SetValues(std::move(threads), {}, wxString::Format(wxT("%d"), last.threads));
+    io_line->SetValues(std::move(reads), std::move(writes),
+                       last.read_bytes_per_s < 0.0
+                           ? wxString(wxT("-"))
+                           : wxString::Format(wxT("%.1f / %.1f MB/s"),
+                                              last.read_bytes_per_s * kBytesToMegabytes,
+                                              last.write_bytes_per_s * kBytesToMegabytes));
+  }
+
+  if (!monitor->IsRunning()) {
+    refresh_timer.Stop();
+    status_text->SetLabel(
+        wxString::Format(_("PID %ld exited; monitoring stopped."), monitor->GetPid()));
+  }
+}
+
+void ProcessMonitorFrame::OnClose(wxCloseEvent &event) {
+  refresh_timer.Stop();
+  monitor->Stop();
+  event.Skip();
+}
+
+void ProcessMonitorFrame::DoExport() {
+  wxFileDialog dialog(this, _("Export Samples"), wxEmptyString,
+                      wxString::Format(wxT("opengothic-%ld.csv"), monitor->GetPid()),
+                      _("CSV files (*.csv)|*.csv"), wxFD_SAVE | wxFD_OVERWRITE_PROMPT);
+  if (dialog.ShowModal() != wxID_OK) {
+    return;
+  }
+
+  wxString exportError;
+  if (!monitor->ExportCsv(dialog.GetPath(), exportError)) {
+    wxLogError(wxT("%s"), exportError);
+    wxMessageBox(exportError, _("Export Failed"), wxOK | wxICON_ERROR, this);
+  }
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include "process_monitor.h"
+
+#include <memory>
+#include <wx/frame.h>
+#include <wx/timer.h>
+
+class wxStaticText;
+
+class SparklinePanel;
+
+// Live view of a ProcessMonitor. The frame owns the monitor and stops it when
+// closed; samples are pulled on a wxTimer so the sampler thread never touches
+// the GUI.
+class ProcessMonitorFrame : public wxFrame {
+public:
+  ProcessMonitorFrame(wxWindow *parent, const wxString &gameTitle,
+                      std::unique_ptr<ProcessMonitor> processMonitor,
+                      int refreshIntervalMs);
+
+private:
+  void OnRefresh(wxTimerEvent &);
+  void OnClose(wxCloseEvent &event);
+  void DoExport();
+
+  std::unique_ptr<ProcessMonitor> monitor;
+  wxTimer refresh_timer;
+  wxStaticText *status_text;
+  SparklinePanel *cpu_line;
+  SparklinePanel *rss_line;
+  SparklinePanel *threads_line;
+  SparklinePanel *io_line;
+};
@@ -0,0 +1,333 @@
+#include "run_history.h"
+#include "runtime_paths.h"
+#include "text_hash.h"
+
+#include <algorithm>
+#include <mutex>
+#include <string>
+#include <wx/arrstr.h>
+#include <wx/ffile.h>
+#include <wx/filename.h>
+#include <wx/log.h>
+
+namespace {
+
+constexpr size_t kIndexEntrySize = 16;
+constexpr size_t kIndexChunkEntries = 256;
+constexpr size_t kRecordFieldCount = 12;
+// Set in an entry's length for a log line that is not a valid record. Such
+// lines are still indexed so the index always ends where the log ends.
+constexpr uint32_t kSkippedLine = 0x80000000u;
+const char kRecordVersion[] = "1";
+
+// Serializes appends from the reaper threads with reads on the UI thread.
+std::mutex gHistoryMutex;
+
+struct IndexEntry {
+  uint64_t offset;
+  uint32_t length;
+  uint32_t mod_hash;
+};
+
+wxString LogPath(const wxString &dir) {
+  return wxFileName(dir, wxT("runs.log")).GetFullPath();
+}
+
+wxString IndexPath(const wxString &dir) {
+  return wxFileName(dir, wxT("runs.idx")).GetFullPath();
+}
+
+uint32_t HashMod(const wxString &mod) { return HashUtf8Fnv32(mod.Lower()); }
+
+void EncodeIndexEntry(const IndexEntry &entry, unsigned char *out) {
+  for (size_t i = 0; i < 8; ++i) {
+    out[i] = static_cast<unsigned char>((entry.offset >> (8 * i)) & 0xFFu);
+  }
+  for (size_t i = 0; i < 4; ++i) {
+    out[8 + i] = static_cast<unsigned char>((entry.length >> (8 * i)) & 0xFFu);
+    out[12 + i] = static_cast<unsigned char>((entry.mod_hash >> (8 * i)) & 0xFFu);
+  }
+}
+
+IndexEntry DecodeIndexEntry(const unsigned char *in) {
+  IndexEntry entry{0, 0, 0};
+  for (size_t i = 0; i < 8; ++i) {
+    entry.offset |= static_cast<uint64_t>(in[i]) << (8 * i);
+  }
+  for (size_t i = 0; i < 4; ++i) {
+    entry.length |= static_cast<uint32_t>(in[8 + i]) << (8 * i);
+    entry.mod_hash |= static_cast<uint32_t>(in[12 + i]) << (8 * i);
+  }
+  return entry;
+}
+
+wxString SanitizeField(const wxString &value) {
+  wxString sanitized = value;
+  sanitized.Replace(wxT("\t"), wxT(" "));
+  sanitized.Replace(wxT("\r"), wxT(" "));
+  sanitized.Replace(wxT("\n"), wxT(" "));
+  return sanitized;
+}
+
+std::string FormatRecord(const RunRecord &record) {
+  const wxString line = wxString::Format(
+      wxT("%s\t%lld\t%lld\t%lld\t%lld\t%lld\t%lld\t%lld\t%d\t%d\t%s\t%s\n"),
+      kRecordVersion, static_cast<long long>(record.started_unix),
+      static_cast<long long>(record.wall_ms), static_cast<long long>(record.user_ms),
+      static_cast<long long>(record.system_ms),
+      static_cast<long long>(record.peak_rss_kb),
+      static_cast<long long>(record.block_in), static_cast<long long>(record.block_out),
+      record.exit_code, record.term_signal, SanitizeField(record.mod),
+      SanitizeField(record.flags));
+  return line.ToStdString(wxConvUTF8);
+}
+
+bool ParseRecord(const std::string &line, RunRecord &record) {
+  wxString text = wxString::FromUTF8(line.c_str());
+  if (text.EndsWith(wxT("\n"))) {
+    text.RemoveLast();
+  }
+  const wxArrayString fields = wxSplit(text, '\t', '\0');
+  // A trailing empty flags field may be dropped by the split.
+  if (fields.GetCount() + 1 < kRecordFieldCount || fields[0] != kRecordVersion) {
+    return false;
+  }
+
+  long long values[7] = {};
+  for (size_t i = 0; i < 7; ++i) {
+    if (!fields[i + 1].ToLongLong(&values[i])) {
+      return false;
+    }
+  }
+  long exitCode = 0;
+  long termSignal = 0;
+  if (!fields[8].ToLong(&exitCode) || !fields[9].ToLong(&termSignal)) {
+    return false;
+  }
+
+  record.started_unix = values[0];
+  record.wall_ms = values[1];
+  record.user_ms = values[2];
+  record.system_ms = values[3];
+  record.peak_rss_kb = values[4];
+  record.block_in = values[5];
+  record.block_out = values[6];
+  record.exit_code = static_cast<int>(exitCode);
+  record.term_signal = static_cast<int>(termSignal);
+  record.mod = fields[10];
+  record.flags = fields.GetCount() > 11 ? fields[11] : wxString();
+  return true;
+}
+
+bool ReadWholeFile(const wxString &path, std::string &content) {
+  content.clear();
+  if (!wxFileName::FileExists(path)) {
+    return true;
+  }
+  wxFFile file(path, wxT("rb"));
+  if (!file.IsOpened()) {
+    return false;
+  }
+  const wxFileOffset length = file.Length();
+  if (length < 0) {
+    return false;
+  }
+  content.resize(static_cast<size_t>(length));
+  return content.empty() || file.Read(&content[0], content.size()) == content.size();
+}
+
+bool RebuildIndex(const wxString &dir, wxString &error) {
+  std::string log;
+  if (!ReadWholeFile(LogPath(dir), log)) {
+    error = wxString::Format(wxT("Failed to read run history: %s"), LogPath(dir));
+    return false;
+  }
+
+  std::string index;
+  size_t offset = 0;
+  while (offset < log.size()) {
+    size_t end = log.find('\n', offset);
+    // A torn final line from an interrupted append has no newline; it is
+    // skipped like any other line that does not parse.
+    const bool torn = end == std::string::npos;
+    end = torn ? log.size() : end + 1;
+    const uint32_t length = static_cast<uint32_t>(end - offset);
+    RunRecord record;
+    IndexEntry entry{offset, length | kSkippedLine, 0};
+    if (!torn && length < kSkippedLine && ParseRecord(log.substr(offset, length), record)) {
+      entry = IndexEntry{offset, length, HashMod(record.mod)};
+    }
+    unsigned char encoded[kIndexEntrySize];
+    EncodeIndexEntry(entry, encoded);
+    index.append(reinterpret_cast<const char *>(encoded), kIndexEntrySize);
+    offset = end;
+  }
+
+  wxFFile file(IndexPath(dir), wxT("wb"));
+  if (!file.IsOpened() || file.Write(index.data(), index.size()) != index.size()) {
+    error = wxString::Format(wxT("Failed to write run history index: %s"),
+                             IndexPath(dir));
+    return false;
+  }
+  wxLogMessage(wxT("Rebuilt run history index with %lu entries"),
+               static_cast<unsigned long>(index.size() / kIndexEntrySize));
+  return true;
+}
+
+wxFileOffset FileLength(const wxString &path) {
+  if (!wxFileName::FileExists(path)) {
+    return 0;
+  }
+  wxFFile file(path, wxT("rb"));
+  return file.IsOpened() ? file.Length() : -1;
+}
+
+// The index is current when its last entry ends exactly where the log ends.
+bool IndexMatchesLog(const wxString &dir) {
+  const wxFileOffset logLength = FileLength(LogPath(dir));
+  const wxFileOffset indexLength = FileLength(IndexPath(dir));
+  const wxFileOffset entrySize = static_cast<wxFileOffset>(kIndexEntrySize);
+  if (logLength < 0 || indexLength < 0 || indexLength % entrySize != 0) {
+    return false;
+  }
+  if (indexLength == 0) {
+    return logLength == 0;
+  }
+
+  wxFFile index(IndexPath(dir), wxT("rb"));
+  unsigned char encoded[kIndexEntrySize];
+  if (!index.IsOpened() || !index.Seek(indexLength - entrySize) ||
+      index.Read(encoded, kIndexEntrySize) != kIndexEntrySize) {
+    return false;
+  }
+  const IndexEntry last = DecodeIndexEntry(encoded);
+  return last.offset + (last.length & ~kSkippedLine) == static_cast<uint64_t>(logLength);
+}
+
+bool EndsWithNewline(const wxString &path, wxFileOffset length) {
+  wxFFile file(path, wxT("rb"));
+  char last = '\0';
+  return file.IsOpened() && file.Seek(length - 1) && file.Read(&last, 1) == 1 &&
+         last == '\n';
+}
+
+bool EnsureIndex(const wxString &dir, wxString &error) {
+  return IndexMatchesLog(dir) || RebuildIndex(dir, error);
+}
+
+} // namespace
+
+wxString GetRunHistoryDir() { return GetUserStateDir(); }
+
+RunRecord MakeRunRecord(const ProcessExit &exit, int64_t started_unix,
+                        const wxString &mod, const wxString &flags) {
+  RunRecord record;
+  record.started_unix = started_unix;
+  record.wall_ms = exit.wall_us / 1000;
+  record.user_ms = exit.user_us < 0 ? -1 : exit.user_us / 1000;
+  record.system_ms = exit.system_us < 0 ? -1 : exit.system_us / 1000;
+  record.peak_rss_kb = exit.peak_rss_kb;
+  record.block_in = exit.block_in;
+  record.block_out = exit.block_out;
+  record.exit_code = exit.exit_code;
+  record.term_signal = exit.term_signal;
+  record.mod = mod;
+  record.flags = flags;
+  return record;
+}
+
+bool AppendRunRecord(const wxString &dir, const RunRecord &record, wxString &error) {
+  error.clear();
+  std::lock_guard<std::mutex> lock(gHistoryMutex);
+  if (!wxFileName::DirExists(dir) &&
+      !wxFileName::Mkdir(dir, wxS_DIR_DEFAULT, wxPATH_MKDIR_FULL)) {
+    error = wxString::Format(wxT("Failed to create run history directory: %s"), dir);
+    return false;
+  }
+  if (!EnsureIndex(dir, error)) {
+    return false;
+  }
+
+  const std::string line = FormatRecord(record);
+  wxFFile log(LogPath(dir), wxT("ab"));
+  wxFileOffset offset = log.IsOpened() ? log.Length() : -1;
+  // Terminate a torn line left by an interrupted append so it stays isolated.
+  if (offset > 0 && !EndsWithNewline(LogPath(dir), offset)) {
+    if (log.Write("\n", 1) != 1) {
+      offset = -1;
+    } else {
+      ++offset;
+    }
+  }
+  if (offset < 0 || log.Write(line.data(), line.size()) != line.size() || !log.Flush()) {
+    error = wxString::Format(wxT("Failed to append run history: %s"), LogPath(dir));
+    return false;
+  }
+  log.Close();
+
+  unsigned char encoded[kIndexEntrySize];
+  EncodeIndexEntry(IndexEntry{static_cast<uint64_t>(offset),
+                              static_cast<uint32_t>(line.size()), HashMod(record.mod)},
+                   encoded);
+  wxFFile index(IndexPath(dir), wxT("ab"));
+  if (!index.IsOpened() || index.Write(encoded, kIndexEntrySize) != kIndexEntrySize) {
+    // The next append or read notices the stale index and rebuilds it.
+    error = wxString::Format(wxT("Failed to update run history index: %s"),
+                             IndexPath(dir));
+    return false;
+  }
+  return true;
+}
+
+bool ReadRecentRuns(const wxString &dir, const wxString &mod, size_t limit,
+                    std::vector<RunRecord> &records, wxString &error) {
+  error.clear();
+  records.clear();
+  std::lock_guard<std::mutex> lock(gHistoryMutex);
+  if (limit == 0 || !wxFileName::FileExists(LogPath(dir))) {
+    return true;
+  }
+  if (!EnsureIndex(dir, error)) {
+    return false;
+  }
+
+  wxFFile index(IndexPath(dir), wxT("rb"));
+  wxFFile log(LogPath(dir), wxT("rb"));
+  if (!index.IsOpened() || !log.IsOpened()) {
+    error = wxString::Format(wxT("Failed to open run history in: %s"), dir);
+    return false;
+  }
+
+  const uint32_t modHash = HashMod(mod);
+  size_t remaining = static_cast<size_t>(index.Length()) / kIndexEntrySize;
+  std::vector<unsigned char> chunk(kIndexChunkEntries * kIndexEntrySize);
+  std::string line;
+  while (remaining > 0 && records.size() < limit) {
+    const size_t count = std::min(remaining, kIndexChunkEntries);
+    remaining -= count;
+    const size_t bytes = count * kIndexEntrySize;
+    if (!index.Seek(static_cast<wxFileOffset>(remaining * kIndexEntrySize)) ||
+        index.Read(chunk.data(), bytes) != bytes) {
+      error = wxString::Format(wxT("Failed to read run history index: %s"),
+                               IndexPath(dir));
+      return false;
+    }
+
+    for (size_t i = count; i-- > 0 && records.size() < limit;) {
+      const IndexEntry entry = DecodeIndexEntry(chunk.data() + i * kIndexEntrySize);
+      if ((entry.length & kSkippedLine) != 0 || entry.mod_hash != modHash) {
+        continue;
+      }
+      line.resize(entry.length);
+      if (!log.Seek(static_cast<wxFileOffset>(entry.offset)) ||
+          log.Read(&line[0], line.size()) != line.size()) {
+        continue;
+      }
+      RunRecord record;
+      if (ParseRecord(line, record) && record.mod.IsSameAs(mod, false)) {
+        records.push_back(record);
+      }
+    }
+  }
+  return true;
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "process_launcher.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <wx/string.h>
+
+// One finished game session. Resource fields are -1 when the platform could
+// not report them.
+struct RunRecord {
+  int64_t started_unix = 0;
+  int64_t wall_ms = 0;
+  int64_t user_ms = -1;
+  int64_t system_ms = -1;
+  int64_t peak_rss_kb = -1;
+  int64_t block_in = -1;
+  int64_t block_out = -1;
+  int exit_code = -1;
+  int term_signal = 0;
+  wxString mod;
+  wxString flags;
+};
+
+// The history is an append-only text log (`runs.log`, one record per line)
+// plus a fixed-size binary index (`runs.idx`, 16 bytes per record holding the
+// log offset, line length and a hash of the mod name). Recent runs of a mod
+// are found by scanning the index backwards, so lookups stay cheap no matter
+// how long the log grows. A missing or stale index is rebuilt from the log;
+// lines that are not valid records, such as a torn final line, are indexed
+// as skipped, so the rebuilt index covers the whole log and is not rebuilt
+// again.
+wxString GetRunHistoryDir();
+
+RunRecord MakeRunRecord(const ProcessExit &exit, int64_t started_unix,
+                        const wxString &mod, const wxString &flags);
+bool AppendRunRecord(const wxString &dir, const RunRecord &record, wxString &error);
+bool ReadRecentRuns(const wxString &dir, const wxString &mod, size_t limit,
+                    std::vector<RunRecord> &records, wxString &error);
@@ -0,0 +1,96 @@
+#include "run_history_dialog.h"
+
+#include <ctime>
+#include <wx/button.h>
+#include <wx/datetime.h>
+#include <wx/intl.h>
+#include <wx/listctrl.h>
+#include <wx/sizer.h>
+#include <wx/stattext.h>
+
+namespace {
+
+constexpr int kSizerExpandAll = static_cast<int>(wxALL) | static_cast<int>(wxEXPAND);
+
+wxString FormatDuration(int64_t ms) {
+  const long long seconds = static_cast<long long>(ms / 1000);
+  return wxString::Format(wxT("%lld:%02lld:%02lld"), seconds / 3600,
+                          (seconds / 60) % 60, seconds % 60);
+}
+
+wxString FormatMegabytes(double megabytes) {
+  return megabytes < 0.0 ? wxString(wxT("-"))
+                         : wxString::Format(wxT("%.1f MB"), megabytes);
+}
+
+wxString FormatPair(int64_t first, int64_t second, double scale, const wxString &unit) {
+  if (first < 0 || second < 0) {
+    return wxT("-");
+  }
+  return wxString::Format(wxT("%.1f / %.1f %s"), static_cast<double>(first) * scale,
+                          static_cast<double>(second) * scale, unit);
+}
+
+} // namespace
+
+RunHistoryDialog::RunHistoryDialog(wxWindow *parent, const wxString &gameTitle,
+                                   const std::vector<RunRecord> &runs)
+    : wxDialog(parent, wxID_ANY, wxString::Format(_("Recent Runs: %s"), gameTitle),
+               wxDefaultPosition, wxSize(820, 340),
+               wxDEFAULT_DIALOG_STYLE | wxRESIZE_BORDER) {
+  auto *mainSizer = new wxBoxSizer(wxVERTICAL);
+
+  if (runs.empty()) {
+    mainSizer->Add(new wxStaticText(this, wxID_ANY, _("No runs recorded yet.")), 1,
+                   kSizerExpandAll, 10);
+  } else {
+    auto *list = new wxListView(this, wxID_ANY, wxDefaultPosition, wxDefaultSize,
+                                wxLC_REPORT | wxLC_SINGLE_SEL);
+    list->InsertColumn(0, _("Started"));
+    list->InsertColumn(1, _("Duration"));
+    list->InsertColumn(2, _("Peak memory"));
+    list->InsertColumn(3, _("CPU user / system"));
+    list->InsertColumn(4, _("Disk read / write"));
+    list->InsertColumn(5, _("Exit code"));
+    list->InsertColumn(6, _("Options"));
+
+    // rusage reports block I/O in 512-byte units.
+    constexpr double kBlocksToMegabytes = 512.0 / (1024.0 * 1024.0);
+    for (size_t i = 0; i < runs.size(); ++i) {
+      const RunRecord &run = runs[i];
+      const long row = list->InsertItem(
+          static_cast<long>(i),
+          wxDateTime(static_cast<time_t>(run.started_unix)).Format(wxT("%Y-%m-%d %H:%M")));
+      list->SetItem(row, 1, FormatDuration(run.wall_ms));
+      list->SetItem(row, 2,
+                    FormatMegabytes(run.peak_rss_kb < 0
+                                        ? -1.0
+                                        : static_cast<double>(run.peak_rss_kb) / 1024.0));
+      list->SetItem(row, 3, FormatPair(run.user_ms, run.system_ms, 0.001, wxT("s")));
+      list->SetItem(row, 4,
+                    FormatPair(run.block_in, run.block_out, kBlocksToMegabytes, wxT("MB")));
+      list->SetItem(row, 5,
+                    run.term_signal != 0
+                        ? wxString::Format(_("Signal %d"), run.term_signal)
+                        : wxString::Format(wxT("%d"), run.exit_code));
+      list->SetItem(row, 6, run.flags);
+    }
+    for (int column = 0; column < 6; ++column) {
+      list->SetColumnWidth(column, wxLIST_AUTOSIZE_USEHEADER);
+    }
+    list->SetColumnWidth(6, wxLIST_AUTOSIZE);
+    mainSizer->Add(list, 1, kSizerExpandAll, 5);
+  }
+
+  auto *buttonSizer = new wxBoxSizer(wxHORIZONTAL);
+  auto *closeButton = new wxButton(this, wxID_CLOSE);
+  closeButton->Bind(wxEVT_BUTTON,
+                    [this](wxCommandEvent &) { EndModal(wxID_CLOSE); });
+  SetEscapeId(wxID_CLOSE);
+  buttonSizer->AddStretchSpacer();
+  buttonSizer->Add(closeButton);
+  buttonSizer->AddSpacer(5);
+
+  mainSizer->Add(buttonSizer, 0, kSizerExpandAll, 5);
+  SetSizer(mainSizer);
+}
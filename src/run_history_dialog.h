@@ -0,0 +1,13 @@
+#pragma once
+
+#include "run_history.h"
+
+#include <vector>
+#include <wx/dialog.h>
+#include <wx/string.h>
+
+class RunHistoryDialog : public wxDialog {
+public:
+  RunHistoryDialog(wxWindow *parent, const wxString &gameTitle,
+                   const std::vector<RunRecord> &runs);
+};
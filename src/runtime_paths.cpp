@@ -1,14 +1,23 @@
 #include "runtime_paths.h"
+#include "trace.h"
 
 #include <wx/dir.h>
 #include <wx/filename.h>
 #include <wx/stdpaths.h>
+#include <wx/utils.h>
 
 bool ResolveRuntimePaths(RuntimePaths &paths, wxString &error) {
+  return ResolveRuntimePathsFromExecutable(
+      wxStandardPaths::Get().GetExecutablePath(), paths, error);
+}
+
+bool ResolveRuntimePathsFromExecutable(const wxString &executable,
+                                       RuntimePaths &paths, wxString &error) {
+  TraceScope trace("ResolveRuntimePaths");
   error.clear();
   paths = RuntimePaths{};
 
-  paths.launcher_executable = wxStandardPaths::Get().GetExecutablePath();
+  paths.launcher_executable = executable;
   if (paths.launcher_executable.empty()) {
     error = wxT("Failed to resolve launcher executable path.");
     return false;
@@ -54,17 +63,10 @@ bool ResolveRuntimePaths(RuntimePaths &paths, wxString &error) {
   }
 
   paths.open_gothic_executable.clear();
-#if defined(_WIN32)
-  static const wxString candidates[] = {wxT("Gothic2Notr.exe")};
-#else
-  static const wxString candidates[] = {wxT("Gothic2Notr")};
-#endif
-  for (const wxString &name : candidates) {
-    const wxString path = wxFileName(paths.system_dir, name).GetFullPath();
-    if (wxFileName::FileExists(path)) {
-      paths.open_gothic_executable = path;
-      break;
-    }
+  const wxString candidate =
+      wxFileName(paths.system_dir, ExpectedOpenGothicBinaryName()).GetFullPath();
+  if (wxFileName::FileExists(candidate)) {
+    paths.open_gothic_executable = candidate;
   }
   paths.saves_dir = wxFileName(paths.gothic_root, wxT("Saves")).GetFullPath();
 
@@ -120,3 +122,52 @@ wxString GetModWorkingDirectory(const RuntimePaths &paths, const wxString &mod_i
 
   return wxFileName(paths.saves_dir, mod_id).GetFullPath();
 }
+
+wxString GetInstallConfigPath(const RuntimePaths &paths) {
+  return wxFileName(paths.system_dir, wxT("OpenGothicStarter.ini")).GetFullPath();
+}
+
+wxString GetSystemPackConfigPath(const RuntimePaths &paths) {
+  return wxFileName(paths.system_dir, wxT("SystemPack.ini")).GetFullPath();
+}
+
+wxString ExpectedOpenGothicBinaryName() {
+#if defined(_WIN32)
+  return wxT("Gothic2Notr.exe");
+#else
+  return wxT("Gothic2Notr");
+#endif
+}
+
+wxString GetUserStateDir() {
+  wxString base;
+#if defined(_WIN32)
+  if (!wxGetEnv(wxT("LOCALAPPDATA"), &base) || base.empty()) {
+    base = wxStandardPaths::Get().GetUserConfigDir();
+  }
+#else
+  // XDG requires an absolute path; anything else falls back to the default.
+  if (!wxGetEnv(wxT("XDG_STATE_HOME"), &base) || !wxFileName(base).IsAbsolute()) {
+    base = wxFileName(wxFileName(wxGetHomeDir(), wxT(".local")).GetFullPath(),
+                      wxT("state"))
+               .GetFullPath();
+  }
+#endif
+  return wxFileName(base, wxT("OpenGothicStarter")).GetFullPath();
+}
+
+wxString GetUserCacheDir() {
+  wxString base;
+#if defined(_WIN32)
+  if (!wxGetEnv(wxT("LOCALAPPDATA"), &base) || base.empty()) {
+    base = wxStandardPaths::Get().GetUserConfigDir();
+  }
+  return wxFileName(wxFileName(base, wxT("OpenGothicStarter")).GetFullPath(), wxT("cache"))
+      .GetFullPath();
+#else
+  if (!wxGetEnv(wxT("XDG_CACHE_HOME"), &base) || !wxFileName(base).IsAbsolute()) {
+    base = wxFileName(wxGetHomeDir(), wxT(".cache")).GetFullPath();
+  }
+  return wxFileName(base, wxT("OpenGothicStarter")).GetFullPath();
+#endif
+}
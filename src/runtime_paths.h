@@ -12,7 +12,17 @@ struct RuntimePaths {
 };
 
 bool ResolveRuntimePaths(RuntimePaths &paths, wxString &error);
+bool ResolveRuntimePathsFromExecutable(const wxString &executable,
+                                       RuntimePaths &paths, wxString &error);
 bool ValidateRuntimePaths(const RuntimePaths &paths, wxString &error);
 
 wxString GetDefaultWorkingDirectory(const RuntimePaths &paths);
 wxString GetModWorkingDirectory(const RuntimePaths &paths, const wxString &mod_id);
+wxString GetInstallConfigPath(const RuntimePaths &paths);
+wxString GetSystemPackConfigPath(const RuntimePaths &paths);
+wxString ExpectedOpenGothicBinaryName();
+
+// Per-user directory for launcher state such as the run history.
+wxString GetUserStateDir();
+// Per-user directory for disposable data such as shader caches.
+wxString GetUserCacheDir();
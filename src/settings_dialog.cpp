@@ -1,21 +1,18 @@
 #include "settings_dialog.h"
 
 #include "app.h"
-#include "embedded_locales.h"
+#include "localization.h"
 
 #include <algorithm>
 #include <wx/button.h>
 #include <wx/checkbox.h>
 #include <wx/choice.h>
-#include <wx/dir.h>
-#include <wx/filename.h>
 #include <wx/intl.h>
 #include <wx/notebook.h>
 #include <wx/panel.h>
 #include <wx/sizer.h>
 #include <wx/spinctrl.h>
 #include <wx/stattext.h>
-#include <wx/stdpaths.h>
 
 namespace {
 
@@ -38,16 +35,82 @@ void AddDialogSettingRow(wxBoxSizer *parent, wxWindow *panel,
   parent->Add(row, 0, wxEXPAND);
 }
 
+wxWindow *CreateSystemPackControl(wxWindow *parent, const SystemPackBool &) {
+  return new wxCheckBox(parent, wxID_ANY, wxEmptyString);
+}
+
+wxWindow *CreateSystemPackControl(wxWindow *parent, const SystemPackInt &row) {
+  auto *control = new wxSpinCtrl(parent, wxID_ANY);
+  control->SetRange(row.min_value, row.max_value);
+  return control;
+}
+
+wxWindow *CreateSystemPackControl(wxWindow *parent, const SystemPackDouble &row) {
+  auto *control = new wxSpinCtrlDouble(parent, wxID_ANY);
+  control->SetRange(row.min_value, row.max_value);
+  control->SetIncrement(row.increment);
+  control->SetDigits(row.digits);
+  return control;
+}
+
+wxWindow *CreateSystemPackControl(wxWindow *parent, const SystemPackVisibility &) {
+  wxArrayString choices;
+  choices.Add(_("Never"));
+  choices.Add(_("Contextual"));
+  choices.Add(_("Always"));
+  return new wxChoice(parent, wxID_ANY, wxDefaultPosition, wxDefaultSize, choices);
+}
+
+void SetSystemPackControl(wxWindow *control, const SystemPackBool &row,
+                          const SystemPackSettings &settings) {
+  static_cast<wxCheckBox *>(control)->SetValue(settings.*row.member);
+}
+
+void SetSystemPackControl(wxWindow *control, const SystemPackInt &row,
+                          const SystemPackSettings &settings) {
+  static_cast<wxSpinCtrl *>(control)->SetValue(
+      std::clamp(settings.*row.member, row.min_value, row.max_value));
+}
+
+void SetSystemPackControl(wxWindow *control, const SystemPackDouble &row,
+                          const SystemPackSettings &settings) {
+  static_cast<wxSpinCtrlDouble *>(control)->SetValue(
+      std::clamp(settings.*row.member, row.min_value, row.max_value));
+}
+
+void SetSystemPackControl(wxWindow *control, const SystemPackVisibility &row,
+                          const SystemPackSettings &settings) {
+  static_cast<wxChoice *>(control)->SetSelection(std::clamp(settings.*row.member, 0, 2));
+}
+
+void ReadSystemPackControl(const wxWindow *control, const SystemPackBool &row,
+                           SystemPackSettings &settings) {
+  settings.*row.member = static_cast<const wxCheckBox *>(control)->GetValue();
+}
+
+void ReadSystemPackControl(const wxWindow *control, const SystemPackInt &row,
+                           SystemPackSettings &settings) {
+  settings.*row.member = static_cast<const wxSpinCtrl *>(control)->GetValue();
+}
+
+void ReadSystemPackControl(const wxWindow *control, const SystemPackDouble &row,
+                           SystemPackSettings &settings) {
+  settings.*row.member = static_cast<const wxSpinCtrlDouble *>(control)->GetValue();
+}
+
+void ReadSystemPackControl(const wxWindow *control, const SystemPackVisibility &row,
+                           SystemPackSettings &settings) {
+  settings.*row.member = static_cast<const wxChoice *>(control)->GetSelection();
+}
+
 } // namespace
 
-SettingsDialog::SettingsDialog(wxWindow *parent, GothicVersion initialVersion,
-                               const wxString &initialLanguage,
-                               const SystemPackSettings &initialSystemPack)
+SettingsDialog::SettingsDialog(wxWindow *parent)
     : wxDialog(parent, wxID_ANY, _("Settings"), wxDefaultPosition,
                wxSize(600, -1), wxDEFAULT_DIALOG_STYLE | wxRESIZE_BORDER) {
   auto *panel = new wxPanel(this);
   auto *mainSizer = new wxBoxSizer(wxVERTICAL);
-  auto *notebook = new wxNotebook(panel, wxID_ANY);
+  notebook = new wxNotebook(panel, wxID_ANY);
 
   auto *generalPanel = new wxPanel(notebook);
   auto *generalSizer = new wxBoxSizer(wxVERTICAL);
@@ -57,198 +120,26 @@ SettingsDialog::SettingsDialog(wxWindow *parent, GothicVersion initialVersion,
   versionChoices.Add(_("Gothic 2 Night of the Raven"));
   version_choice = new wxChoice(generalPanel, wxID_ANY, wxDefaultPosition,
                                 wxDefaultSize, versionChoices);
-  int versionSelection = static_cast<int>(initialVersion);
-  if (!IsSelectableGothicVersionIndex(versionSelection)) {
-    versionSelection = 2;
-  }
-  version_choice->SetSelection(versionSelection);
   AddDialogSettingRow(generalSizer, generalPanel, _("Gothic version:"),
                       version_choice);
 
-  wxArrayString languageChoices;
-  language_codes.clear();
-  languageChoices.Add(_("System default"));
-  language_codes.push_back(wxEmptyString);
-
-  wxArrayString lookupPaths;
-  wxFileName exeFile(wxStandardPaths::Get().GetExecutablePath());
-  exeFile.Normalize(wxPATH_NORM_DOTS | wxPATH_NORM_ABSOLUTE);
-  const wxString exeDir = exeFile.GetPath();
-  lookupPaths.Add(wxFileName(exeDir, wxT("locale")).GetFullPath());
-
-  wxFileName installPrefix(exeDir, wxEmptyString);
-  installPrefix.Normalize(wxPATH_NORM_DOTS | wxPATH_NORM_ABSOLUTE);
-  if (!installPrefix.GetDirs().empty()) {
-    installPrefix.RemoveLastDir(); // bin -> install prefix
-    const wxString shareDir =
-        wxFileName(installPrefix.GetPath(), wxT("share")).GetFullPath();
-    lookupPaths.Add(wxFileName(shareDir, wxT("locale")).GetFullPath());
-  }
-
-  wxString bundledLocaleError;
-  const wxString bundledLocaleRoot = GetBundledLocaleRoot(bundledLocaleError);
-  if (!bundledLocaleRoot.empty()) {
-    lookupPaths.Add(bundledLocaleRoot);
-  }
-
-  wxArrayString detectedCodes;
-  for (const wxString &path : lookupPaths) {
-    if (!wxDir::Exists(path)) {
-      continue;
-    }
-
-    wxDir localeDir(path);
-    wxString languageCode;
-    bool hasDir = localeDir.GetFirst(&languageCode, wxEmptyString, wxDIR_DIRS);
-    while (hasDir) {
-      const wxString languageDir =
-          wxFileName(path, languageCode).GetFullPath();
-      const wxString lcMessagesDir =
-          wxFileName(languageDir, wxT("LC_MESSAGES")).GetFullPath();
-      const wxString catalogPath =
-          wxFileName(lcMessagesDir, wxT("opengothicstarter.mo")).GetFullPath();
-      if (wxFileName::FileExists(catalogPath) &&
-          detectedCodes.Index(languageCode, false) == wxNOT_FOUND) {
-        detectedCodes.Add(languageCode);
-      }
-      hasDir = localeDir.GetNext(&languageCode);
-    }
-  }
-
-  if (!initialLanguage.empty() &&
-      detectedCodes.Index(initialLanguage, false) == wxNOT_FOUND) {
-    detectedCodes.Add(initialLanguage);
-  }
-  detectedCodes.Sort();
-
-  for (const wxString &code : detectedCodes) {
-    const wxLanguageInfo *langInfo = wxLocale::FindLanguageInfo(code);
-    if (langInfo == nullptr || langInfo->Description.empty()) {
-      languageChoices.Add(code);
-    } else {
-      languageChoices.Add(langInfo->Description);
-    }
-    language_codes.push_back(code);
-  }
-
-  language_choice = new wxChoice(generalPanel, wxID_ANY, wxDefaultPosition,
-                                 wxDefaultSize, languageChoices);
-
-  int languageSelection = 0;
-  for (size_t i = 0; i < language_codes.size(); ++i) {
-    if (language_codes[i].CmpNoCase(initialLanguage) == 0) {
-      languageSelection = static_cast<int>(i);
-      break;
-    }
-  }
-  language_choice->SetSelection(languageSelection);
+  language_choice = new wxChoice(generalPanel, wxID_ANY);
   AddDialogSettingRow(generalSizer, generalPanel, _("Language:"),
                       language_choice);
   generalSizer->AddStretchSpacer();
   generalPanel->SetSizer(generalSizer);
   notebook->AddPage(generalPanel, _("General"), true);
 
-  auto *systemPackPanel = new wxPanel(notebook);
-  auto *systemPackSizer = new wxBoxSizer(wxVERTICAL);
-
-  show_fps_counter_checkbox =
-      new wxCheckBox(systemPackPanel, wxID_ANY, wxEmptyString);
-  show_fps_counter_checkbox->SetValue(initialSystemPack.show_fps_counter);
-  AddDialogSettingRow(systemPackSizer, systemPackPanel, _("Show FPS counter:"),
-                      show_fps_counter_checkbox);
-
-  hide_focus_checkbox = new wxCheckBox(systemPackPanel, wxID_ANY, wxEmptyString);
-  hide_focus_checkbox->SetValue(initialSystemPack.hide_focus);
-  AddDialogSettingRow(systemPackSizer, systemPackPanel, _("Hide focus highlight:"),
-                      hide_focus_checkbox);
-
-  vertical_fov_ctrl = new wxSpinCtrlDouble(systemPackPanel, wxID_ANY);
-  vertical_fov_ctrl->SetRange(1.0, 179.0);
-  vertical_fov_ctrl->SetIncrement(0.5);
-  vertical_fov_ctrl->SetDigits(1);
-  vertical_fov_ctrl->SetValue(std::clamp(initialSystemPack.vertical_fov, 1.0, 179.0));
-  AddDialogSettingRow(systemPackSizer, systemPackPanel, _("Vertical FOV:"),
-                      vertical_fov_ctrl);
-
-  fps_limit_ctrl = new wxSpinCtrl(systemPackPanel, wxID_ANY);
-  fps_limit_ctrl->SetRange(0, 1000);
-  fps_limit_ctrl->SetValue(std::clamp(initialSystemPack.fps_limit, 0, 1000));
-  AddDialogSettingRow(systemPackSizer, systemPackPanel, _("FPS limit:"),
-                      fps_limit_ctrl);
-
-  interface_scale_ctrl = new wxSpinCtrlDouble(systemPackPanel, wxID_ANY);
-  interface_scale_ctrl->SetRange(0.1, 8.0);
-  interface_scale_ctrl->SetIncrement(0.1);
-  interface_scale_ctrl->SetDigits(1);
-  interface_scale_ctrl->SetValue(
-      std::clamp(initialSystemPack.interface_scale, 0.1, 8.0));
-  AddDialogSettingRow(systemPackSizer, systemPackPanel, _("Interface scale:"),
-                      interface_scale_ctrl);
-
-  inventory_cell_size_ctrl = new wxSpinCtrl(systemPackPanel, wxID_ANY);
-  inventory_cell_size_ctrl->SetRange(10, 512);
-  inventory_cell_size_ctrl->SetValue(
-      std::clamp(initialSystemPack.inventory_cell_size, 10, 512));
-  AddDialogSettingRow(systemPackSizer, systemPackPanel, _("Inventory cell size:"),
-                      inventory_cell_size_ctrl);
-
-  new_chapter_size_x_ctrl = new wxSpinCtrl(systemPackPanel, wxID_ANY);
-  new_chapter_size_x_ctrl->SetRange(1, 8192);
-  new_chapter_size_x_ctrl->SetValue(
-      std::clamp(initialSystemPack.new_chapter_size_x, 1, 8192));
-  AddDialogSettingRow(systemPackSizer, systemPackPanel, _("New chapter width:"),
-                      new_chapter_size_x_ctrl);
-
-  new_chapter_size_y_ctrl = new wxSpinCtrl(systemPackPanel, wxID_ANY);
-  new_chapter_size_y_ctrl->SetRange(1, 8192);
-  new_chapter_size_y_ctrl->SetValue(
-      std::clamp(initialSystemPack.new_chapter_size_y, 1, 8192));
-  AddDialogSettingRow(systemPackSizer, systemPackPanel, _("New chapter height:"),
-                      new_chapter_size_y_ctrl);
-
-  save_game_image_size_x_ctrl = new wxSpinCtrl(systemPackPanel, wxID_ANY);
-  save_game_image_size_x_ctrl->SetRange(0, 8192);
-  save_game_image_size_x_ctrl->SetValue(
-      std::clamp(initialSystemPack.save_game_image_size_x, 0, 8192));
-  AddDialogSettingRow(systemPackSizer, systemPackPanel, _("Save image width:"),
-                      save_game_image_size_x_ctrl);
-
-  save_game_image_size_y_ctrl = new wxSpinCtrl(systemPackPanel, wxID_ANY);
-  save_game_image_size_y_ctrl->SetRange(0, 8192);
-  save_game_image_size_y_ctrl->SetValue(
-      std::clamp(initialSystemPack.save_game_image_size_y, 0, 8192));
-  AddDialogSettingRow(systemPackSizer, systemPackPanel, _("Save image height:"),
-                      save_game_image_size_y_ctrl);
-
-  show_health_bar_checkbox = new wxCheckBox(systemPackPanel, wxID_ANY, wxEmptyString);
-  show_health_bar_checkbox->SetValue(initialSystemPack.show_health_bar);
-  AddDialogSettingRow(systemPackSizer, systemPackPanel, _("Show health bar:"),
-                      show_health_bar_checkbox);
-
-  wxArrayString barVisibilityChoices;
-  barVisibilityChoices.Add(_("Never"));
-  barVisibilityChoices.Add(_("Contextual"));
-  barVisibilityChoices.Add(_("Always"));
-
-  show_mana_bar_choice =
-      new wxChoice(systemPackPanel, wxID_ANY, wxDefaultPosition, wxDefaultSize,
-                   barVisibilityChoices);
-  show_mana_bar_choice->SetSelection(
-      std::clamp(initialSystemPack.show_mana_bar, 0, 2));
-  AddDialogSettingRow(systemPackSizer, systemPackPanel, _("Show mana bar:"),
-                      show_mana_bar_choice);
-
-  show_swim_bar_choice =
-      new wxChoice(systemPackPanel, wxID_ANY, wxDefaultPosition, wxDefaultSize,
-                   barVisibilityChoices);
-  show_swim_bar_choice->SetSelection(
-      std::clamp(initialSystemPack.show_swim_bar, 0, 2));
-  AddDialogSettingRow(systemPackSizer, systemPackPanel, _("Show swim bar:"),
-                      show_swim_bar_choice);
-
-  systemPackSizer->AddStretchSpacer();
-  systemPackPanel->SetSizer(systemPackSizer);
-  notebook->AddPage(systemPackPanel, _("SystemPack"), false);
+  // Filled in by BuildSystemPackPage() when the tab is first shown.
+  system_pack_panel = new wxPanel(notebook);
+  notebook->AddPage(system_pack_panel, _("SystemPack"), false);
+  notebook->Bind(wxEVT_NOTEBOOK_PAGE_CHANGED, [this](wxBookCtrlEvent &event) {
+    if (notebook->GetPage(static_cast<size_t>(event.GetSelection())) ==
+        system_pack_panel) {
+      BuildSystemPackPage();
+    }
+    event.Skip();
+  });
 
   mainSizer->Add(notebook, 1, wxEXPAND);
 
@@ -274,6 +165,82 @@ SettingsDialog::SettingsDialog(wxWindow *parent, GothicVersion initialVersion,
   SetSizerAndFit(dialogSizer);
 }
 
+void SettingsDialog::BuildSystemPackPage() {
+  if (system_pack_built) {
+    return;
+  }
+  system_pack_built = true;
+
+  auto *systemPackSizer = new wxBoxSizer(wxVERTICAL);
+  ForEachSystemPackField([&](const auto &row, size_t index) {
+    wxWindow *control = CreateSystemPackControl(system_pack_panel, row);
+    system_pack_controls[index] = control;
+    AddDialogSettingRow(systemPackSizer, system_pack_panel,
+                        wxGetTranslation(row.label), control);
+  });
+  systemPackSizer->AddStretchSpacer();
+  system_pack_panel->SetSizer(systemPackSizer);
+
+  ApplySystemPackValues();
+
+  // The dialog was sized for the General page only.
+  wxWindow *panel = notebook->GetParent();
+  notebook->InvalidateBestSize();
+  panel->GetSizer()->SetSizeHints(panel);
+  GetSizer()->SetSizeHints(this);
+}
+
+void SettingsDialog::SetValues(GothicVersion version, const wxString &language,
+                               const SystemPackSettings &systemPack) {
+  int versionSelection = static_cast<int>(version);
+  if (!IsSelectableGothicVersionIndex(versionSelection)) {
+    versionSelection = 2;
+  }
+  version_choice->SetSelection(versionSelection);
+
+  wxArrayString languageChoices;
+  language_codes.clear();
+  languageChoices.Add(_("System default"));
+  language_codes.push_back(wxEmptyString);
+
+  wxArrayString detectedCodes = GetAvailableCatalogLanguages();
+  if (!language.empty() && detectedCodes.Index(language, false) == wxNOT_FOUND) {
+    detectedCodes.Add(language);
+  }
+  detectedCodes.Sort();
+
+  for (const wxString &code : detectedCodes) {
+    const wxLanguageInfo *langInfo = wxLocale::FindLanguageInfo(code);
+    if (langInfo == nullptr || langInfo->Description.empty()) {
+      languageChoices.Add(code);
+    } else {
+      languageChoices.Add(langInfo->Description);
+    }
+    language_codes.push_back(code);
+  }
+  language_choice->Set(languageChoices);
+
+  int languageSelection = 0;
+  for (size_t i = 0; i < language_codes.size(); ++i) {
+    if (language_codes[i].CmpNoCase(language) == 0) {
+      languageSelection = static_cast<int>(i);
+      break;
+    }
+  }
+  language_choice->SetSelection(languageSelection);
+
+  system_pack = systemPack;
+  if (system_pack_built) {
+    ApplySystemPackValues();
+  }
+}
+
+void SettingsDialog::ApplySystemPackValues() {
+  ForEachSystemPackField([this](const auto &row, size_t index) {
+    SetSystemPackControl(system_pack_controls[index], row, system_pack);
+  });
+}
+
 GothicVersion SettingsDialog::GetSelectedVersion() const {
   const int selection = version_choice->GetSelection();
   if (!IsSelectableGothicVersionIndex(selection)) {
@@ -293,21 +260,14 @@ wxString SettingsDialog::GetLanguageOverride() const {
 }
 
 SystemPackSettings SettingsDialog::GetSystemPackSettings() const {
+  if (!system_pack_built) {
+    return system_pack;
+  }
+
   SystemPackSettings settings;
-  settings.show_fps_counter = show_fps_counter_checkbox->GetValue();
-  settings.hide_focus = hide_focus_checkbox->GetValue();
-  settings.vertical_fov = std::clamp(vertical_fov_ctrl->GetValue(), 1.0, 179.0);
-  settings.fps_limit = std::max(0, fps_limit_ctrl->GetValue());
-  settings.interface_scale = std::max(0.1, interface_scale_ctrl->GetValue());
-  settings.inventory_cell_size = std::max(10, inventory_cell_size_ctrl->GetValue());
-  settings.new_chapter_size_x = std::max(1, new_chapter_size_x_ctrl->GetValue());
-  settings.new_chapter_size_y = std::max(1, new_chapter_size_y_ctrl->GetValue());
-  settings.save_game_image_size_x =
-      std::max(0, save_game_image_size_x_ctrl->GetValue());
-  settings.save_game_image_size_y =
-      std::max(0, save_game_image_size_y_ctrl->GetValue());
-  settings.show_health_bar = show_health_bar_checkbox->GetValue();
-  settings.show_mana_bar = std::clamp(show_mana_bar_choice->GetSelection(), 0, 2);
-  settings.show_swim_bar = std::clamp(show_swim_bar_choice->GetSelection(), 0, 2);
+  ForEachSystemPackField([&](const auto &row, size_t index) {
+    ReadSystemPackControl(system_pack_controls[index], row, settings);
+  });
+  ClampSystemPackSettings(settings);
   return settings;
 }
@@ -0,0 +1,206 @@
+#include "shader_cache.h"
+#include "mod_discovery.h"
+#include "runtime_paths.h"
+#include "text_hash.h"
+
+#include <algorithm>
+#include <mutex>
+#include <string>
+#include <wx/dir.h>
+#include <wx/ffile.h>
+#include <wx/filename.h>
+#include <wx/log.h>
+
+namespace {
+
+const char kInfoVersion[] = "1";
+
+// Serializes preparation on the UI thread with eviction in the background.
+std::mutex gShaderCacheMutex;
+
+wxString InfoPath(const wxString &dir) {
+  return wxFileName(dir, wxT("cache.info")).GetFullPath();
+}
+
+wxString CacheDirName(const wxString &mod, const wxString &engine, const wxString &flags) {
+  return GetModStorageName(mod) +
+         wxString::Format(wxT("-%08x"), HashUtf8Fnv32(engine + wxT("\n") + flags));
+}
+
+wxString SanitizeField(const wxString &value) {
+  wxString sanitized = value;
+  sanitized.Replace(wxT("\t"), wxT(" "));
+  sanitized.Replace(wxT("\n"), wxT(" "));
+  return sanitized;
+}
+
+bool ReadCacheInfo(const wxString &dir, ShaderCacheEntry &entry) {
+  const wxFileName infoPath(InfoPath(dir));
+  wxFFile file(infoPath.GetFullPath(), wxT("rb"));
+  wxString text;
+  if (!file.IsOpened() || !file.ReadAll(&text, wxConvUTF8)) {
+    return false;
+  }
+  const wxArrayString fields = wxSplit(text.BeforeFirst('\n'), '\t', '\0');
+  if (fields.GetCount() != 4 || fields[0] != wxString::FromUTF8(kInfoVersion)) {
+    return false;
+  }
+  entry.path = dir;
+  entry.mod = fields[1];
+  entry.engine = fields[2];
+  entry.flags = fields[3];
+  entry.last_used_unix = static_cast<int64_t>(infoPath.GetModificationTime().GetTicks());
+  entry.size_bytes = static_cast<int64_t>(wxDir::GetTotalSize(dir).GetValue());
+  return true;
+}
+
+bool ListShaderCachesLocked(const wxString &root, std::vector<ShaderCacheEntry> &entries,
+                            wxString &error) {
+  entries.clear();
+  if (!wxDir::Exists(root)) {
+    return true;
+  }
+  wxLogNull noLog;
+  wxDir dir(root);
+  if (!dir.IsOpened()) {
+    error = wxString::Format(wxT("Failed to open shader cache directory: %s"), root);
+    return false;
+  }
+  wxString name;
+  for (bool found = dir.GetFirst(&name, wxEmptyString, wxDIR_DIRS); found;
+       found = dir.GetNext(&name)) {
+    ShaderCacheEntry entry;
+    if (ReadCacheInfo(wxFileName(root, name).GetFullPath(), entry)) {
+      entries.push_back(std::move(entry));
+    }
+  }
+  // Most recently used first.
+  std::sort(entries.begin(), entries.end(),
+            [](const ShaderCacheEntry &a, const ShaderCacheEntry &b) {
+              return a.last_used_unix > b.last_used_unix;
+            });
+  return true;
+}
+
+} // namespace
+
+wxString GetShaderCacheRoot() {
+  return wxFileName(GetUserCacheDir(), wxT("shader-cache")).GetFullPath();
+}
+
+wxString DescribeEngineBuild(const wxString &engine_executable) {
+  const wxFileName file(engine_executable);
+  if (!file.FileExists()) {
+    return wxT("unknown");
+  }
+  return wxString::Format(wxT("%llu-%lld"),
+                          static_cast<unsigned long long>(file.GetSize().GetValue()),
+                          static_cast<long long>(file.GetModificationTime().GetTicks()));
+}
+
+wxString DescribeRendererFlags(const wxArrayString &command) {
+  wxString flags;
+  for (const wxString flag : {wxT("-rt"), wxT("-gi"), wxT("-ms"), wxT("-vsm")}) {
+    const int index = command.Index(flag);
+    if (index == wxNOT_FOUND) {
+      continue;
+    }
+    // BuildLaunchCommand passes these as `-rt 1`/`-rt 0`; a bare flag enables.
+    const size_t value = static_cast<size_t>(index) + 1;
+    if (value < command.GetCount() && command[value] == wxT("0")) {
+      continue;
+    }
+    if (!flags.empty()) {
+      flags += wxT(" ");
+    }
+    flags += flag;
+  }
+  return flags;
+}
+
+bool PrepareShaderCache(const wxString &root, const wxString &mod,
+                        const wxString &engine, const wxString &flags,
+                        wxString &cache_dir, wxString &error) {
+  error.clear();
+  std::lock_guard<std::mutex> lock(gShaderCacheMutex);
+  cache_dir = wxFileName(root, CacheDirName(mod, engine, flags)).GetFullPath();
+  if (!wxDir::Exists(cache_dir) &&
+      !wxFileName::Mkdir(cache_dir, wxS_DIR_DEFAULT, wxPATH_MKDIR_FULL)) {
+    error = wxString::Format(wxT("Failed to create shader cache directory: %s"), cache_dir);
+    return false;
+  }
+
+  // Rewriting the info file also bumps its mtime, which is the LRU clock.
+  const std::string info =
+      std::string(kInfoVersion) + "\t" +
+      (SanitizeField(mod) + wxT("\t") + SanitizeField(engine) + wxT("\t") +
+       SanitizeField(flags))
+          .ToStdString(wxConvUTF8) +
+      "\n";
+  const wxString infoPath = InfoPath(cache_dir);
+  wxFFile file(infoPath, wxT("wb"));
+  if (!file.IsOpened() || file.Write(info.data(), info.size()) != info.size()) {
+    error = wxString::Format(wxT("Failed to write shader cache info: %s"), infoPath);
+    return false;
+  }
+  return true;
+}
+
+std::vector<std::pair<wxString, wxString>> GetShaderCacheEnvironment(
+    const wxString &cache_dir) {
+  return {
+      {wxT("MESA_SHADER_CACHE_DIR"), wxFileName(cache_dir, wxT("mesa")).GetFullPath()},
+      {wxT("__GL_SHADER_DISK_CACHE"), wxT("1")},
+      {wxT("__GL_SHADER_DISK_CACHE_PATH"),
+       wxFileName(cache_dir, wxT("nvidia")).GetFullPath()},
+      // The launcher enforces the budget across caches instead.
+      {wxT("__GL_SHADER_DISK_CACHE_SKIP_CLEANUP"), wxT("1")},
+  };
+}
+
+bool ListShaderCaches(const wxString &root, std::vector<ShaderCacheEntry> &entries,
+                      wxString &error) {
+  error.clear();
+  std::lock_guard<std::mutex> lock(gShaderCacheMutex);
+  return ListShaderCachesLocked(root, entries, error);
+}
+
+bool EnforceShaderCacheBudget(const wxString &root, int64_t budget_bytes,
+                              const wxString &keep, wxArrayString &evicted,
+                              wxString &error) {
+  error.clear();
+  evicted.clear();
+  std::lock_guard<std::mutex> lock(gShaderCacheMutex);
+  std::vector<ShaderCacheEntry> entries;
+  if (!ListShaderCachesLocked(root, entries, error)) {
+    return false;
+  }
+
+  int64_t total = 0;
+  for (const ShaderCacheEntry &entry : entries) {
+    total += entry.size_bytes;
+  }
+  // `entries` is most recently used first, so evict from the back.
+  for (auto it = entries.rbegin(); it != entries.rend() && total > budget_bytes; ++it) {
+    if (wxFileName(it->path).SameAs(wxFileName(keep))) {
+      continue;
+    }
+    if (!wxFileName::Rmdir(it->path, wxPATH_RMDIR_RECURSIVE)) {
+      error = wxString::Format(wxT("Failed to remove shader cache: %s"), it->path);
+      return false;
+    }
+    total -= it->size_bytes;
+    evicted.Add(it->path);
+  }
+  return true;
+}
+
+bool RemoveShaderCache(const wxString &cache_dir, wxString &error) {
+  error.clear();
+  std::lock_guard<std::mutex> lock(gShaderCacheMutex);
+  if (wxDir::Exists(cache_dir) && !wxFileName::Rmdir(cache_dir, wxPATH_RMDIR_RECURSIVE)) {
+    error = wxString::Format(wxT("Failed to remove shader cache: %s"), cache_dir);
+    return false;
+  }
+  return true;
+}
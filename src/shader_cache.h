@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include <wx/arrstr.h>
+#include <wx/string.h>
+
+// One driver shader cache directory, keyed by mod, OpenGothic build and the
+// renderer flags that change the pipelines it compiles.
+struct ShaderCacheEntry {
+  wxString path;
+  wxString mod;
+  wxString engine;
+  wxString flags;
+  int64_t size_bytes = 0;
+  int64_t last_used_unix = 0;
+};
+
+wxString GetShaderCacheRoot();
+// Identifies the OpenGothic binary by size and modification time, so an
+// engine update starts a fresh cache instead of growing a stale one.
+wxString DescribeEngineBuild(const wxString &engine_executable);
+// The renderer pipeline flags (-rt, -gi, -ms, -vsm) that `command` enables,
+// e.g. "-rt -vsm"; empty when all are off.
+wxString DescribeRendererFlags(const wxArrayString &command);
+
+// Creates (or reuses) the cache directory for the key and marks it as used.
+bool PrepareShaderCache(const wxString &root, const wxString &mod,
+                        const wxString &engine, const wxString &flags,
+                        wxString &cache_dir, wxString &error);
+// Mesa and NVIDIA cache location variables pointing into `cache_dir`.
+std::vector<std::pair<wxString, wxString>> GetShaderCacheEnvironment(
+    const wxString &cache_dir);
+
+bool ListShaderCaches(const wxString &root, std::vector<ShaderCacheEntry> &entries,
+                      wxString &error);
+// Removes least recently used caches until the total fits `budget_bytes`.
+// `keep` (the cache of the running game) is never removed.
+bool EnforceShaderCacheBudget(const wxString &root, int64_t budget_bytes,
+                              const wxString &keep, wxArrayString &evicted,
+                              wxString &error);
+bool RemoveShaderCache(const wxString &cache_dir, wxString &error);
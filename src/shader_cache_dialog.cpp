@@ -0,0 +1,126 @@
+#include "shader_cache_dialog.h"
+#include "ui_task.h"
+
+#include <ctime>
+#include <utility>
+#include <wx/button.h>
+#include <wx/datetime.h>
+#include <wx/intl.h>
+#include <wx/listctrl.h>
+#include <wx/log.h>
+#include <wx/msgdlg.h>
+#include <wx/sizer.h>
+
+namespace {
+
+constexpr int kSizerExpandAll = static_cast<int>(wxALL) | static_cast<int>(wxEXPAND);
+// Below this a cache has not seen a full session yet.
+constexpr int64_t kWarmCacheBytes = 1024 * 1024;
+
+} // namespace
+
+ShaderCacheDialog::ShaderCacheDialog(wxWindow *parent, const wxString &root,
+                                     const wxString &engine)
+    : wxDialog(parent, wxID_ANY, _("Shader Caches"), wxDefaultPosition, wxSize(680, 320),
+               wxDEFAULT_DIALOG_STYLE | wxRESIZE_BORDER),
+      cache_root(root), current_engine(engine) {
+  auto *mainSizer = new wxBoxSizer(wxVERTICAL);
+
+  list = new wxListView(this, wxID_ANY, wxDefaultPosition, wxDefaultSize,
+                        wxLC_REPORT | wxLC_SINGLE_SEL);
+  list->InsertColumn(0, _("Mod"));
+  list->InsertColumn(1, _("Renderer options"));
+  list->InsertColumn(2, _("Size"));
+  list->InsertColumn(3, _("Last used"));
+  list->InsertColumn(4, _("State"));
+  mainSizer->Add(list, 1, kSizerExpandAll, 5);
+
+  auto *buttonSizer = new wxBoxSizer(wxHORIZONTAL);
+  remove_button = new wxButton(this, wxID_ANY, _("Remove"));
+  remove_button->Bind(wxEVT_BUTTON, [this](wxCommandEvent &) { DoRemove(); });
+  auto *closeButton = new wxButton(this, wxID_CLOSE);
+  closeButton->Bind(wxEVT_BUTTON,
+                    [this](wxCommandEvent &) { EndModal(wxID_CLOSE); });
+  SetEscapeId(wxID_CLOSE);
+  buttonSizer->AddSpacer(5);
+  buttonSizer->Add(remove_button);
+  buttonSizer->AddStretchSpacer();
+  buttonSizer->Add(closeButton);
+  buttonSizer->AddSpacer(5);
+
+  mainSizer->Add(buttonSizer, 0, kSizerExpandAll, 5);
+  SetSizer(mainSizer);
+  Reload();
+}
+
+ShaderCacheDialog::~ShaderCacheDialog() { lifetime_token.Cancel(); }
+
+void ShaderCacheDialog::Reload(const wxString &remove) {
+  entries.clear();
+  list->DeleteAllItems();
+  list->InsertItem(0, _("Loading..."));
+  remove_button->Disable();
+
+  struct Listing {
+    std::vector<ShaderCacheEntry> entries;
+    wxString remove_error;
+    wxString list_error;
+  };
+  RunTaskThenUi(
+      "ListShaderCaches", TaskPriority::High, lifetime_token,
+      [root = cache_root, remove](const CancellationToken &) {
+        Listing listing;
+        if (!remove.empty()) {
+          RemoveShaderCache(remove, listing.remove_error);
+        }
+        ListShaderCaches(root, listing.entries, listing.list_error);
+        return listing;
+      },
+      [this](Listing listing) {
+        if (!listing.list_error.empty()) {
+          wxLogWarning(wxT("%s"), listing.list_error);
+        }
+        ShowEntries(std::move(listing.entries));
+        if (!listing.remove_error.empty()) {
+          wxMessageBox(listing.remove_error, _("Shader Caches"), wxOK | wxICON_ERROR, this);
+        }
+      });
+}
+
+void ShaderCacheDialog::ShowEntries(std::vector<ShaderCacheEntry> loaded) {
+  entries = std::move(loaded);
+  list->DeleteAllItems();
+  remove_button->Enable();
+  for (size_t i = 0; i < entries.size(); ++i) {
+    const ShaderCacheEntry &entry = entries[i];
+    const long row = list->InsertItem(static_cast<long>(i),
+                                      entry.mod.empty() ? _("No mod") : entry.mod);
+    list->SetItem(row, 1, entry.flags.empty() ? wxString(wxT("-")) : entry.flags);
+    list->SetItem(row, 2,
+                  wxString::Format(wxT("%.1f MB"),
+                                   static_cast<double>(entry.size_bytes) / (1024.0 * 1024.0)));
+    list->SetItem(row, 3,
+                  wxDateTime(static_cast<time_t>(entry.last_used_unix))
+                      .Format(wxT("%Y-%m-%d %H:%M")));
+    wxString state;
+    if (entry.engine != current_engine) {
+      state = _("Stale (other engine build)");
+    } else if (entry.size_bytes < kWarmCacheBytes) {
+      state = _("Cold");
+    } else {
+      state = _("Warm");
+    }
+    list->SetItem(row, 4, state);
+  }
+  for (int column = 0; column < 5; ++column) {
+    list->SetColumnWidth(column, wxLIST_AUTOSIZE_USEHEADER);
+  }
+}
+
+void ShaderCacheDialog::DoRemove() {
+  const long selected = list->GetFirstSelected();
+  if (selected < 0 || static_cast<size_t>(selected) >= entries.size()) {
+    return;
+  }
+  Reload(entries[static_cast<size_t>(selected)].path);
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include "shader_cache.h"
+#include "task_scheduler.h"
+
+#include <vector>
+#include <wx/dialog.h>
+#include <wx/string.h>
+
+class wxButton;
+class wxListView;
+
+class ShaderCacheDialog : public wxDialog {
+public:
+  ShaderCacheDialog(wxWindow *parent, const wxString &root, const wxString &engine);
+  ~ShaderCacheDialog() override;
+
+private:
+  // Removes `remove` first when it is set. Sizing the caches walks their
+  // whole trees, so both run on the scheduler while the list shows a
+  // loading row.
+  void Reload(const wxString &remove = wxString());
+  void ShowEntries(std::vector<ShaderCacheEntry> loaded);
+  void DoRemove();
+
+  wxString cache_root;
+  wxString current_engine;
+  std::vector<ShaderCacheEntry> entries;
+  wxListView *list;
+  wxButton *remove_button;
+  CancellationToken lifetime_token;
+};
@@ -0,0 +1,107 @@
+#include "system_pack_settings.h"
+
+#include <algorithm>
+#include <wx/fileconf.h>
+#include <wx/filename.h>
+
+namespace {
+
+void ClampField(SystemPackSettings &, const SystemPackBool &) {}
+
+void ClampField(SystemPackSettings &settings, const SystemPackInt &row) {
+  settings.*row.member = std::clamp(settings.*row.member, row.min_value, row.max_value);
+}
+
+void ClampField(SystemPackSettings &settings, const SystemPackDouble &row) {
+  double &value = settings.*row.member;
+  if (value <= 0.0) {
+    value = SystemPackSettings{}.*row.member;
+  }
+  value = std::clamp(value, row.min_value, row.max_value);
+}
+
+void ClampField(SystemPackSettings &settings, const SystemPackVisibility &row) {
+  settings.*row.member = std::clamp(settings.*row.member, 0, 2);
+}
+
+void ReadField(const wxFileConfig &cfg, SystemPackSettings &settings,
+               const SystemPackBool &row) {
+  long value = 0;
+  if (cfg.Read(row.key, &value)) {
+    settings.*row.member = (value != 0) != row.inverted;
+  }
+}
+
+void ReadField(const wxFileConfig &cfg, SystemPackSettings &settings,
+               const SystemPackInt &row) {
+  long value = 0;
+  if (cfg.Read(row.key, &value)) {
+    settings.*row.member = static_cast<int>(std::max(value, static_cast<long>(row.min_value)));
+  }
+}
+
+void ReadField(const wxFileConfig &cfg, SystemPackSettings &settings,
+               const SystemPackDouble &row) {
+  double value = 0.0;
+  if (cfg.Read(row.key, &value)) {
+    settings.*row.member = value < row.min_value ? SystemPackSettings{}.*row.member : value;
+  }
+}
+
+void ReadField(const wxFileConfig &cfg, SystemPackSettings &settings,
+               const SystemPackVisibility &row) {
+  long value = 0;
+  if (cfg.Read(row.key, &value)) {
+    settings.*row.member = static_cast<int>(std::clamp(value, 0L, 2L));
+  }
+}
+
+void WriteField(wxFileConfig &cfg, const SystemPackSettings &settings,
+                const SystemPackBool &row) {
+  cfg.Write(row.key, (settings.*row.member != row.inverted) ? 1L : 0L);
+}
+
+void WriteField(wxFileConfig &cfg, const SystemPackSettings &settings,
+                const SystemPackInt &row) {
+  cfg.Write(row.key, static_cast<long>(settings.*row.member));
+}
+
+void WriteField(wxFileConfig &cfg, const SystemPackSettings &settings,
+                const SystemPackDouble &row) {
+  cfg.Write(row.key, settings.*row.member);
+}
+
+void WriteField(wxFileConfig &cfg, const SystemPackSettings &settings,
+                const SystemPackVisibility &row) {
+  cfg.Write(row.key, static_cast<long>(settings.*row.member));
+}
+
+} // namespace
+
+SystemPackSettings ReadSystemPackSettings(const wxString &path) {
+  SystemPackSettings settings;
+  if (!wxFileName::FileExists(path)) {
+    return settings;
+  }
+
+  const wxFileConfig cfg(wxEmptyString, wxEmptyString, path, wxEmptyString,
+                         wxCONFIG_USE_LOCAL_FILE);
+  ForEachSystemPackField(
+      [&](const auto &row, size_t) { ReadField(cfg, settings, row); });
+  return settings;
+}
+
+bool WriteSystemPackSettings(const wxString &path, const SystemPackSettings &settings) {
+  SystemPackSettings clamped = settings;
+  ClampSystemPackSettings(clamped);
+
+  wxFileConfig cfg(wxEmptyString, wxEmptyString, path, wxEmptyString,
+                   wxCONFIG_USE_LOCAL_FILE);
+  ForEachSystemPackField(
+      [&](const auto &row, size_t) { WriteField(cfg, clamped, row); });
+  return cfg.Flush();
+}
+
+void ClampSystemPackSettings(SystemPackSettings &settings) {
+  ForEachSystemPackField([&](const auto &row, size_t) { ClampField(settings, row); });
+}
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <cstddef>
+#include <tuple>
+#include <wx/string.h>
+#include <wx/translation.h>
+
+// Launcher-managed subset of `<Gothic>/system/SystemPack.ini`.
+struct SystemPackSettings {
+  bool show_fps_counter = false;
+  bool hide_focus = false;
+  double vertical_fov = 67.5;
+  int fps_limit = 0;
+  double interface_scale = 1.0;
+  int inventory_cell_size = 70;
+  int new_chapter_size_x = 800;
+  int new_chapter_size_y = 600;
+  int save_game_image_size_x = 320;
+  int save_game_image_size_y = 200;
+  bool show_health_bar = true;
+  int show_mana_bar = 2;
+  int show_swim_bar = 1;
+};
+
+// Schema rows. `key` is "<SECTION>/<Key>" in the INI file and `label` the
+// Settings dialog msgid; defaults are the SystemPackSettings initializers.
+struct SystemPackBool {
+  const char *key;
+  const char *label;
+  bool SystemPackSettings::*member;
+  // Stored negated, e.g. HideHealthBar for show_health_bar.
+  bool inverted;
+};
+
+struct SystemPackInt {
+  const char *key;
+  const char *label;
+  int SystemPackSettings::*member;
+  int min_value;
+  int max_value;
+};
+
+struct SystemPackDouble {
+  const char *key;
+  const char *label;
+  double SystemPackSettings::*member;
+  double min_value;
+  double max_value;
+  double increment;
+  unsigned digits;
+};
+
+// 0 = never, 1 = contextual, 2 = always.
+struct SystemPackVisibility {
+  const char *key;
+  const char *label;
+  int SystemPackSettings::*member;
+};
+
+// In Settings dialog order. A new SystemPack option is one row here plus its
+// SystemPackSettings member.
+inline constexpr auto kSystemPackSchema = std::make_tuple(
+    SystemPackBool{"DEBUG/Show_FPS_Counter", wxTRANSLATE("Show FPS counter:"),
+                   &SystemPackSettings::show_fps_counter, false},
+    SystemPackBool{"PARAMETERS/HideFocus", wxTRANSLATE("Hide focus highlight:"),
+                   &SystemPackSettings::hide_focus, false},
+    SystemPackDouble{"PARAMETERS/VerticalFOV", wxTRANSLATE("Vertical FOV:"),
+                     &SystemPackSettings::vertical_fov, 1.0, 179.0, 0.5, 1},
+    SystemPackInt{"PARAMETERS/FPS_Limit", wxTRANSLATE("FPS limit:"),
+                  &SystemPackSettings::fps_limit, 0, 1000},
+    SystemPackDouble{"INTERFACE/Scale", wxTRANSLATE("Interface scale:"),
+                     &SystemPackSettings::interface_scale, 0.1, 8.0, 0.1, 1},
+    SystemPackInt{"INTERFACE/InventoryCellSize", wxTRANSLATE("Inventory cell size:"),
+                  &SystemPackSettings::inventory_cell_size, 10, 512},
+    SystemPackInt{"INTERFACE/NewChapterSizeX", wxTRANSLATE("New chapter width:"),
+                  &SystemPackSettings::new_chapter_size_x, 1, 8192},
+    SystemPackInt{"INTERFACE/NewChapterSizeY", wxTRANSLATE("New chapter height:"),
+                  &SystemPackSettings::new_chapter_size_y, 1, 8192},
+    SystemPackInt{"INTERFACE/SaveGameImageSizeX", wxTRANSLATE("Save image width:"),
+                  &SystemPackSettings::save_game_image_size_x, 0, 8192},
+    SystemPackInt{"INTERFACE/SaveGameImageSizeY", wxTRANSLATE("Save image height:"),
+                  &SystemPackSettings::save_game_image_size_y, 0, 8192},
+    SystemPackBool{"INTERFACE/HideHealthBar", wxTRANSLATE("Show health bar:"),
+                   &SystemPackSettings::show_health_bar, true},
+    SystemPackVisibility{"INTERFACE/ShowManaBar", wxTRANSLATE("Show mana bar:"),
+                         &SystemPackSettings::show_mana_bar},
+    SystemPackVisibility{"INTERFACE/ShowSwimBar", wxTRANSLATE("Show swim bar:"),
+                         &SystemPackSettings::show_swim_bar});
+
+inline constexpr size_t kSystemPackFieldCount =
+    std::tuple_size<decltype(kSystemPackSchema)>::value;
+
+// Calls visit(row, index) for every schema row, in order.
+template <typename Visitor> void ForEachSystemPackField(Visitor &&visit) {
+  std::apply(
+      [&visit](const auto &...rows) {
+        size_t index = 0;
+        (visit(rows, index++), ...);
+      },
+      kSystemPackSchema);
+}
+
+// Reads every schema key in one pass over the parsed file. Missing keys keep
+// their defaults. Integers below the schema minimum are raised to it, and
+// floating-point values below it, which SystemPack treats as unset, use the
+// default. Values above the maximum are kept as the user wrote them; only
+// the dialog and WriteSystemPackSettings() limit them.
+SystemPackSettings ReadSystemPackSettings(const wxString &path);
+bool WriteSystemPackSettings(const wxString &path, const SystemPackSettings &settings);
+void ClampSystemPackSettings(SystemPackSettings &settings);
@@ -0,0 +1,326 @@
+#include "task_scheduler.h"
+#include "launch_profile.h"
+#include "trace.h"
+
+#include <algorithm>
+#include <utility>
+#include <wx/arrstr.h>
+#include <wx/log.h>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace {
+
+// Lets a task submitted from a worker land in that worker's own queue.
+thread_local const TaskScheduler *gCurrentScheduler = nullptr;
+thread_local size_t gCurrentWorker = 0;
+// The wxLog target last installed on this thread by AdoptLogTarget().
+thread_local wxLog *gThreadLogTarget = nullptr;
+
+} // namespace
+
+TaskScheduler::TaskScheduler(size_t worker_count) {
+  if (worker_count == 0) {
+    worker_count = std::clamp<size_t>(std::thread::hardware_concurrency(), 2, 4);
+  }
+  for (size_t i = 0; i < worker_count; ++i) {
+    queues.push_back(std::make_unique<WorkerQueue>());
+  }
+  for (size_t i = 0; i < worker_count; ++i) {
+    workers.emplace_back([this, i]() { RunWorker(i); });
+  }
+}
+
+TaskScheduler::~TaskScheduler() { Shutdown(); }
+
+bool TaskScheduler::Submit(const char *name, TaskPriority priority,
+                           const CancellationToken &token,
+                           std::function<void(const CancellationToken &)> work) {
+  if (stopping.load() || workers.empty()) {
+    return false;
+  }
+
+  Task task;
+  task.name = name;
+  task.priority = priority;
+  task.token = token;
+  task.work = std::move(work);
+  task.queued_us = TraceNowMicros();
+
+  const size_t index = gCurrentScheduler == this
+                           ? gCurrentWorker
+                           : next_queue.fetch_add(1) % queues.size();
+  {
+    std::lock_guard<std::mutex> lock(queues[index]->mutex);
+    queues[index]->tasks[static_cast<size_t>(priority)].push_back(std::move(task));
+  }
+  {
+    // Taking the lock orders the increment with a worker about to sleep.
+    std::lock_guard<std::mutex> lock(sleep_mutex);
+    pending[static_cast<size_t>(priority)].fetch_add(1);
+  }
+  wake.notify_one();
+  return true;
+}
+
+void TaskScheduler::Shutdown() {
+  {
+    std::lock_guard<std::mutex> lock(sleep_mutex);
+    if (stopping.exchange(true)) {
+      return;
+    }
+  }
+  wake.notify_all();
+  // A busy game can starve the helper indefinitely, so tasks it has not
+  // started are dropped and their workers released.
+  {
+    std::lock_guard<std::mutex> lock(idle_mutex);
+    idle_stopping = true;
+    for (IdleJob *job : idle_jobs) {
+      job->dropped = true;
+    }
+    idle_jobs.clear();
+  }
+  idle_wake.notify_all();
+  idle_done.notify_all();
+  for (std::thread &worker : workers) {
+    if (worker.joinable()) {
+      worker.join();
+    }
+  }
+  if (idle_helper.joinable()) {
+    idle_helper.join();
+  }
+
+  std::lock_guard<std::mutex> statsLock(stats_mutex);
+  for (const std::unique_ptr<WorkerQueue> &queue : queues) {
+    std::lock_guard<std::mutex> lock(queue->mutex);
+    for (std::deque<Task> &tasks : queue->tasks) {
+      for (const Task &task : tasks) {
+        ++stats[task.name].cancelled;
+      }
+      tasks.clear();
+    }
+  }
+  for (std::atomic<long> &count : pending) {
+    count.store(0);
+  }
+}
+
+void TaskScheduler::BeginThrottle() {
+  std::lock_guard<std::mutex> lock(sleep_mutex);
+  if (throttle_depth.fetch_add(1) == 0) {
+    throttle_begin_us = TraceNowMicros();
+    demoted_runs.store(0);
+  }
+}
+
+bool TaskScheduler::EndThrottle(ThrottleReport &report) {
+  {
+    std::lock_guard<std::mutex> lock(sleep_mutex);
+    if (throttle_depth.load() == 0 || throttle_depth.fetch_sub(1) != 1) {
+      return false;
+    }
+    const int64_t nowUs = TraceNowMicros();
+    report = ThrottleReport();
+    report.throttled_us = nowUs - throttle_begin_us;
+    report.demoted_tasks = demoted_runs.load();
+    constexpr size_t kLow = static_cast<size_t>(TaskPriority::Low);
+    for (const std::unique_ptr<WorkerQueue> &queue : queues) {
+      std::lock_guard<std::mutex> queueLock(queue->mutex);
+      for (Task &task : queue->tasks[kLow]) {
+        task.deferred_us = nowUs - std::max(task.queued_us, throttle_begin_us);
+        ++report.deferred_tasks;
+      }
+    }
+  }
+  wake.notify_all();
+  return true;
+}
+
+std::map<std::string, TaskStats> TaskScheduler::GetStats() const {
+  std::lock_guard<std::mutex> lock(stats_mutex);
+  return stats;
+}
+
+void TaskScheduler::RunWorker(size_t index) {
+  gCurrentScheduler = this;
+  gCurrentWorker = index;
+  for (;;) {
+    {
+      std::unique_lock<std::mutex> lock(sleep_mutex);
+      wake.wait(lock, [this]() { return stopping.load() || HasRunnableTask(); });
+      if (stopping.load()) {
+        return;
+      }
+    }
+
+    Task task;
+    if (TakeTask(index, task)) {
+      RunTask(task);
+    }
+  }
+}
+
+bool TaskScheduler::HasRunnableTask() const {
+  const size_t priorities = IsThrottled() ? kPriorityCount - 1 : kPriorityCount;
+  for (size_t priority = 0; priority < priorities; ++priority) {
+    if (pending[priority].load() > 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool TaskScheduler::TakeTask(size_t index, Task &task) {
+  // Low-priority work waits for the throttle to end.
+  const size_t priorities = IsThrottled() ? kPriorityCount - 1 : kPriorityCount;
+  for (size_t priority = 0; priority < priorities; ++priority) {
+    {
+      WorkerQueue &own = *queues[index];
+      std::lock_guard<std::mutex> lock(own.mutex);
+      if (!own.tasks[priority].empty()) {
+        task = std::move(own.tasks[priority].back());
+        own.tasks[priority].pop_back();
+        pending[priority].fetch_sub(1);
+        return true;
+      }
+    }
+    for (size_t offset = 1; offset < queues.size(); ++offset) {
+      WorkerQueue &victim = *queues[(index + offset) % queues.size()];
+      std::lock_guard<std::mutex> lock(victim.mutex);
+      if (!victim.tasks[priority].empty()) {
+        task = std::move(victim.tasks[priority].front());
+        victim.tasks[priority].pop_front();
+        pending[priority].fetch_sub(1);
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+void TaskScheduler::RunTask(Task &task) {
+  AdoptLogTarget();
+  const int64_t startUs = TraceNowMicros();
+  bool cancelled = task.token.IsCancelled();
+  const bool demoted =
+      !cancelled && task.priority == TaskPriority::Normal && IsThrottled();
+  if (demoted) {
+    cancelled = !RunDemoted(task);
+    if (!cancelled) {
+      demoted_runs.fetch_add(1);
+    }
+  } else if (!cancelled) {
+    task.work(task.token);
+  }
+  const int64_t endUs = TraceNowMicros();
+  if (!cancelled) {
+    RecordTraceSpan(task.name, "tasks", startUs, endUs);
+  }
+
+  std::lock_guard<std::mutex> lock(stats_mutex);
+  TaskStats &entry = stats[task.name];
+  if (cancelled) {
+    ++entry.cancelled;
+    return;
+  }
+  ++entry.completed;
+  entry.total_run_us += endUs - startUs;
+  entry.max_run_us = std::max(entry.max_run_us, endUs - startUs);
+  entry.total_wait_us += startUs - task.queued_us;
+  if (task.deferred_us > 0) {
+    ++entry.deferred;
+    entry.total_deferred_us += task.deferred_us;
+  }
+  if (demoted) {
+    ++entry.demoted;
+  }
+}
+
+bool TaskScheduler::RunDemoted(Task &task) {
+#if defined(__linux__)
+  std::unique_lock<std::mutex> lock(idle_mutex);
+  if (idle_stopping) {
+    return false;
+  }
+  if (!idle_helper.joinable()) {
+    idle_helper = std::thread([this]() { RunIdleHelper(); });
+  }
+  IdleJob job;
+  job.task = &task;
+  idle_jobs.push_back(&job);
+  idle_wake.notify_one();
+  idle_done.wait(lock, [&job]() { return job.finished || job.dropped; });
+  return job.finished;
+#else
+  task.work(task.token);
+  return true;
+#endif
+}
+
+void TaskScheduler::RunIdleHelper() {
+#if defined(__linux__)
+  sched_param param{};
+  pthread_setschedparam(pthread_self(), SCHED_IDLE, &param);
+  LaunchProfile idle;
+  idle.io_class = IoPriorityClass::Idle;
+  wxArrayString warnings;
+  ApplyThreadLimits(idle, warnings);
+#endif
+  std::unique_lock<std::mutex> lock(idle_mutex);
+  for (;;) {
+    idle_wake.wait(lock, [this]() { return idle_stopping || !idle_jobs.empty(); });
+    if (idle_stopping) {
+      return;
+    }
+    IdleJob *job = idle_jobs.front();
+    idle_jobs.pop_front();
+    lock.unlock();
+    AdoptLogTarget();
+    job->task->work(job->task->token);
+    lock.lock();
+    job->finished = true;
+    idle_done.notify_all();
+  }
+}
+
+void TaskScheduler::AdoptLogTarget() {
+  wxLog *target = log_target.load();
+  if (target != gThreadLogTarget) {
+    wxLog::SetThreadActiveTarget(target);
+    gThreadLogTarget = target;
+  }
+}
+
+namespace {
+
+std::mutex gSchedulerMutex;
+std::unique_ptr<TaskScheduler> gScheduler;
+bool gSchedulerShutDown = false;
+
+} // namespace
+
+TaskScheduler &GetTaskScheduler() {
+  std::lock_guard<std::mutex> lock(gSchedulerMutex);
+  if (!gScheduler) {
+    gScheduler = std::make_unique<TaskScheduler>();
+    if (gSchedulerShutDown) {
+      gScheduler->Shutdown();
+    }
+  }
+  return *gScheduler;
+}
+
+std::map<std::string, TaskStats> ShutdownTaskScheduler() {
+  std::lock_guard<std::mutex> lock(gSchedulerMutex);
+  gSchedulerShutDown = true;
+  if (!gScheduler) {
+    return {};
+  }
+  gScheduler->Shutdown();
+  return gScheduler->GetStats();
+}
@@ -0,0 +1,154 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+class wxLog;
+
+enum class TaskPriority : int { High = 0, Normal = 1, Low = 2 };
+
+// Shared cancellation flag; copies observe and set the same flag.
+class CancellationToken {
+public:
+  CancellationToken() : flag(std::make_shared<std::atomic<bool>>(false)) {}
+
+  void Cancel() const { flag->store(true, std::memory_order_relaxed); }
+  bool IsCancelled() const { return flag->load(std::memory_order_relaxed); }
+
+private:
+  std::shared_ptr<std::atomic<bool>> flag;
+};
+
+struct TaskStats {
+  uint64_t completed = 0;
+  uint64_t cancelled = 0;
+  int64_t total_run_us = 0;
+  int64_t max_run_us = 0;
+  int64_t total_wait_us = 0;
+  // Runs held back or demoted while a game was running, see BeginThrottle().
+  uint64_t deferred = 0;
+  int64_t total_deferred_us = 0;
+  uint64_t demoted = 0;
+};
+
+struct ThrottleReport {
+  int64_t throttled_us = 0;
+  size_t deferred_tasks = 0;
+  size_t demoted_tasks = 0;
+};
+
+// Small work-stealing pool for launcher background work. Every worker owns
+// one deque per priority: it takes its own newest task first and otherwise
+// steals the oldest task of another worker, always serving higher priorities
+// before lower ones. Tasks whose token is cancelled before they start are
+// dropped. Run and queue times are kept per task name and recorded as trace
+// spans in the "tasks" category.
+//
+// While throttled (a game is running) low-priority tasks stay queued until
+// the throttle ends, and normal-priority ones are handed to one long-lived
+// helper thread with SCHED_IDLE and the idle I/O class on Linux, the worker
+// waiting for them. The helper is needed because an unprivileged thread
+// cannot leave SCHED_IDLE again. High-priority tasks, which the user is
+// waiting for, keep running on the workers.
+class TaskScheduler {
+public:
+  // 0 picks the hardware concurrency, clamped to 2..4 workers.
+  explicit TaskScheduler(size_t worker_count = 0);
+  ~TaskScheduler();
+
+  TaskScheduler(const TaskScheduler &) = delete;
+  TaskScheduler &operator=(const TaskScheduler &) = delete;
+
+  // `name` must be a string literal, as for TraceScope. Returns false once the
+  // scheduler is shutting down.
+  bool Submit(const char *name, TaskPriority priority, const CancellationToken &token,
+              std::function<void(const CancellationToken &)> work);
+  // Drops queued tasks, including those still waiting for the idle helper,
+  // waits for running ones and joins the workers.
+  void Shutdown();
+
+  // Throttles nest, one per running game.
+  void BeginThrottle();
+  // Returns true with a report when the last throttle ends.
+  bool EndThrottle(ThrottleReport &report);
+  bool IsThrottled() const { return throttle_depth.load() > 0; }
+
+  // Tasks log straight to `target` instead of wxWidgets buffering their
+  // records until the UI thread flushes them. The target must be thread-safe
+  // and outlive the scheduler, or be replaced by nullptr first.
+  void SetLogTarget(wxLog *target) { log_target.store(target); }
+
+  size_t GetWorkerCount() const { return workers.size(); }
+  std::map<std::string, TaskStats> GetStats() const;
+
+private:
+  static constexpr size_t kPriorityCount = 3;
+
+  struct Task {
+    const char *name = "";
+    TaskPriority priority = TaskPriority::Normal;
+    CancellationToken token;
+    std::function<void(const CancellationToken &)> work;
+    int64_t queued_us = 0;
+    int64_t deferred_us = 0;
+  };
+
+  struct WorkerQueue {
+    std::mutex mutex;
+    std::deque<Task> tasks[kPriorityCount];
+  };
+
+  void RunWorker(size_t index);
+  bool HasRunnableTask() const;
+  bool TakeTask(size_t index, Task &task);
+  void RunTask(Task &task);
+  // Returns false when the task was dropped by Shutdown() before it ran.
+  bool RunDemoted(Task &task);
+  void RunIdleHelper();
+  // Installs `log_target` as the calling thread's wxLog target when it changed.
+  void AdoptLogTarget();
+
+  std::vector<std::unique_ptr<WorkerQueue>> queues;
+  std::vector<std::thread> workers;
+  std::atomic<size_t> next_queue{0};
+  std::atomic<long> pending[kPriorityCount] = {};
+  std::atomic<bool> stopping{false};
+  std::atomic<int> throttle_depth{0};
+  int64_t throttle_begin_us = 0;
+  std::atomic<size_t> demoted_runs{0};
+  std::atomic<wxLog *> log_target{nullptr};
+  std::mutex sleep_mutex;
+  std::condition_variable wake;
+  mutable std::mutex stats_mutex;
+  std::map<std::string, TaskStats> stats;
+
+  // A demoted task, owned by the worker waiting for it.
+  struct IdleJob {
+    Task *task = nullptr;
+    bool finished = false;
+    bool dropped = false;
+  };
+
+  // The idle-class helper, started by the first demoted task.
+  std::thread idle_helper;
+  std::mutex idle_mutex;
+  std::condition_variable idle_wake;
+  std::condition_variable idle_done;
+  std::deque<IdleJob *> idle_jobs;
+  bool idle_stopping = false;
+};
+
+// Process-wide scheduler, created on first use.
+TaskScheduler &GetTaskScheduler();
+// Shuts the process-wide scheduler down and returns its final counters;
+// later submissions are dropped.
+std::map<std::string, TaskStats> ShutdownTaskScheduler();
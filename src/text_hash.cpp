@@ -0,0 +1,21 @@
+#include "text_hash.h"
+
+#include <string>
+
+uint32_t HashUtf8Fnv32(const wxString &text) {
+  uint32_t hash = 2166136261u;
+  for (const char ch : text.ToStdString(wxConvUTF8)) {
+    hash ^= static_cast<unsigned char>(ch);
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
+uint64_t HashUtf8Fnv64(const wxString &text) {
+  uint64_t hash = 14695981039346656037ULL;
+  for (const char ch : text.ToStdString(wxConvUTF8)) {
+    hash ^= static_cast<unsigned char>(ch);
+    hash *= 1099511628211ULL;
+  }
+  return hash;
+}
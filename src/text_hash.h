@@ -0,0 +1,9 @@
+#pragma once
+
+#include <cstdint>
+#include <wx/string.h>
+
+// FNV-1a over the UTF-8 bytes of `text`. The results end up in file, cache
+// directory and socket names, so they must stay the same across releases.
+uint32_t HashUtf8Fnv32(const wxString &text);
+uint64_t HashUtf8Fnv64(const wxString &text);
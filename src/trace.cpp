@@ -0,0 +1,223 @@
+#include "trace.h"
+
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <wx/ffile.h>
+#include <wx/log.h>
+#include <wx/utils.h>
+
+std::atomic<bool> gTracingEnabled{false};
+
+namespace {
+
+struct TraceEvent {
+  const char *name;
+  const char *category;
+  char phase;
+  int64_t timestamp_us;
+  int64_t duration_us;
+  uint32_t thread_id;
+  std::string detail;
+  const char *series;
+  int64_t value;
+};
+
+std::mutex gTraceMutex;
+std::vector<TraceEvent> gTraceEvents;
+wxString gTracePath;
+std::atomic<uint32_t> gNextTraceThreadId{1};
+
+uint32_t CurrentTraceThreadId() {
+  thread_local const uint32_t id = gNextTraceThreadId.fetch_add(1);
+  return id;
+}
+
+void AppendJsonEscaped(std::string &out, const char *text) {
+  for (const char *p = text; *p != '\0'; ++p) {
+    const unsigned char ch = static_cast<unsigned char>(*p);
+    switch (ch) {
+    case '"':
+      out += "\\\"";
+      break;
+    case '\\':
+      out += "\\\\";
+      break;
+    case '\n':
+      out += "\\n";
+      break;
+    case '\t':
+      out += "\\t";
+      break;
+    default:
+      if (ch < 0x20) {
+        char buffer[8];
+        std::snprintf(buffer, sizeof(buffer), "\\u%04x", ch);
+        out += buffer;
+      } else {
+        out += static_cast<char>(ch);
+      }
+      break;
+    }
+  }
+}
+
+void PushTraceEvent(TraceEvent &&event) {
+  std::lock_guard<std::mutex> lock(gTraceMutex);
+  gTraceEvents.push_back(std::move(event));
+}
+
+} // namespace
+
+int64_t TraceNowMicros() {
+  // steady_clock is CLOCK_MONOTONIC on the supported platforms, which keeps
+  // timestamps comparable with other processes reading the same clock.
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+bool StartTracing(const wxString &path, wxString &error) {
+  error.clear();
+  if (path.empty()) {
+    error = wxT("Trace output path is empty.");
+    return false;
+  }
+
+  // Fail early on an unwritable path instead of losing the trace at exit.
+  wxLogNull noLog;
+  wxFFile probe(path, wxT("wb"));
+  if (!probe.IsOpened()) {
+    error = wxString::Format(wxT("Failed to open trace output file: %s"), path);
+    return false;
+  }
+  probe.Close();
+
+  {
+    std::lock_guard<std::mutex> lock(gTraceMutex);
+    gTracePath = path;
+    gTraceEvents.clear();
+    gTraceEvents.reserve(4096);
+  }
+  gTracingEnabled.store(true, std::memory_order_relaxed);
+  return true;
+}
+
+void StopTracing() {
+  if (!gTracingEnabled.exchange(false)) {
+    return;
+  }
+
+  std::vector<TraceEvent> events;
+  wxString path;
+  {
+    std::lock_guard<std::mutex> lock(gTraceMutex);
+    events.swap(gTraceEvents);
+    path = gTracePath;
+  }
+
+  const unsigned long pid = wxGetProcessId();
+  std::string json = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+  for (size_t i = 0; i < events.size(); ++i) {
+    const TraceEvent &event = events[i];
+    char buffer[160];
+    json += "{\"name\":\"";
+    AppendJsonEscaped(json, event.name);
+    json += "\",\"cat\":\"";
+    AppendJsonEscaped(json, event.category);
+    std::snprintf(buffer, sizeof(buffer),
+                  "\",\"ph\":\"%c\",\"pid\":%lu,\"tid\":%u,\"ts\":%lld", event.phase,
+                  pid, event.thread_id, static_cast<long long>(event.timestamp_us));
+    json += buffer;
+
+    if (event.phase == 'X') {
+      std::snprintf(buffer, sizeof(buffer), ",\"dur\":%lld",
+                    static_cast<long long>(event.duration_us));
+      json += buffer;
+      if (!event.detail.empty()) {
+        json += ",\"args\":{\"detail\":\"";
+        AppendJsonEscaped(json, event.detail.c_str());
+        json += "\"}";
+      }
+    } else if (event.phase == 'C') {
+      json += ",\"args\":{\"";
+      AppendJsonEscaped(json, event.series);
+      std::snprintf(buffer, sizeof(buffer), "\":%lld}",
+                    static_cast<long long>(event.value));
+      json += buffer;
+    }
+
+    json += i + 1 < events.size() ? "},\n" : "}\n";
+  }
+  json += "]}\n";
+
+  wxFFile out(path, wxT("wb"));
+  if (!out.IsOpened() || !out.Write(json.data(), json.size())) {
+    wxLogWarning(wxT("Failed to write trace output: %s"), path);
+    return;
+  }
+  wxLogMessage(wxT("Wrote %lu trace events to %s"),
+               static_cast<unsigned long>(events.size()), path);
+}
+
+void RecordTraceSpan(const char *name, const char *category, int64_t begin_us,
+                     int64_t end_us, const wxString &detail) {
+  if (!IsTracingEnabled()) {
+    return;
+  }
+
+  TraceEvent event{};
+  event.name = name;
+  event.category = category;
+  event.phase = 'X';
+  event.timestamp_us = begin_us;
+  event.duration_us = end_us - begin_us;
+  event.thread_id = CurrentTraceThreadId();
+  if (!detail.empty()) {
+    event.detail = detail.ToStdString(wxConvUTF8);
+  }
+  event.series = "";
+  PushTraceEvent(std::move(event));
+}
+
+void RecordTraceCounter(const char *name, const char *series, int64_t value) {
+  if (!IsTracingEnabled()) {
+    return;
+  }
+
+  TraceEvent event{};
+  event.name = name;
+  event.category = "counter";
+  event.phase = 'C';
+  event.timestamp_us = TraceNowMicros();
+  event.thread_id = CurrentTraceThreadId();
+  event.series = series;
+  event.value = value;
+  PushTraceEvent(std::move(event));
+}
+
+TraceScope::TraceScope(const char *scope_name, const char *scope_category)
+    : name(scope_name), category(scope_category) {
+  if (IsTracingEnabled()) {
+    active = true;
+    begin_us = TraceNowMicros();
+  }
+}
+
+TraceScope::TraceScope(const char *scope_name, const char *scope_category,
+                       const wxString &scope_detail)
+    : name(scope_name), category(scope_category) {
+  if (IsTracingEnabled()) {
+    active = true;
+    detail = scope_detail;
+    begin_us = TraceNowMicros();
+  }
+}
+
+TraceScope::~TraceScope() {
+  if (active) {
+    RecordTraceSpan(name, category, begin_us, TraceNowMicros(), detail);
+  }
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <wx/string.h>
+
+// Chrome/Perfetto trace-event output enabled with `--trace=<file>`. When
+// tracing is off a TraceScope costs a single relaxed atomic load.
+
+extern std::atomic<bool> gTracingEnabled;
+
+inline bool IsTracingEnabled() {
+  return gTracingEnabled.load(std::memory_order_relaxed);
+}
+
+bool StartTracing(const wxString &path, wxString &error);
+void StopTracing();
+
+int64_t TraceNowMicros();
+void RecordTraceSpan(const char *name, const char *category, int64_t begin_us,
+                     int64_t end_us, const wxString &detail = wxString());
+void RecordTraceCounter(const char *name, const char *series, int64_t value);
+
+class TraceScope {
+public:
+  explicit TraceScope(const char *name, const char *category = "startup");
+  TraceScope(const char *name, const char *category, const wxString &detail);
+  ~TraceScope();
+
+  TraceScope(const TraceScope &) = delete;
+  TraceScope &operator=(const TraceScope &) = delete;
+
+private:
+  const char *name;
+  const char *category;
+  wxString detail;
+  int64_t begin_us = 0;
+  bool active = false;
+};
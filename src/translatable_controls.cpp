@@ -0,0 +1,15 @@
+#include "translatable_controls.h"
+
+#include <wx/translation.h>
+#include <wx/window.h>
+
+void TranslatableControls::AddEntry(wxWindow *control, const wxString &msgid) {
+  control->SetLabel(wxGetTranslation(msgid));
+  entries.push_back(Entry{control, msgid});
+}
+
+void TranslatableControls::Relabel() const {
+  for (const Entry &entry : entries) {
+    entry.control->SetLabel(wxGetTranslation(entry.msgid));
+  }
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <vector>
+#include <wx/string.h>
+
+class wxWindow;
+
+// Controls whose label is a catalog msgid. Relabel() re-applies the active
+// translation in place, so a language switch keeps every window and its
+// state. Pass msgids through wxTRANSLATE() so xgettext still extracts them.
+class TranslatableControls {
+public:
+  // Labels the control with the current translation and remembers the msgid.
+  template <typename Control> Control *Add(Control *control, const wxString &msgid) {
+    AddEntry(control, msgid);
+    return control;
+  }
+
+  void Relabel() const;
+
+private:
+  struct Entry {
+    wxWindow *control;
+    wxString msgid;
+  };
+
+  void AddEntry(wxWindow *control, const wxString &msgid);
+
+  std::vector<Entry> entries;
+};
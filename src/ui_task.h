@@ -0,0 +1,28 @@
+#pragma once
+
+#include "task_scheduler.h"
+
+#include <memory>
+#include <utility>
+#include <wx/app.h>
+
+// Runs `work` on the shared scheduler and hands its result to `done` on the
+// UI thread. `done` is skipped once `token` is cancelled; windows cancel their
+// token when they are destroyed, so a late result never reaches a dead window.
+// `work` must not touch windows, bitmaps or icons.
+template <typename Work, typename Done>
+void RunTaskThenUi(const char *name, TaskPriority priority, const CancellationToken &token,
+                   Work work, Done done) {
+  GetTaskScheduler().Submit(
+      name, priority, token, [work, done](const CancellationToken &taskToken) {
+        auto result = std::make_shared<decltype(work(taskToken))>(work(taskToken));
+        if (taskToken.IsCancelled() || wxTheApp == nullptr) {
+          return;
+        }
+        wxTheApp->CallAfter([taskToken, result, done]() {
+          if (!taskToken.IsCancelled()) {
+            done(std::move(*result));
+          }
+        });
+      });
+}